@@ -340,6 +340,10 @@ public:
         return N;
     }
 
+    inline constexpr u64 GetWord(size_t word) const {
+        return data[word];
+    }
+
     inline constexpr BitArray& operator|=(const BitArray& other) {
         for (size_t i = 0; i < WORD_COUNT; ++i) {
             data[i] |= other.data[i];
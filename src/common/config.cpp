@@ -143,6 +143,7 @@ static ConfigEntry<bool> isShowSplash(false);
 static ConfigEntry<string> isSideTrophy("right");
 static ConfigEntry<bool> isConnectedToNetwork(false);
 static bool enableDiscordRPC = false;
+static ConfigEntry<int> aioWorkerCount(0); // 0 = based on the core count
 static std::filesystem::path sys_modules_path = {};
 
 // Input
@@ -167,6 +168,9 @@ static ConfigEntry<u32> internalScreenWidth(1280);
 static ConfigEntry<u32> internalScreenHeight(720);
 static ConfigEntry<bool> isNullGpu(false);
 static ConfigEntry<bool> shouldCopyGPUBuffers(false);
+static ConfigEntry<bool> asyncComputeQueuesEnabled(false);
+static ConfigEntry<bool> userfaultfdEnabled(false);
+static ConfigEntry<string> pipelineCompileMode("sync");
 static ConfigEntry<bool> readbacksEnabled(false);
 static ConfigEntry<bool> readbackLinearImagesEnabled(false);
 static ConfigEntry<bool> directMemoryAccessEnabled(false);
@@ -216,6 +220,7 @@ static ConfigEntry<bool> isSeparateLogFilesEnabled(false);
 static ConfigEntry<bool> isFpsColor(true);
 static ConfigEntry<bool> showFpsCounter(false);
 static ConfigEntry<bool> logEnabled(true);
+static ConfigEntry<bool> isSyncContentionCounters(false);
 
 // GUI
 static std::vector<GameInstallDir> settings_install_dirs = {};
@@ -328,6 +333,14 @@ int getExtraDmemInMbytes() {
     return extraDmemInMbytes.get();
 }
 
+int getAioWorkerCount() {
+    return aioWorkerCount.get();
+}
+
+void setAioWorkerCount(int value, bool is_game_specific) {
+    aioWorkerCount.set(value, is_game_specific);
+}
+
 void setExtraDmemInMbytes(int value, bool is_game_specific) {
     // Disable setting in global config
     is_game_specific ? extraDmemInMbytes.game_specific_value = value
@@ -430,6 +443,10 @@ bool collectShadersForDebug() {
     return isShaderDebug.get();
 }
 
+bool syncContentionCounters() {
+    return isSyncContentionCounters.get();
+}
+
 bool showSplash() {
     return isShowSplash.get();
 }
@@ -446,6 +463,18 @@ bool copyGPUCmdBuffers() {
     return shouldCopyGPUBuffers.get();
 }
 
+bool asyncComputeQueues() {
+    return asyncComputeQueuesEnabled.get();
+}
+
+bool userfaultfd() {
+    return userfaultfdEnabled.get();
+}
+
+string getPipelineCompileMode() {
+    return pipelineCompileMode.get();
+}
+
 bool readbacks() {
     return readbacksEnabled.get();
 }
@@ -581,6 +610,10 @@ void setCollectShaderForDebug(bool enable, bool is_game_specific) {
     isShaderDebug.set(enable, is_game_specific);
 }
 
+void setSyncContentionCounters(bool enable, bool is_game_specific) {
+    isSyncContentionCounters.set(enable, is_game_specific);
+}
+
 void setShowSplash(bool enable, bool is_game_specific) {
     isShowSplash.set(enable, is_game_specific);
 }
@@ -601,6 +634,18 @@ void setCopyGPUCmdBuffers(bool enable, bool is_game_specific) {
     shouldCopyGPUBuffers.set(enable, is_game_specific);
 }
 
+void setAsyncComputeQueues(bool enable, bool is_game_specific) {
+    asyncComputeQueuesEnabled.set(enable, is_game_specific);
+}
+
+void setUserfaultfd(bool enable, bool is_game_specific) {
+    userfaultfdEnabled.set(enable, is_game_specific);
+}
+
+void setPipelineCompileMode(const string& mode, bool is_game_specific) {
+    pipelineCompileMode.set(mode, is_game_specific);
+}
+
 void setReadbacks(bool enable, bool is_game_specific) {
     readbacksEnabled.set(enable, is_game_specific);
 }
@@ -996,6 +1041,7 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
 
         isConnectedToNetwork.setFromToml(general, "isConnectedToNetwork", is_game_specific);
         defaultControllerID.setFromToml(general, "defaultControllerID", is_game_specific);
+        aioWorkerCount.setFromToml(general, "aioWorkerCount", is_game_specific);
         sys_modules_path = toml::find_fs_path_or(general, "sysModulesPath", sys_modules_path);
     }
 
@@ -1029,6 +1075,9 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         internalScreenHeight.setFromToml(gpu, "internalScreenHeight", is_game_specific);
         isNullGpu.setFromToml(gpu, "nullGpu", is_game_specific);
         shouldCopyGPUBuffers.setFromToml(gpu, "copyGPUBuffers", is_game_specific);
+        asyncComputeQueuesEnabled.setFromToml(gpu, "asyncComputeQueues", is_game_specific);
+        userfaultfdEnabled.setFromToml(gpu, "userfaultfd", is_game_specific);
+        pipelineCompileMode.setFromToml(gpu, "pipelineCompileMode", is_game_specific);
         readbacksEnabled.setFromToml(gpu, "readbacks", is_game_specific);
         readbackLinearImagesEnabled.setFromToml(gpu, "readbackLinearImages", is_game_specific);
         directMemoryAccessEnabled.setFromToml(gpu, "directMemoryAccess", is_game_specific);
@@ -1085,6 +1134,7 @@ void load(const std::filesystem::path& path, bool is_game_specific) {
         isFpsColor.setFromToml(debug, "FPSColor", is_game_specific);
         showFpsCounter.setFromToml(debug, "showFpsCounter", is_game_specific);
         logEnabled.setFromToml(debug, "logEnabled", is_game_specific);
+        isSyncContentionCounters.setFromToml(debug, "syncContentionCounters", is_game_specific);
         current_version = toml::find_or<std::string>(debug, "ConfigVersion", current_version);
     }
 
@@ -1220,6 +1270,9 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
     windowHeight.setTomlValue(data, "GPU", "screenHeight", is_game_specific);
     isNullGpu.setTomlValue(data, "GPU", "nullGpu", is_game_specific);
     shouldCopyGPUBuffers.setTomlValue(data, "GPU", "copyGPUBuffers", is_game_specific);
+    asyncComputeQueuesEnabled.setTomlValue(data, "GPU", "asyncComputeQueues", is_game_specific);
+    userfaultfdEnabled.setTomlValue(data, "GPU", "userfaultfd", is_game_specific);
+    pipelineCompileMode.setTomlValue(data, "GPU", "pipelineCompileMode", is_game_specific);
     readbacksEnabled.setTomlValue(data, "GPU", "readbacks", is_game_specific);
     readbackLinearImagesEnabled.setTomlValue(data, "GPU", "readbackLinearImages", is_game_specific);
     shouldDumpShaders.setTomlValue(data, "GPU", "dumpShaders", is_game_specific);
@@ -1298,6 +1351,7 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
 
         // Do not save these entries in the game-specific dialog since they are not in the GUI
         data["General"]["defaultControllerID"] = defaultControllerID.base_value;
+        data["General"]["aioWorkerCount"] = aioWorkerCount.base_value;
         data["Input"]["useSpecialPad"] = useSpecialPad.base_value;
         data["Input"]["specialPadClass"] = specialPadClass.base_value;
         data["Input"]["useUnifiedInputConfig"] = useUnifiedInputConfig.base_value;
@@ -1306,6 +1360,7 @@ void save(const std::filesystem::path& path, bool is_game_specific) {
         data["GPU"]["patchShaders"] = shouldPatchShaders.base_value;
         data["Debug"]["FPSColor"] = isFpsColor.base_value;
         data["Debug"]["showFpsCounter"] = showFpsCounter.base_value;
+        data["Debug"]["syncContentionCounters"] = isSyncContentionCounters.base_value;
     }
 
     // Sorting of TOML sections
@@ -1357,6 +1412,9 @@ void setDefaultValues(bool is_game_specific) {
     windowHeight.set(720, is_game_specific);
     isNullGpu.set(false, is_game_specific);
     shouldCopyGPUBuffers.set(false, is_game_specific);
+    asyncComputeQueuesEnabled.set(false, is_game_specific);
+    userfaultfdEnabled.set(false, is_game_specific);
+    pipelineCompileMode.set("sync", is_game_specific);
     shouldDumpShaders.set(false, is_game_specific);
     vblankFrequency.set(60, is_game_specific);
     isFullscreen.set(false, is_game_specific);
@@ -55,6 +55,8 @@ bool allowHDR();
 void setAllowHDR(bool enable, bool is_game_specific = false);
 bool collectShadersForDebug();
 void setCollectShaderForDebug(bool enable, bool is_game_specific = false);
+bool syncContentionCounters();
+void setSyncContentionCounters(bool enable, bool is_game_specific = false);
 bool showSplash();
 void setShowSplash(bool enable, bool is_game_specific = false);
 std::string sideTrophy();
@@ -63,6 +65,12 @@ bool nullGpu();
 void setNullGpu(bool enable, bool is_game_specific = false);
 bool copyGPUCmdBuffers();
 void setCopyGPUCmdBuffers(bool enable, bool is_game_specific = false);
+bool asyncComputeQueues();
+void setAsyncComputeQueues(bool enable, bool is_game_specific = false);
+bool userfaultfd();
+void setUserfaultfd(bool enable, bool is_game_specific = false);
+std::string getPipelineCompileMode();
+void setPipelineCompileMode(const std::string& mode, bool is_game_specific = false);
 bool readbacks();
 void setReadbacks(bool enable, bool is_game_specific = false);
 bool readbackLinearImages();
@@ -135,6 +143,8 @@ void setDevKitConsole(bool enable, bool is_game_specific = false);
 
 int getExtraDmemInMbytes();
 void setExtraDmemInMbytes(int value, bool is_game_specific = false);
+int getAioWorkerCount();
+void setAioWorkerCount(int value, bool is_game_specific = false);
 bool getIsMotionControlsEnabled();
 void setIsMotionControlsEnabled(bool use, bool is_game_specific = false);
 std::string getDefaultControllerID();
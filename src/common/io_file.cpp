@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2021 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <climits>
+#include <cstddef>
 #include <vector>
 
 #include "common/alignment.h"
@@ -17,6 +20,8 @@
 #include <share.h>
 #include <windows.h>
 #else
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif
 
@@ -164,6 +169,9 @@ IOFile::IOFile(IOFile&& other) noexcept {
     std::swap(file_access_mode, other.file_access_mode);
     std::swap(file_type, other.file_type);
     std::swap(file, other.file);
+#ifdef _WIN32
+    std::swap(read_handle, other.read_handle);
+#endif
 }
 
 IOFile& IOFile::operator=(IOFile&& other) noexcept {
@@ -171,6 +179,9 @@ IOFile& IOFile::operator=(IOFile&& other) noexcept {
     std::swap(file_access_mode, other.file_access_mode);
     std::swap(file_type, other.file_type);
     std::swap(file, other.file);
+#ifdef _WIN32
+    std::swap(read_handle, other.read_handle);
+#endif
     return *this;
 }
 
@@ -200,7 +211,19 @@ int IOFile::Open(const fs::path& path, FileAccessMode mode, FileType type, FileS
         const auto ec = std::error_code{result, std::generic_category()};
         LOG_ERROR(Common_Filesystem, "Failed to open the file at path={}, error_message={}",
                   PathToUTF8String(file_path), ec.message());
+        return result;
+    }
+
+#ifdef _WIN32
+    if (True(mode & FileAccessMode::Read)) {
+        const HANDLE hfile = reinterpret_cast<HANDLE>(_get_osfhandle(fileno(file)));
+        read_handle = ReOpenFile(hfile, GENERIC_READ,
+                                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, 0);
+        if (read_handle == INVALID_HANDLE_VALUE) {
+            read_handle = nullptr;
+        }
     }
+#endif
 
     return result;
 }
@@ -222,6 +245,13 @@ void IOFile::Close() {
 
     file = nullptr;
 
+#ifdef _WIN32
+    if (read_handle) {
+        CloseHandle(read_handle);
+        read_handle = nullptr;
+    }
+#endif
+
 #ifdef _WIN64
     if (file_mapping && file_access_mode == FileAccessMode::ReadWrite) {
         CloseHandle(std::bit_cast<HANDLE>(file_mapping));
@@ -281,6 +311,74 @@ uintptr_t IOFile::GetFileMapping() {
 #endif
 }
 
+s64 IOFile::ReadAt(std::span<const IOBuffer> buffers, u64 offset) const {
+    if (!IsOpen()) {
+        return -1;
+    }
+
+#ifdef _WIN32
+    if (!read_handle) {
+        return -1;
+    }
+    s64 total_read = 0;
+    for (const auto& buffer : buffers) {
+        auto* data = static_cast<u8*>(buffer.data);
+        size_t remaining = buffer.size;
+        while (remaining > 0) {
+            OVERLAPPED overlapped{};
+            overlapped.Offset = static_cast<DWORD>(offset);
+            overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+            const DWORD size = static_cast<DWORD>(std::min<size_t>(remaining, MAXDWORD));
+            DWORD bytes_read{};
+            if (!ReadFile(read_handle, data, size, &bytes_read, &overlapped)) {
+                if (GetLastError() == ERROR_HANDLE_EOF) {
+                    return total_read;
+                }
+                LOG_ERROR(Common_Filesystem, "Failed to read the file at path={}, error={}",
+                          PathToUTF8String(file_path), GetLastErrorMsg());
+                return -1;
+            }
+            total_read += bytes_read;
+            offset += bytes_read;
+            if (bytes_read < size) {
+                return total_read;
+            }
+            data += bytes_read;
+            remaining -= bytes_read;
+        }
+    }
+    return total_read;
+#else
+    static_assert(sizeof(IOBuffer) == sizeof(iovec) &&
+                  offsetof(IOBuffer, data) == offsetof(iovec, iov_base) &&
+                  offsetof(IOBuffer, size) == offsetof(iovec, iov_len));
+    const int fd = fileno(file);
+    const auto* iov = reinterpret_cast<const iovec*>(buffers.data());
+    const int iovcnt = static_cast<int>(std::min<size_t>(buffers.size(), IOV_MAX));
+    ssize_t result;
+    do {
+        result = preadv(fd, iov, iovcnt, static_cast<off_t>(offset));
+    } while (result < 0 && errno == EINTR);
+    if (result < 0) {
+        const auto ec = std::error_code{errno, std::generic_category()};
+        LOG_ERROR(Common_Filesystem, "Failed to read the file at path={}, offset={}, ec_message={}",
+                  PathToUTF8String(file_path), offset, ec.message());
+        return -1;
+    }
+    if (buffers.size() > static_cast<size_t>(iovcnt)) {
+        size_t requested = 0;
+        for (s32 i = 0; i < iovcnt; i++) {
+            requested += buffers[i].size;
+        }
+        if (static_cast<size_t>(result) == requested) {
+            const s64 rest = ReadAt(buffers.subspan(iovcnt), offset + result);
+            return rest < 0 ? rest : result + rest;
+        }
+    }
+    return result;
+#endif
+}
+
 std::string IOFile::ReadString(size_t length) const {
     std::vector<char> string_buffer(length);
 
@@ -377,6 +475,31 @@ u64 IOFile::GetSize() const {
     return file_size;
 }
 
+u64 IOFile::GetSizeFromHandle() const {
+    if (!IsOpen()) {
+        return 0;
+    }
+
+#ifdef _WIN32
+    LARGE_INTEGER file_size{};
+    if (!read_handle || !GetFileSizeEx(read_handle, &file_size)) {
+        LOG_ERROR(Common_Filesystem, "Failed to retrieve the file size of path={}, error={}",
+                  PathToUTF8String(file_path), GetLastErrorMsg());
+        return 0;
+    }
+    return static_cast<u64>(file_size.QuadPart);
+#else
+    struct stat file_stat {};
+    if (fstat(fileno(file), &file_stat) != 0) {
+        const auto ec = std::error_code{errno, std::generic_category()};
+        LOG_ERROR(Common_Filesystem, "Failed to retrieve the file size of path={}, ec_message={}",
+                  PathToUTF8String(file_path), ec.message());
+        return 0;
+    }
+    return static_cast<u64>(file_stat.st_size);
+#endif
+}
+
 bool IOFile::Seek(s64 offset, SeekOrigin origin) const {
     if (!IsOpen()) {
         return false;
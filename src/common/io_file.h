@@ -62,6 +62,12 @@ enum class FileShareFlag {
     ShareReadWrite, // Provides read and write shared access to the file.
 };
 
+/// A buffer of a scatter read, laid out like struct iovec.
+struct IOBuffer {
+    void* data;
+    size_t size;
+};
+
 enum class SeekOrigin : u32 {
     SetOrigin,       // Seeks from the start of the file.
     CurrentPosition, // Seeks from the current file pointer position.
@@ -127,6 +133,13 @@ public:
     bool SetSize(u64 size) const;
     u64 GetSize() const;
 
+    /**
+     * Returns the current size of the open file, queried through its descriptor. Unlike GetSize()
+     * it neither flushes nor resolves the path, so it may be called alongside ReadAt and keeps
+     * working after the file was renamed or unlinked. Returns 0 on error.
+     */
+    u64 GetSizeFromHandle() const;
+
     bool Seek(s64 offset, SeekOrigin origin = SeekOrigin::SetOrigin) const;
     s64 Tell() const;
 
@@ -213,6 +226,19 @@ public:
         return std::fwrite(&object, sizeof(T), 1, file) == 1;
     }
 
+    /**
+     * Reads into the buffers in order, starting at the given offset of the file. The file
+     * position is neither used nor moved, so reads may be issued from several threads at once.
+     * Data still held in the stdio write buffer is not seen; call Flush() first if needed.
+     * Returns the number of bytes read, or -1 on error.
+     */
+    s64 ReadAt(std::span<const IOBuffer> buffers, u64 offset) const;
+
+    s64 ReadAt(void* data, size_t size, u64 offset) const {
+        const IOBuffer buffer{data, size};
+        return ReadAt({&buffer, 1}, offset);
+    }
+
     std::string ReadString(size_t length) const;
 
     size_t WriteString(std::span<const char> string) const {
@@ -231,6 +257,11 @@ private:
     FileType file_type{};
 
     uintptr_t file_mapping = 0;
+#ifdef _WIN32
+    // Positional reads move the file pointer of the handle they use on Windows, so they go
+    // through a second handle to keep the position of the stream intact.
+    void* read_handle = nullptr;
+#endif
 };
 
 u64 GetDirectorySize(const std::filesystem::path& path);
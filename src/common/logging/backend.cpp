@@ -1,9 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2014 Citra Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <thread>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -16,6 +21,7 @@
 #include "common/debug.h"
 #include "common/io_file.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/log.h"
 #include "common/logging/log_entry.h"
 #include "common/logging/text_formatter.h"
@@ -119,6 +125,39 @@ public:
 
 bool initialization_in_progress_suppress_logging = true;
 
+/// Propagates important log messages to the profiler
+void PropagateToProfiler(Class log_class, Level log_level, std::string_view message) {
+    if (!IsProfilerConnected()) {
+        return;
+    }
+    const auto& msg_str = fmt::format("[{}] {}", GetLogClassName(log_class), message);
+    switch (log_level) {
+    case Level::Warning:
+        TRACE_WARN(msg_str);
+        break;
+    case Level::Error:
+        TRACE_ERROR(msg_str);
+        break;
+    case Level::Critical:
+        TRACE_CRIT(msg_str);
+        break;
+    default:
+        break;
+    }
+}
+
+/// Holds the binary log ring of the calling thread and abandons it when the thread exits.
+struct ThreadLogRing {
+    std::shared_ptr<LogRing> ring;
+    const void* owner{};
+
+    ~ThreadLogRing() {
+        if (ring) {
+            ring->Abandon();
+        }
+    }
+};
+
 /**
  * Static state as a singleton.
  */
@@ -187,29 +226,35 @@ public:
             return;
         }
 
-        const auto message = fmt::vformat(format, args);
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::steady_clock;
 
-        // Propagate important log messages to the profiler
-        if (IsProfilerConnected()) {
-            const auto& msg_str = fmt::format("[{}] {}", GetLogClassName(log_class), message);
-            switch (log_level) {
-            case Level::Warning:
-                TRACE_WARN(msg_str);
-                break;
-            case Level::Error:
-                TRACE_ERROR(msg_str);
-                break;
-            case Level::Critical:
-                TRACE_CRIT(msg_str);
-                break;
-            default:
-                break;
+        if (binary_backend) {
+            // Defer formatting to the backend thread, only the raw arguments are copied here.
+            thread_local std::vector<u8> encoded_args;
+            encoded_args.clear();
+            BinaryRecordHeader header = {
+                .timestamp = duration_cast<microseconds>(steady_clock::now() - time_origin).count(),
+                .format = format,
+                .filename = filename,
+                .function = function,
+                .line_num = line_num,
+                .log_class = log_class,
+                .log_level = log_level,
+            };
+            if (!EncodeFormatArgs(args, encoded_args)) {
+                const auto message = fmt::vformat(format, args);
+                header.format = nullptr;
+                encoded_args.clear();
+                EncodeFormatArgs(fmt::make_format_args(message), encoded_args);
             }
+            GetThreadLogRing().TryWrite(header, encoded_args);
+            return;
         }
 
-        using std::chrono::duration_cast;
-        using std::chrono::microseconds;
-        using std::chrono::steady_clock;
+        const auto message = fmt::vformat(format, args);
+        PropagateToProfiler(log_class, log_level, message);
 
         const Entry entry = {
             .timestamp = duration_cast<microseconds>(steady_clock::now() - time_origin),
@@ -230,11 +275,113 @@ public:
 
 private:
     Impl(const std::filesystem::path& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename, should_append} {}
+        : filter{filter_} {
+        if (Config::getLogType() == "binary") {
+            auto binary_filename = file_backend_filename;
+            binary_backend.emplace(binary_filename.replace_extension(".bin"), should_append);
+        } else {
+            file_backend.emplace(file_backend_filename, should_append);
+        }
+    }
 
     ~Impl() = default;
 
+    LogRing& GetThreadLogRing() {
+        thread_local ThreadLogRing thread_ring;
+        if (thread_ring.owner != this) {
+            // The logging backend may have been reinitialized since this thread last logged.
+            if (thread_ring.ring) {
+                thread_ring.ring->Abandon();
+            }
+            thread_ring.ring = std::make_shared<LogRing>();
+            thread_ring.owner = this;
+            std::scoped_lock lk{rings_mutex};
+            rings.push_back(thread_ring.ring);
+        }
+        return *thread_ring.ring;
+    }
+
+    void WriteBinaryRecord(const BinaryRecordHeader& header, std::span<const u8> args) {
+        const Entry entry = {
+            .timestamp = std::chrono::microseconds{header.timestamp},
+            .log_class = header.log_class,
+            .log_level = header.log_level,
+            .filename = header.filename,
+            .line_num = header.line_num,
+            .function = header.function,
+            .message = FormatEncodedArgs(header.format, args),
+        };
+        PropagateToProfiler(entry.log_class, entry.log_level, entry.message);
+        color_console_backend.Write(entry);
+        binary_backend->Write(header, args);
+    }
+
+    /// Moves the records of all thread rings to the backends, ordered by timestamp.
+    void DrainThreadLogRings() {
+        struct Record {
+            BinaryRecordHeader header;
+            std::vector<u8> args;
+        };
+        std::vector<Record> records;
+        u64 num_dropped = dropped_from_exited_threads;
+        {
+            std::scoped_lock lk{rings_mutex};
+            for (auto it = rings.begin(); it != rings.end();) {
+                const auto& ring = *it;
+                // Check before draining so records written right before exiting are not lost.
+                const bool is_abandoned = ring->IsAbandoned();
+                Record record;
+                while (ring->TryRead(record.header, record.args)) {
+                    records.push_back(std::move(record));
+                }
+                num_dropped += ring->NumDropped();
+                if (is_abandoned) {
+                    dropped_from_exited_threads += ring->NumDropped();
+                    it = rings.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        std::ranges::stable_sort(records, {}, [](const Record& r) { return r.header.timestamp; });
+        for (const auto& record : records) {
+            WriteBinaryRecord(record.header, record.args);
+        }
+
+        if (num_dropped > reported_dropped) {
+            static constexpr const char* DroppedFormat = "Dropped {} log messages";
+            const u64 num_new_dropped = num_dropped - reported_dropped;
+            std::vector<u8> args;
+            EncodeFormatArgs(fmt::make_format_args(num_new_dropped), args);
+            const BinaryRecordHeader header = {
+                .timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+                                 std::chrono::steady_clock::now() - time_origin)
+                                 .count(),
+                .format = DroppedFormat,
+                .filename = TrimSourcePath(__FILE__),
+                .function = __func__,
+                .line_num = __LINE__,
+                .log_class = Class::Log,
+                .log_level = Level::Warning,
+            };
+            WriteBinaryRecord(header, args);
+            reported_dropped = num_dropped;
+        }
+    }
+
     void StartBackendThread() {
+        if (binary_backend) {
+            backend_thread = std::jthread([this](std::stop_token stop_token) {
+                Common::SetCurrentThreadName("shadPS4:Log");
+                while (!stop_token.stop_requested()) {
+                    DrainThreadLogRings();
+                    std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                }
+                DrainThreadLogRings();
+            });
+            return;
+        }
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("shadPS4:Log");
             Entry entry;
@@ -263,12 +410,17 @@ private:
         }
 
         ForEachBackend([](auto& backend) { backend.Flush(); });
+        if (binary_backend) {
+            binary_backend->Flush();
+        }
     }
 
     void ForEachBackend(auto lambda) {
         // lambda(debugger_backend);
         lambda(color_console_backend);
-        lambda(file_backend);
+        if (file_backend) {
+            lambda(*file_backend);
+        }
     }
 
     static void Deleter(Impl* ptr) {
@@ -281,9 +433,14 @@ private:
     Filter filter;
     DebuggerBackend debugger_backend{};
     ColorConsoleBackend color_console_backend{};
-    FileBackend file_backend;
+    std::optional<FileBackend> file_backend;
+    std::optional<BinaryLogWriter> binary_backend;
 
     MPSCQueue<Entry> message_queue{};
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<LogRing>> rings;
+    u64 dropped_from_exited_threads{};
+    u64 reported_dropped{};
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
     std::jthread backend_thread;
 };
@@ -0,0 +1,417 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include <fmt/args.h>
+
+#include "common/logging/binary_log.h"
+#include "common/logging/text_formatter.h"
+
+namespace Common::Log {
+
+namespace {
+
+constexpr u32 BinaryLogMagic = 0x474F4C53; // SLOG
+constexpr u32 BinaryLogVersion = 1;
+
+enum class ArgTag : u8 {
+    Int = 0,
+    UInt = 1,
+    Bool = 2,
+    Char = 3,
+    Float = 4,
+    Double = 5,
+    String = 6,
+    Pointer = 7,
+};
+
+enum class RecordKind : u8 {
+    /// Starts a log session, clearing the string table. u32 magic, u32 version.
+    Session = 0,
+    /// Defines a string. u32 id, u32 size, characters.
+    String = 1,
+    /// A log message. s64 timestamp, u32 format id, u32 filename id, u32 function id,
+    /// u32 line, u8 class, u8 level, u32 args size, encoded arguments.
+    Message = 2,
+};
+
+template <typename T>
+void Put(std::vector<u8>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+void PutString(std::vector<u8>& out, std::string_view str) {
+    Put(out, static_cast<u32>(str.size()));
+    out.insert(out.end(), str.begin(), str.end());
+}
+
+/// Bounds checked reader over a byte span.
+class Reader {
+public:
+    explicit Reader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename T>
+    bool Get(T& value) {
+        if (data.size() - pos < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    bool GetString(std::string_view& str) {
+        u32 size;
+        if (!Get(size) || data.size() - pos < size) {
+            return false;
+        }
+        str = {reinterpret_cast<const char*>(data.data()) + pos, size};
+        pos += size;
+        return true;
+    }
+
+    bool GetBytes(std::span<const u8>& bytes, size_t size) {
+        if (data.size() - pos < size) {
+            return false;
+        }
+        bytes = data.subspan(pos, size);
+        pos += size;
+        return true;
+    }
+
+    bool Empty() const {
+        return pos == data.size();
+    }
+
+private:
+    std::span<const u8> data;
+    size_t pos{};
+};
+
+struct ArgEncoder {
+    std::vector<u8>& out;
+
+    template <typename T>
+    bool operator()(T value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            Put(out, ArgTag::Bool);
+            Put(out, static_cast<u8>(value));
+        } else if constexpr (std::is_same_v<T, char>) {
+            Put(out, ArgTag::Char);
+            Put(out, value);
+        } else if constexpr (std::is_integral_v<T> && sizeof(T) <= sizeof(u64)) {
+            if constexpr (std::is_signed_v<T>) {
+                Put(out, ArgTag::Int);
+                Put(out, static_cast<s64>(value));
+            } else {
+                Put(out, ArgTag::UInt);
+                Put(out, static_cast<u64>(value));
+            }
+        } else if constexpr (std::is_same_v<T, float>) {
+            Put(out, ArgTag::Float);
+            Put(out, value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            Put(out, ArgTag::Double);
+            Put(out, static_cast<double>(value));
+        } else if constexpr (std::is_same_v<T, const char*>) {
+            Put(out, ArgTag::String);
+            PutString(out, value ? std::string_view{value} : std::string_view{});
+        } else if constexpr (std::is_same_v<T, fmt::string_view>) {
+            Put(out, ArgTag::String);
+            PutString(out, {value.data(), value.size()});
+        } else if constexpr (std::is_same_v<T, const void*>) {
+            Put(out, ArgTag::Pointer);
+            Put(out, reinterpret_cast<u64>(value));
+        } else {
+            // Custom formatters and 128-bit integers can only be formatted in place.
+            return false;
+        }
+        return true;
+    }
+};
+
+} // Anonymous namespace
+
+bool EncodeFormatArgs(const fmt::format_args& args, std::vector<u8>& out) {
+    const size_t count_pos = out.size();
+    Put(out, u8{0});
+    u8 count = 0;
+    for (int i = 0;; ++i) {
+        const auto arg = args.get(i);
+        if (!arg) {
+            break;
+        }
+#if FMT_VERSION >= 110000
+        const bool encoded = arg.visit(ArgEncoder{out});
+#else
+        const bool encoded = fmt::visit_format_arg(ArgEncoder{out}, arg);
+#endif
+        if (!encoded) {
+            return false;
+        }
+        ++count;
+    }
+    out[count_pos] = count;
+    return true;
+}
+
+std::string FormatEncodedArgs(const char* format, std::span<const u8> args) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    Reader reader{args};
+    u8 count{};
+    reader.Get(count);
+    std::string_view first_string;
+    for (u8 i = 0; i < count; ++i) {
+        ArgTag tag;
+        if (!reader.Get(tag)) {
+            return "<truncated log arguments>";
+        }
+        bool ok = false;
+        switch (tag) {
+        case ArgTag::Int: {
+            s64 value;
+            ok = reader.Get(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::UInt: {
+            u64 value;
+            ok = reader.Get(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::Bool: {
+            u8 value;
+            ok = reader.Get(value);
+            store.push_back(value != 0);
+            break;
+        }
+        case ArgTag::Char: {
+            char value;
+            ok = reader.Get(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::Float: {
+            float value;
+            ok = reader.Get(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::Double: {
+            double value;
+            ok = reader.Get(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgTag::String: {
+            std::string_view value;
+            ok = reader.GetString(value);
+            store.push_back(std::string{value});
+            if (i == 0) {
+                first_string = value;
+            }
+            break;
+        }
+        case ArgTag::Pointer: {
+            u64 value;
+            ok = reader.Get(value);
+            store.push_back(reinterpret_cast<const void*>(value));
+            break;
+        }
+        }
+        if (!ok) {
+            return "<truncated log arguments>";
+        }
+    }
+    if (!format) {
+        return std::string{first_string};
+    }
+    try {
+        return fmt::vformat(format, store);
+    } catch (const fmt::format_error& e) {
+        return fmt::format("<invalid log format \"{}\": {}>", format, e.what());
+    }
+}
+
+bool LogRing::TryWrite(const BinaryRecordHeader& header, std::span<const u8> args) {
+    const u32 size = static_cast<u32>(sizeof(header) + args.size());
+    const size_t total = sizeof(size) + size;
+    const size_t write_pos = head.load(std::memory_order_relaxed);
+    const size_t read_pos = tail.load(std::memory_order_acquire);
+    if (Capacity - (write_pos - read_pos) < total) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    Copy(write_pos, &size, sizeof(size));
+    Copy(write_pos + sizeof(size), &header, sizeof(header));
+    Copy(write_pos + sizeof(size) + sizeof(header), args.data(), args.size());
+    head.store(write_pos + total, std::memory_order_release);
+    return true;
+}
+
+bool LogRing::TryRead(BinaryRecordHeader& header, std::vector<u8>& args) {
+    const size_t read_pos = tail.load(std::memory_order_relaxed);
+    const size_t write_pos = head.load(std::memory_order_acquire);
+    if (read_pos == write_pos) {
+        return false;
+    }
+    u32 size;
+    Read(read_pos, &size, sizeof(size));
+    Read(read_pos + sizeof(size), &header, sizeof(header));
+    args.resize(size - sizeof(header));
+    Read(read_pos + sizeof(size) + sizeof(header), args.data(), args.size());
+    tail.store(read_pos + sizeof(size) + size, std::memory_order_release);
+    return true;
+}
+
+void LogRing::Copy(size_t pos, const void* data, size_t size) {
+    const size_t offset = pos % Capacity;
+    const size_t first = std::min(size, Capacity - offset);
+    std::memcpy(buffer.data() + offset, data, first);
+    std::memcpy(buffer.data(), static_cast<const u8*>(data) + first, size - first);
+}
+
+void LogRing::Read(size_t pos, void* data, size_t size) const {
+    const size_t offset = pos % Capacity;
+    const size_t first = std::min(size, Capacity - offset);
+    std::memcpy(data, buffer.data() + offset, first);
+    std::memcpy(static_cast<u8*>(data) + first, buffer.data(), size - first);
+}
+
+BinaryLogWriter::BinaryLogWriter(const std::filesystem::path& path, bool should_append)
+    : file{path, should_append ? FS::FileAccessMode::Append : FS::FileAccessMode::Create} {
+    std::vector<u8> record;
+    Put(record, RecordKind::Session);
+    Put(record, BinaryLogMagic);
+    Put(record, BinaryLogVersion);
+    bytes_written += file.WriteSpan(std::span<const u8>{record});
+}
+
+u32 BinaryLogWriter::GetStringId(const char* str) {
+    if (!str) {
+        return 0;
+    }
+    const auto [it, is_new] = string_ids.try_emplace(str, static_cast<u32>(string_ids.size() + 1));
+    if (is_new) {
+        std::vector<u8> record;
+        Put(record, RecordKind::String);
+        Put(record, it->second);
+        PutString(record, str);
+        bytes_written += file.WriteSpan(std::span<const u8>{record});
+    }
+    return it->second;
+}
+
+void BinaryLogWriter::Write(const BinaryRecordHeader& header, std::span<const u8> args) {
+    if (!enabled) {
+        return;
+    }
+
+    const u32 format_id = GetStringId(header.format);
+    const u32 filename_id = GetStringId(header.filename);
+    const u32 function_id = GetStringId(header.function);
+
+    std::vector<u8> record;
+    record.reserve(40 + args.size());
+    Put(record, RecordKind::Message);
+    Put(record, header.timestamp);
+    Put(record, format_id);
+    Put(record, filename_id);
+    Put(record, function_id);
+    Put(record, header.line_num);
+    Put(record, header.log_class);
+    Put(record, header.log_level);
+    Put(record, static_cast<u32>(args.size()));
+    record.insert(record.end(), args.begin(), args.end());
+    bytes_written += file.WriteSpan(std::span<const u8>{record});
+
+    // Same limit as the text log, binary records are just smaller.
+    const auto write_limit = 100_MB;
+    if (bytes_written > write_limit) {
+        enabled = false;
+        file.Flush();
+    } else if (header.log_level >= Level::Error) {
+        file.Flush();
+    }
+}
+
+bool DecodeBinaryLog(const std::filesystem::path& path) {
+    const FS::IOFile file{path, FS::FileAccessMode::Read};
+    if (!file.IsOpen()) {
+        std::fprintf(stderr, "Unable to open binary log %s\n", path.string().c_str());
+        return false;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.Read(data) != data.size()) {
+        std::fprintf(stderr, "Unable to read binary log %s\n", path.string().c_str());
+        return false;
+    }
+
+    tsl::robin_map<u32, std::string> strings;
+    const auto get_string = [&strings](u32 id) -> const char* {
+        const auto it = strings.find(id);
+        return it != strings.end() ? it->second.c_str() : nullptr;
+    };
+
+    Reader reader{data};
+    bool has_session = false;
+    while (!reader.Empty()) {
+        RecordKind kind;
+        reader.Get(kind);
+        if (kind == RecordKind::Session) {
+            u32 magic{}, version{};
+            if (!reader.Get(magic) || !reader.Get(version) || magic != BinaryLogMagic ||
+                version != BinaryLogVersion) {
+                break;
+            }
+            strings.clear();
+            has_session = true;
+        } else if (kind == RecordKind::String && has_session) {
+            u32 id;
+            std::string_view str;
+            if (!reader.Get(id) || !reader.GetString(str)) {
+                break;
+            }
+            strings.insert_or_assign(id, std::string{str});
+        } else if (kind == RecordKind::Message && has_session) {
+            s64 timestamp;
+            u32 format_id, filename_id, function_id, line_num, args_size;
+            Class log_class;
+            Level log_level;
+            std::span<const u8> args;
+            if (!reader.Get(timestamp) || !reader.Get(format_id) || !reader.Get(filename_id) ||
+                !reader.Get(function_id) || !reader.Get(line_num) || !reader.Get(log_class) ||
+                !reader.Get(log_level) || !reader.Get(args_size) ||
+                !reader.GetBytes(args, args_size)) {
+                break;
+            }
+            const char* function = get_string(function_id);
+            const Entry entry = {
+                .timestamp = std::chrono::microseconds{timestamp},
+                .log_class = log_class,
+                .log_level = log_level,
+                .filename = get_string(filename_id),
+                .line_num = line_num,
+                .function = function ? function : "",
+                .message = FormatEncodedArgs(get_string(format_id), args),
+            };
+            std::puts(FormatLogMessage(entry).c_str());
+        } else {
+            break;
+        }
+    }
+
+    if (!reader.Empty()) {
+        std::fprintf(stderr, "Binary log %s is malformed or truncated\n", path.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace Common::Log
@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+#include <tsl/robin_map.h>
+
+#include "common/io_file.h"
+#include "common/logging/log_entry.h"
+#include "common/types.h"
+
+namespace Common::Log {
+
+/**
+ * A log message as recorded by the emulated threads in binary mode. The strings point to
+ * literals with static storage, the arguments are serialized by EncodeFormatArgs. A null format
+ * means the message could not be deferred and the arguments hold the formatted text.
+ */
+struct BinaryRecordHeader {
+    s64 timestamp;
+    const char* format;
+    const char* filename;
+    const char* function;
+    u32 line_num;
+    Class log_class;
+    Level log_level;
+};
+
+/// Serializes format arguments into out. Returns false if an argument has a custom formatter.
+bool EncodeFormatArgs(const fmt::format_args& args, std::vector<u8>& out);
+
+/// Formats a message from a format string and arguments serialized by EncodeFormatArgs.
+std::string FormatEncodedArgs(const char* format, std::span<const u8> args);
+
+/**
+ * Single producer single consumer byte ring holding the records of one thread.
+ * When the ring is full new records are counted as dropped instead of blocking the producer.
+ */
+class LogRing {
+public:
+    static constexpr size_t Capacity = 64_KB;
+
+    bool TryWrite(const BinaryRecordHeader& header, std::span<const u8> args);
+
+    bool TryRead(BinaryRecordHeader& header, std::vector<u8>& args);
+
+    u64 NumDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+    void Abandon() {
+        abandoned.store(true, std::memory_order_release);
+    }
+
+    bool IsAbandoned() const {
+        return abandoned.load(std::memory_order_acquire);
+    }
+
+private:
+    void Copy(size_t pos, const void* data, size_t size);
+    void Read(size_t pos, void* data, size_t size) const;
+
+    std::array<u8, Capacity> buffer;
+    alignas(64) std::atomic<size_t> head{};
+    alignas(64) std::atomic<size_t> tail{};
+    std::atomic<u64> dropped{};
+    std::atomic<bool> abandoned{};
+};
+
+/// Writes records to a compact file where every string is stored once and referred to by id.
+class BinaryLogWriter {
+public:
+    explicit BinaryLogWriter(const std::filesystem::path& path, bool should_append);
+
+    void Write(const BinaryRecordHeader& header, std::span<const u8> args);
+
+    void Flush() {
+        file.Flush();
+    }
+
+private:
+    u32 GetStringId(const char* str);
+
+    Common::FS::IOFile file;
+    tsl::robin_map<const char*, u32> string_ids;
+    size_t bytes_written{};
+    bool enabled{true};
+};
+
+/// Decodes a binary log file and prints it as text to stdout. Returns false on a malformed file.
+bool DecodeBinaryLog(const std::filesystem::path& path);
+
+} // namespace Common::Log
@@ -11,6 +11,7 @@
 #include <queue>
 
 #include "common/types.h"
+#include "shader_recompiler/ir/pass_stats.h"
 #include "shader_recompiler/runtime_info.h"
 #include "video_core/amdgpu/regs.h"
 #include "video_core/renderer_vulkan/vk_common.h"
@@ -92,6 +93,8 @@ struct ShaderDump {
     std::vector<u32> patch_spv;
     std::string patch_source{};
 
+    std::vector<Shader::IR::PassStats> pass_stats;
+
     bool loaded_data = false;
     bool is_patched = false;
     std::string cache_spv_disasm{};
@@ -100,15 +103,17 @@ struct ShaderDump {
 
     ShaderDump(std::string name, Shader::LogicalStage l_stage, vk::ShaderModule module,
                std::vector<u32> spv, std::vector<u32> isa, std::vector<u32> patch_spv,
-               bool is_patched)
+               std::vector<Shader::IR::PassStats> pass_stats, bool is_patched)
         : name(std::move(name)), l_stage(l_stage), module(module), spv(std::move(spv)),
-          isa(std::move(isa)), patch_spv(std::move(patch_spv)), is_patched(is_patched) {}
+          isa(std::move(isa)), patch_spv(std::move(patch_spv)), pass_stats(std::move(pass_stats)),
+          is_patched(is_patched) {}
 
     ShaderDump(const ShaderDump& other) = delete;
     ShaderDump(ShaderDump&& other) noexcept
         : name{std::move(other.name)}, l_stage(other.l_stage), module{std::move(other.module)},
           spv{std::move(other.spv)}, isa{std::move(other.isa)},
           patch_spv{std::move(other.patch_spv)}, patch_source{std::move(other.patch_source)},
+          pass_stats{std::move(other.pass_stats)},
           cache_spv_disasm{std::move(other.cache_spv_disasm)},
           cache_isa_disasm{std::move(other.cache_isa_disasm)},
           cache_patch_disasm{std::move(other.cache_patch_disasm)} {}
@@ -123,6 +128,7 @@ struct ShaderDump {
         isa = std::move(other.isa);
         patch_spv = std::move(other.patch_spv);
         patch_source = std::move(other.patch_source);
+        pass_stats = std::move(other.pass_stats);
         cache_spv_disasm = std::move(other.cache_spv_disasm);
         cache_isa_disasm = std::move(other.cache_isa_disasm);
         cache_patch_disasm = std::move(other.cache_patch_disasm);
@@ -229,7 +235,7 @@ public:
     void CollectShader(const std::string& name, Shader::LogicalStage l_stage,
                        vk::ShaderModule module, std::span<const u32> spv,
                        std::span<const u32> raw_code, std::span<const u32> patch_spv,
-                       bool is_patched);
+                       std::span<const Shader::IR::PassStats> pass_stats, bool is_patched);
 
 private:
     std::optional<RegDump*> GetRegDump(uintptr_t base_addr, uintptr_t header_addr);
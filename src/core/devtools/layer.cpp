@@ -20,6 +20,7 @@
 #include "widget/memory_map.h"
 #include "widget/module_list.h"
 #include "widget/shader_list.h"
+#include "widget/sync_contention.h"
 
 extern std::unique_ptr<Vulkan::Presenter> presenter;
 
@@ -44,6 +45,7 @@ static bool just_opened_options = false;
 static Widget::MemoryMapViewer memory_map;
 static Widget::ShaderList shader_list;
 static Widget::ModuleList module_list;
+static Widget::SyncContentionViewer sync_contention;
 
 // clang-format off
 static std::string help_text =
@@ -144,6 +146,9 @@ void L::DrawMenuBar() {
             if (MenuItem("Module list")) {
                 module_list.open = true;
             }
+            if (MenuItem("Sync contention")) {
+                sync_contention.open = true;
+            }
             ImGui::EndMenu();
         }
 
@@ -288,6 +293,9 @@ void L::DrawAdvanced() {
     if (module_list.open) {
         module_list.Draw();
     }
+    if (sync_contention.open) {
+        sync_contention.Draw();
+    }
 }
 
 void L::DrawSimple() {
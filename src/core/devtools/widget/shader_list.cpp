@@ -6,6 +6,7 @@
 #include "shader_list.h"
 
 #include <imgui.h>
+#include <nlohmann/json.hpp>
 
 #include "common.h"
 #include "common/config.h"
@@ -24,6 +25,58 @@ using namespace ImGui;
 
 namespace Core::Devtools::Widget {
 
+static void DrawPassStats(std::span<const Shader::IR::PassStats> pass_stats) {
+    if (!BeginTable("pass_stats", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        return;
+    }
+    TableSetupColumn("Pass");
+    TableSetupColumn("Time (us)");
+    TableSetupColumn("Blocks");
+    TableSetupColumn("Instructions");
+    TableSetupColumn("Allocations");
+    TableHeadersRow();
+    for (const auto& stats : pass_stats) {
+        TableNextRow();
+        TableSetColumnIndex(0);
+        TextUnformatted(stats.name);
+        TableSetColumnIndex(1);
+        Text("%.1f", stats.time_ns / 1000.0);
+        TableSetColumnIndex(2);
+        Text("%u -> %u", stats.blocks_before, stats.blocks_after);
+        TableSetColumnIndex(3);
+        Text("%u -> %u", stats.insts_before, stats.insts_after);
+        TableSetColumnIndex(4);
+        Text("%u", stats.arena_allocs);
+    }
+    EndTable();
+}
+
+static void ExportPassStats() {
+    nlohmann::json shaders = nlohmann::json::array();
+    for (const auto& shader : DebugState.shader_dump_list) {
+        nlohmann::json passes = nlohmann::json::array();
+        for (const auto& stats : shader.pass_stats) {
+            passes.push_back({
+                {"name", stats.name},
+                {"time_ns", stats.time_ns},
+                {"blocks_before", stats.blocks_before},
+                {"blocks_after", stats.blocks_after},
+                {"insts_before", stats.insts_before},
+                {"insts_after", stats.insts_after},
+                {"arena_allocs", stats.arena_allocs},
+            });
+        }
+        shaders.push_back({{"name", shader.name}, {"passes", std::move(passes)}});
+    }
+
+    const auto path =
+        Common::FS::GetUserPath(Common::FS::PathType::ShaderDir) / "pass_stats.json";
+    std::ofstream file{path, std::ios::trunc};
+    file << shaders.dump(4);
+    DebugState.ShowDebugMessage("Pass statistics saved to " +
+                                Common::U8stringToString(path.u8string()));
+}
+
 ShaderList::Selection::Selection(int index)
     : index(index), isa_editor(std::make_unique<TextEditor>()),
       glsl_editor(std::make_unique<TextEditor>()) {
@@ -217,6 +270,10 @@ bool ShaderList::Selection::DrawShader(DebugStateType::ShaderDump& value) {
         }
     }
 
+    if (!value.pass_stats.empty() && CollapsingHeader("Pass statistics")) {
+        DrawPassStats(value.pass_stats);
+    }
+
     if (showing_bin) {
         isa_editor->Render(value.is_patched ? "SPIRV" : "ISA", GetContentRegionAvail());
     } else {
@@ -252,6 +309,9 @@ void ShaderList::Draw() {
 
     InputTextEx("##search_shader", "Search by name", search_box, sizeof(search_box), {},
                 ImGuiInputTextFlags_None);
+    if (Button("Export pass stats")) {
+        ExportPassStats();
+    }
 
     auto width = GetContentRegionAvail().x;
     int i = 0;
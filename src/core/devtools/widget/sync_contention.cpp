@@ -0,0 +1,63 @@
+//  SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+//  SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "sync_contention.h"
+
+#include <algorithm>
+#include <functional>
+#include <imgui.h>
+
+#include "core/libraries/kernel/sync/contention.h"
+
+using namespace ImGui;
+
+namespace Core::Devtools::Widget {
+
+void SyncContentionViewer::Draw() {
+    SetNextWindowSize({650.0f, 400.0f}, ImGuiCond_FirstUseEver);
+    if (!Begin("Sync contention", &open)) {
+        End();
+        return;
+    }
+
+    if (!Libraries::Kernel::IsContentionTracked()) {
+        TextWrapped("Contention is not being tracked. Set syncContentionCounters in the Debug "
+                    "section of the config and restart to track objects from the start.");
+        End();
+        return;
+    }
+
+    auto snapshot = Libraries::Kernel::GetContentionSnapshot();
+    std::ranges::sort(snapshot, std::greater{}, &Libraries::Kernel::ContentionSnapshot::wait_ns);
+
+    if (BeginTable("SyncContentionTable", 5,
+                   ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg |
+                       ImGuiTableFlags_ScrollY)) {
+        TableSetupScrollFreeze(0, 1);
+        TableSetupColumn("Kind");
+        TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+        TableSetupColumn("Acquires");
+        TableSetupColumn("Contended");
+        TableSetupColumn("Wait (ms)");
+        TableHeadersRow();
+
+        for (const auto& entry : snapshot) {
+            TableNextRow();
+            TableSetColumnIndex(0);
+            TextUnformatted(entry.kind.c_str());
+            TableSetColumnIndex(1);
+            TextUnformatted(entry.name.c_str());
+            TableSetColumnIndex(2);
+            Text("%llu", static_cast<unsigned long long>(entry.acquires));
+            TableSetColumnIndex(3);
+            Text("%llu", static_cast<unsigned long long>(entry.contended));
+            TableSetColumnIndex(4);
+            Text("%.3f", static_cast<double>(entry.wait_ns) / 1'000'000.0);
+        }
+        EndTable();
+    }
+
+    End();
+}
+
+} // namespace Core::Devtools::Widget
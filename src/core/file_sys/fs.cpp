@@ -2,7 +2,10 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <span>
+#include "common/assert.h"
 #include "common/config.h"
+#include "common/logging/log.h"
 #include "common/string_util.h"
 #include "core/file_sys/devices/logger.h"
 #include "core/file_sys/devices/nop_device.h"
@@ -21,41 +24,208 @@ std::string RemoveTrailingSlashes(const std::string& path) {
     return path_sanitized;
 }
 
+static std::string CollapseSlashes(std::string_view path) {
+    // Evil games like Turok2 pass double slashes e.g /app0//game.kpf
+    std::string corrected_path(path);
+    size_t pos = corrected_path.find("//");
+    while (pos != std::string::npos) {
+        corrected_path.replace(pos, 2, "/");
+        pos = corrected_path.find("//", pos + 1);
+    }
+    return corrected_path;
+}
+
+/// Resolves . and .. components of a path relative to a mount. Fails if it leaves the mount.
+static bool NormalizeRelativePath(std::string_view rel_path, std::string& out) {
+    out.clear();
+    size_t pos = 0;
+    while (pos <= rel_path.size()) {
+        const size_t end = std::min(rel_path.find('/', pos), rel_path.size());
+        const auto part = rel_path.substr(pos, end - pos);
+        pos = end + 1;
+        if (part.empty() || part == ".") {
+            continue;
+        }
+        if (part == "..") {
+            if (out.empty()) {
+                return false;
+            }
+            const size_t parent_end = out.rfind('/');
+            out.resize(parent_end == std::string::npos ? 0 : parent_end);
+            continue;
+        }
+        if (!out.empty()) {
+            out += '/';
+        }
+        out += part;
+    }
+    return true;
+}
+
+/**
+ * Directory tree of a read-only mount and of its patch folder, scanned once when mounted.
+ * Entries of both trees whose names only differ in case are merged into one node, which records
+ * where the entry lives in each tree. The children of a directory are stored next to each other,
+ * so resolving a path or listing a directory touches neither the host filesystem nor a lock.
+ */
+class MountIndex {
+public:
+    struct Node {
+        std::filesystem::path base;  ///< Entry in the base folder, empty if only in the patch
+        std::filesystem::path patch; ///< Entry in the patch folder, empty if not patched
+        bool base_is_dir{};
+        bool patch_is_dir{};
+        u32 first_child{};
+        u32 num_children{};
+    };
+
+    explicit MountIndex(const std::filesystem::path& base_root,
+                        const std::filesystem::path& patch_root) {
+        std::error_code ec;
+        auto& root = nodes.emplace_back();
+        root.base = base_root;
+        root.base_is_dir = true;
+        if (std::filesystem::is_directory(patch_root, ec)) {
+            root.patch = patch_root;
+            root.patch_is_dir = true;
+        }
+        lookup.emplace(std::string{}, 0);
+
+        // Relative paths of the nodes, only needed while building.
+        std::vector<std::string> keys(1);
+        std::vector<std::string> exact_keys(1);
+        tsl::robin_map<std::string, u32> siblings;
+
+        // Directories are visited breadth first, which appends the children of each directory
+        // as one contiguous range.
+        for (u32 i = 0; i < nodes.size(); ++i) {
+            if (!nodes[i].base_is_dir && !nodes[i].patch_is_dir) {
+                continue;
+            }
+            const u32 first_child = static_cast<u32>(nodes.size());
+            siblings.clear();
+            // The directory is taken by value, as adding nodes may move the one it came from.
+            const auto add_entries = [&](std::filesystem::path dir, bool is_patch) {
+                for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+                    const auto name = entry.path().filename().string();
+                    auto folded = Common::ToLower(name);
+                    const bool is_dir = entry.is_directory(ec);
+                    const auto sibling = siblings.find(folded);
+                    if (is_patch && sibling != siblings.end() &&
+                        nodes[sibling->second].patch.empty()) {
+                        auto& node = nodes[sibling->second];
+                        node.patch = entry.path();
+                        node.patch_is_dir = is_dir;
+                        continue;
+                    }
+                    const u32 index = static_cast<u32>(nodes.size());
+                    auto& node = nodes.emplace_back();
+                    (is_patch ? node.patch : node.base) = entry.path();
+                    (is_patch ? node.patch_is_dir : node.base_is_dir) = is_dir;
+                    siblings.emplace(folded, index);
+                    keys.push_back(i == 0 ? folded : keys[i] + '/' + folded);
+                    exact_keys.push_back(i == 0 ? name : exact_keys[i] + '/' + name);
+                    if (!lookup.emplace(keys.back(), index).second) {
+                        case_conflicts.emplace(exact_keys.back(), index);
+                    }
+                }
+            };
+            if (nodes[i].base_is_dir) {
+                add_entries(nodes[i].base, false);
+            }
+            if (nodes[i].patch_is_dir) {
+                add_entries(nodes[i].patch, true);
+            }
+            nodes[i].first_child = first_child;
+            nodes[i].num_children = static_cast<u32>(nodes.size()) - first_child;
+        }
+    }
+
+    /// Returns the node of a path relative to the mount, or nullptr if neither tree has it.
+    const Node* Find(std::string_view rel_path) const {
+        std::string key;
+        if (!NormalizeRelativePath(rel_path, key)) {
+            return nullptr;
+        }
+        if (!case_conflicts.empty()) {
+            if (const auto it = case_conflicts.find(key); it != case_conflicts.end()) {
+                return &nodes[it->second];
+            }
+        }
+        Common::ToLowerInPlace(key);
+        const auto it = lookup.find(key);
+        return it == lookup.end() ? nullptr : &nodes[it->second];
+    }
+
+    std::span<const Node> Children(const Node& node) const {
+        return std::span{nodes}.subspan(node.first_child, node.num_children);
+    }
+
+    size_t Size() const {
+        return nodes.size();
+    }
+
+private:
+    std::vector<Node> nodes;
+    tsl::robin_map<std::string, u32> lookup; ///< Case folded relative path to node
+    tsl::robin_map<std::string, u32> case_conflicts; ///< Exact paths of folded path collisions
+};
+
 void MntPoints::Mount(const std::filesystem::path& host_folder, const std::string& guest_folder,
                       bool read_only) {
     std::scoped_lock lock{m_mutex};
     const auto guest_folder_sanitized = RemoveTrailingSlashes(guest_folder);
-    m_mnt_pairs.emplace_back(host_folder, guest_folder_sanitized, read_only);
+
+    // The game folder and its patch never change while running, so they are scanned once here.
+    auto mounts = *LoadMounts();
+    std::shared_ptr<const MountIndex> index;
+    if (read_only && (guest_folder_sanitized == "/app0" || guest_folder_sanitized == "/hostapp")) {
+        const auto it = std::ranges::find_if(mounts, [&](const MntPair& pair) {
+            return pair.index && pair.host_path == host_folder;
+        });
+        if (it != mounts.end()) {
+            index = it->index;
+        } else {
+            auto patch_folder = host_folder;
+            patch_folder += "-UPDATE";
+            if (!std::filesystem::exists(patch_folder)) {
+                patch_folder = host_folder;
+                patch_folder += "-patch";
+            }
+            index = std::make_shared<const MountIndex>(host_folder, patch_folder);
+            LOG_INFO(Kernel_Fs, "Indexed {} entries for {}", index->Size(),
+                     guest_folder_sanitized);
+        }
+    }
+    mounts.emplace_back(host_folder, guest_folder_sanitized, read_only, std::move(index));
+    PublishMounts(std::move(mounts));
 }
 
 void MntPoints::Unmount(const std::filesystem::path& host_folder, const std::string& guest_folder) {
     std::scoped_lock lock{m_mutex};
     const auto guest_folder_sanitized = RemoveTrailingSlashes(guest_folder);
-    auto it = std::remove_if(m_mnt_pairs.begin(), m_mnt_pairs.end(), [&](const MntPair& pair) {
-        return pair.mount == guest_folder_sanitized;
-    });
-    m_mnt_pairs.erase(it, m_mnt_pairs.end());
+    auto mounts = *LoadMounts();
+    std::erase_if(mounts,
+                  [&](const MntPair& pair) { return pair.mount == guest_folder_sanitized; });
+    PublishMounts(std::move(mounts));
+    // The folder may be mounted again after its contents changed.
+    path_cache.clear();
 }
 
 void MntPoints::UnmountAll() {
     std::scoped_lock lock{m_mutex};
-    m_mnt_pairs.clear();
+    PublishMounts({});
+    path_cache.clear();
 }
 
 std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_read_only,
                                              bool force_base_path) {
-    // Evil games like Turok2 pass double slashes e.g /app0//game.kpf
-    std::string corrected_path(path);
-    size_t pos = corrected_path.find("//");
-    while (pos != std::string::npos) {
-        corrected_path.replace(pos, 2, "/");
-        pos = corrected_path.find("//", pos + 1);
-    }
+    const auto corrected_path = CollapseSlashes(path);
 
     if (path.length() > 255)
         return "";
 
-    const MntPair* mount = GetMount(corrected_path);
+    const auto mount = GetMount(corrected_path);
     if (!mount) {
         return "";
     }
@@ -72,6 +242,19 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
 
     // Remove device (e.g /app0) from path to retrieve relative path.
     const auto rel_path = std::string_view{corrected_path}.substr(mount->mount.size() + 1);
+    if (mount->index) {
+        if (const auto* node = mount->index->Find(rel_path)) {
+            if (!force_base_path && !ignore_game_patches && !node->patch.empty()) {
+                return node->patch;
+            }
+            if (!node->base.empty()) {
+                return node->base;
+            }
+        }
+        // Opening a path that neither tree has fails, just as it would on the console.
+        return mount->host_path / rel_path;
+    }
+
     std::filesystem::path host_path = mount->host_path / rel_path;
     std::filesystem::path patch_path = mount->host_path;
     patch_path += "-UPDATE";
@@ -159,6 +342,33 @@ std::filesystem::path MntPoints::GetHostPath(std::string_view path, bool* is_rea
 // TODO: Does not handle mount points inside mount points.
 void MntPoints::IterateDirectory(std::string_view guest_directory,
                                  const IterateDirectoryCallback& callback) {
+    const auto corrected_path = RemoveTrailingSlashes(CollapseSlashes(guest_directory));
+    const auto mount = GetMount(corrected_path);
+    if (mount && mount->index) {
+        const auto rel_path = corrected_path.size() > mount->mount.size()
+                                  ? std::string_view{corrected_path}.substr(mount->mount.size() + 1)
+                                  : std::string_view{};
+        const auto* node = mount->index->Find(rel_path);
+        const auto base_path =
+            node && !node->base.empty() ? node->base : mount->host_path / rel_path;
+
+        // Prepend entries for . and .., as both are treated as files on PS4.
+        callback(base_path / ".", false);
+        callback(base_path / "..", false);
+        if (!node) {
+            return;
+        }
+        // Entries of the base directory come first, followed by those only in the patch.
+        for (const auto& child : mount->index->Children(*node)) {
+            if (!ignore_game_patches && !child.patch.empty()) {
+                callback(child.patch, !child.patch_is_dir);
+            } else if (!child.base.empty()) {
+                callback(child.base, !child.base_is_dir);
+            }
+        }
+        return;
+    }
+
     const auto base_path = GetHostPath(guest_directory, nullptr, true);
     const auto patch_path = GetHostPath(guest_directory, nullptr, false);
     // Only need to consider patch path if it exists and does not resolve to the same as base.
@@ -193,88 +403,175 @@ void MntPoints::IterateDirectory(std::string_view guest_directory,
     }
 }
 
-int HandleTable::CreateHandle() {
-    std::scoped_lock lock{m_mutex};
+// Closed files are kept here for reuse. They are never freed, so a thread that loaded a
+// descriptor slot right before it was closed can still safely look at the reference count.
+static std::mutex free_files_mutex;
+static std::vector<File*> free_files;
+
+static bool TryAddRef(File* file) {
+    u32 ref_count = file->ref_count.load(std::memory_order_relaxed);
+    do {
+        if (ref_count == 0) {
+            return false;
+        }
+    } while (!file->ref_count.compare_exchange_weak(ref_count, ref_count + 1,
+                                                    std::memory_order_acquire,
+                                                    std::memory_order_relaxed));
+    return true;
+}
 
-    auto* file = new File{};
+static void ReleaseFile(File* file) {
+    if (file->ref_count.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    file->f.Close();
+    file->directory.reset();
+    file->device.reset();
+    file->socket.reset();
+    file->epoll.reset();
+    file->resolver.reset();
+    file->m_host_name.clear();
+    file->m_guest_name.clear();
+    file->type = FileType::Regular;
     file->is_opened = false;
 
-    int existingFilesNum = m_files.size();
+    std::scoped_lock lock{free_files_mutex};
+    free_files.push_back(file);
+}
 
-    for (int index = 0; index < existingFilesNum; index++) {
-        if (m_files.at(index) == nullptr) {
-            m_files[index] = file;
-            return index;
-        }
+FileRef::FileRef(const FileRef& other) : file{other.file} {
+    if (file) {
+        file->ref_count.fetch_add(1, std::memory_order_relaxed);
     }
+}
 
-    m_files.push_back(file);
-    return m_files.size() - 1;
+FileRef::~FileRef() {
+    if (file) {
+        ReleaseFile(file);
+    }
 }
 
-void HandleTable::DeleteHandle(int d) {
-    std::scoped_lock lock{m_mutex};
-    delete m_files.at(d);
-    m_files[d] = nullptr;
+HandleTable::~HandleTable() {
+    for (auto& page : m_pages) {
+        delete page.load();
+    }
 }
 
-File* HandleTable::GetFile(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
+File* HandleTable::LoadSlot(int d) const {
+    if (d < 0 || static_cast<size_t>(d) >= MaxPages * FilesPerPage) {
+        return nullptr;
+    }
+    const Page* page = m_pages[d / FilesPerPage].load(std::memory_order_acquire);
+    if (!page) {
         return nullptr;
     }
-    return m_files.at(d);
+    return (*page)[d % FilesPerPage].load(std::memory_order_acquire);
 }
 
-File* HandleTable::GetSocket(int d) {
+int HandleTable::CreateHandle() {
     std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
+
+    File* file = nullptr;
+    {
+        std::scoped_lock free_lock{free_files_mutex};
+        if (!free_files.empty()) {
+            file = free_files.back();
+            free_files.pop_back();
+        }
     }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Socket) {
-        return nullptr;
+    if (!file) {
+        file = new File{};
     }
-    return file;
+    file->is_opened = false;
+    file->ref_count.store(1, std::memory_order_relaxed);
+
+    // Hand out the lowest free descriptor, as POSIX requires.
+    for (size_t page_index = 0; page_index < MaxPages; page_index++) {
+        Page* page = m_pages[page_index].load(std::memory_order_relaxed);
+        if (!page) {
+            page = new Page{};
+            m_pages[page_index].store(page, std::memory_order_release);
+        }
+        for (size_t index = 0; index < FilesPerPage; index++) {
+            auto& slot = (*page)[index];
+            if (slot.load(std::memory_order_relaxed) == nullptr) {
+                slot.store(file, std::memory_order_release);
+                return static_cast<int>(page_index * FilesPerPage + index);
+            }
+        }
+    }
+    UNREACHABLE_MSG("Ran out of file descriptors");
 }
 
-File* HandleTable::GetEpoll(int d) {
+void HandleTable::DeleteHandle(int d) {
     std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
+    if (d < 0 || static_cast<size_t>(d) >= MaxPages * FilesPerPage) {
+        return;
     }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Epoll) {
-        return nullptr;
+    Page* page = m_pages[d / FilesPerPage].load(std::memory_order_relaxed);
+    if (!page) {
+        return;
+    }
+    // The file itself is reset once the last reference to it is gone.
+    if (File* file = (*page)[d % FilesPerPage].exchange(nullptr, std::memory_order_acq_rel)) {
+        ReleaseFile(file);
+    }
+}
+
+FileRef HandleTable::GetFile(int d) {
+    File* file = LoadSlot(d);
+    if (!file || !TryAddRef(file)) {
+        return {};
+    }
+    // The descriptor may have been closed, and the file reused for another one, in between.
+    FileRef ref{file};
+    if (LoadSlot(d) != file) {
+        return {};
+    }
+    return ref;
+}
+
+FileRef HandleTable::GetSocket(int d) {
+    auto file = GetFile(d);
+    if (!file || file->type != Core::FileSys::FileType::Socket) {
+        return {};
     }
     return file;
 }
 
-File* HandleTable::GetResolver(int d) {
-    std::scoped_lock lock{m_mutex};
-    if (d < 0 || d >= m_files.size()) {
-        return nullptr;
+FileRef HandleTable::GetEpoll(int d) {
+    auto file = GetFile(d);
+    if (!file || file->type != Core::FileSys::FileType::Epoll) {
+        return {};
     }
-    auto file = m_files.at(d);
-    if (file->type != Core::FileSys::FileType::Resolver) {
-        return nullptr;
+    return file;
+}
+
+FileRef HandleTable::GetResolver(int d) {
+    auto file = GetFile(d);
+    if (!file || file->type != Core::FileSys::FileType::Resolver) {
+        return {};
     }
     return file;
 }
 
-File* HandleTable::GetFile(const std::filesystem::path& host_name) {
-    for (auto* file : m_files) {
-        if (file != nullptr && file->m_host_name == host_name) {
+FileRef HandleTable::GetFile(const std::filesystem::path& host_name) {
+    for (size_t d = 0; d < MaxPages * FilesPerPage; d++) {
+        if (d % FilesPerPage == 0 && !m_pages[d / FilesPerPage].load(std::memory_order_acquire)) {
+            break;
+        }
+        auto file = GetFile(static_cast<int>(d));
+        if (file && file->m_host_name == host_name) {
             return file;
         }
     }
-    return nullptr;
+    return {};
 }
 
 void HandleTable::CreateStdHandles() {
     auto setup = [this](const char* path, auto* device) {
         int fd = CreateHandle();
-        auto* file = GetFile(fd);
+        auto file = GetFile(fd);
         file->is_opened = true;
         file->type = FileType::Device;
         file->m_guest_name = path;
@@ -288,11 +585,13 @@ void HandleTable::CreateStdHandles() {
 }
 
 int HandleTable::GetFileDescriptor(File* file) {
-    std::scoped_lock lock{m_mutex};
-    auto it = std::find(m_files.begin(), m_files.end(), file);
-
-    if (it != m_files.end()) {
-        return std::distance(m_files.begin(), it);
+    for (size_t d = 0; d < MaxPages * FilesPerPage; d++) {
+        if (d % FilesPerPage == 0 && !m_pages[d / FilesPerPage].load(std::memory_order_acquire)) {
+            break;
+        }
+        if (LoadSlot(static_cast<int>(d)) == file) {
+            return static_cast<int>(d);
+        }
     }
     return 0;
 }
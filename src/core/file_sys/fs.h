@@ -3,9 +3,12 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 #include <tsl/robin_map.h>
 #include "common/io_file.h"
@@ -21,6 +24,8 @@ struct Resolver;
 
 namespace Core::FileSys {
 
+class MountIndex;
+
 class MntPoints {
 #ifdef _WIN64
     static constexpr bool NeedsCaseInsensitiveSearch = false;
@@ -33,7 +38,10 @@ public:
         std::filesystem::path host_path;
         std::string mount; // e.g /app0
         bool read_only;
+        std::shared_ptr<const MountIndex> index; // only set for the read-only game mounts
     };
+    using MountList = std::vector<MntPair>;
+    using MountRef = std::shared_ptr<const MntPair>; // keeps its mount list alive while held
 
     explicit MntPoints() = default;
     ~MntPoints() = default;
@@ -50,26 +58,38 @@ public:
     void IterateDirectory(std::string_view guest_directory,
                           const IterateDirectoryCallback& callback);
 
-    const MntPair* GetMountFromHostPath(const std::string& host_path) {
-        std::scoped_lock lock{m_mutex};
-        const auto it = std::ranges::find_if(m_mnt_pairs, [&](const MntPair& mount) {
+    MountRef GetMountFromHostPath(const std::string& host_path) const {
+        const auto mounts = LoadMounts();
+        const auto it = std::ranges::find_if(*mounts, [&](const MntPair& mount) {
             return host_path.starts_with(std::string{fmt::UTF(mount.host_path.u8string()).data});
         });
-        return it == m_mnt_pairs.end() ? nullptr : &*it;
+        return it == mounts->end() ? nullptr : MountRef{mounts, &*it};
     }
 
-    const MntPair* GetMount(const std::string& guest_path) {
-        std::scoped_lock lock{m_mutex};
-        const auto it = std::ranges::find_if(m_mnt_pairs, [&](const auto& mount) {
+    MountRef GetMount(const std::string& guest_path) const {
+        const auto mounts = LoadMounts();
+        const auto it = std::ranges::find_if(*mounts, [&](const auto& mount) {
             // When doing starts-with check, add a trailing slash to make sure we don't match
             // against only part of the mount path.
             return guest_path == mount.mount || guest_path.starts_with(mount.mount + "/");
         });
-        return it == m_mnt_pairs.end() ? nullptr : &*it;
+        return it == mounts->end() ? nullptr : MountRef{mounts, &*it};
     }
 
 private:
-    std::vector<MntPair> m_mnt_pairs;
+    /// The mount list is never modified in place. Changes publish a new list under m_mutex, so
+    /// lookups only load the current one and do not take the lock. The free atomic functions
+    /// are used because libc++ has no std::atomic<std::shared_ptr>.
+    std::shared_ptr<const MountList> LoadMounts() const {
+        return std::atomic_load_explicit(&m_mounts, std::memory_order_acquire);
+    }
+
+    void PublishMounts(MountList mounts) {
+        std::atomic_store_explicit(&m_mounts, std::make_shared<const MountList>(std::move(mounts)),
+                                   std::memory_order_release);
+    }
+
+    std::shared_ptr<const MountList> m_mounts = std::make_shared<const MountList>();
     std::vector<std::filesystem::path> path_parts;
     tsl::robin_map<std::filesystem::path, std::filesystem::path> path_cache;
     std::mutex m_mutex;
@@ -85,6 +105,7 @@ enum class FileType {
 };
 
 struct File {
+    std::atomic<u32> ref_count{}; // one for the descriptor table and one per FileRef
     std::atomic_bool is_opened{};
     std::atomic<FileType> type{FileType::Regular};
     std::filesystem::path m_host_name;
@@ -98,24 +119,73 @@ struct File {
     std::shared_ptr<Libraries::Net::Resolver> resolver;    // only valid for type == Resolver
 };
 
+/**
+ * Reference to an open file that keeps it from being reset and reused while held, even if its
+ * descriptor is closed in the meantime. Converts to a plain pointer for existing interfaces.
+ */
+class FileRef {
+public:
+    FileRef() = default;
+    FileRef(std::nullptr_t) {}
+    explicit FileRef(File* file_) : file{file_} {}
+    FileRef(const FileRef& other);
+    FileRef(FileRef&& other) noexcept : file{std::exchange(other.file, nullptr)} {}
+    ~FileRef();
+
+    FileRef& operator=(FileRef other) noexcept {
+        std::swap(file, other.file);
+        return *this;
+    }
+
+    File* get() const {
+        return file;
+    }
+
+    File* operator->() const {
+        return file;
+    }
+
+    File& operator*() const {
+        return *file;
+    }
+
+    operator File*() const {
+        return file;
+    }
+
+private:
+    File* file{};
+};
+
+/**
+ * Descriptor table split into pages that are allocated on demand and never moved, so looking up
+ * a descriptor is a pair of atomic loads. Closed files are reset and kept for reuse rather than
+ * freed, which lets a lookup take a reference after loading the slot without a lock.
+ */
 class HandleTable {
+    static constexpr size_t FilesPerPage = 256;
+    static constexpr size_t MaxPages = 256;
+    using Page = std::array<std::atomic<File*>, FilesPerPage>;
+
 public:
     HandleTable() = default;
-    virtual ~HandleTable() = default;
+    virtual ~HandleTable();
 
     int CreateHandle();
     void DeleteHandle(int d);
-    File* GetFile(int d);
-    File* GetSocket(int d);
-    File* GetEpoll(int d);
-    File* GetResolver(int d);
-    File* GetFile(const std::filesystem::path& host_name);
+    FileRef GetFile(int d);
+    FileRef GetSocket(int d);
+    FileRef GetEpoll(int d);
+    FileRef GetResolver(int d);
+    FileRef GetFile(const std::filesystem::path& host_name);
     int GetFileDescriptor(File* file);
 
     void CreateStdHandles();
 
 private:
-    std::vector<File*> m_files;
+    File* LoadSlot(int d) const;
+
+    std::array<std::atomic<Page*>, MaxPages> m_pages{};
     std::mutex m_mutex;
 };
 
@@ -53,6 +53,7 @@ struct AjmBatch {
     std::atomic_bool waiting{};
     std::atomic_bool canceled{};
     std::atomic_bool processed{};
+    std::atomic<u32> pending_runs{};
     std::binary_semaphore finished{0};
     boost::container::small_vector<AjmJob, 16> jobs;
 
@@ -0,0 +1,519 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "core/libraries/ajm/ajm_batch.h"
+#include "core/libraries/ajm/ajm_capture.h"
+#include "core/libraries/ajm/ajm_context.h"
+#include "core/libraries/ajm/ajm_instance.h"
+#include "core/libraries/error_codes.h"
+
+namespace Libraries::Ajm {
+
+namespace {
+
+using namespace Common::FS;
+
+constexpr u32 CaptureMagic = 0x434D4A41; // AJMC
+constexpr u32 CaptureVersion = 1;
+constexpr u32 MaxBatchesInFlight = 512;
+constexpr u32 CodecInfoSize = 64;
+constexpr u32 StatisticsInstance = std::numeric_limits<u32>::max();
+
+enum class RecordType : u32 {
+    Instance = 0,
+    Batch = 1,
+};
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+};
+
+/// Every record is followed by its payload, an InstanceRecord or the jobs of a batch.
+struct RecordHeader {
+    RecordType type;
+    u32 context; ///< Capture id of the context the record belongs to
+    u64 size;    ///< Byte size of the payload
+};
+static_assert(sizeof(RecordHeader) == 16);
+
+struct InstanceRecord {
+    u32 instance_id;
+    AjmCodecType codec_type;
+    u64 flags;
+};
+static_assert(sizeof(InstanceRecord) == 16);
+
+/// Which optional inputs follow a job record and which sideband outputs the job had.
+enum JobField : u32 {
+    InputInitParams = 1 << 0,
+    InputResampleParameters = 1 << 1,
+    InputStatisticsEngineParameters = 1 << 2,
+    InputFormat = 1 << 3,
+    InputGaplessDecode = 1 << 4,
+    OutputResult = 1 << 8,
+    OutputStream = 1 << 9,
+    OutputFormat = 1 << 10,
+    OutputMemory = 1 << 11,
+    OutputEnginePerCodec = 1 << 12,
+    OutputEngine = 1 << 13,
+    OutputGaplessDecode = 1 << 14,
+    OutputMFrame = 1 << 15,
+    OutputCodecInfo = 1 << 16,
+};
+
+/// A batch payload is the job count followed by the jobs. Each job record is followed by the
+/// optional inputs in field order, the input data and the byte size of each output buffer.
+struct JobRecord {
+    u32 instance_id;
+    u32 fields;
+    u64 flags;
+    u32 input_size;
+    u32 num_output_buffers;
+};
+static_assert(sizeof(JobRecord) == 24);
+
+template <typename T>
+void Append(std::vector<u8>& out, const T& object) {
+    const auto* bytes = reinterpret_cast<const u8*>(&object);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+void AppendOptional(std::vector<u8>& out, const std::optional<T>& object, u32 field,
+                    u32& fields) {
+    if (object.has_value()) {
+        Append(out, *object);
+        fields |= field;
+    }
+}
+
+class PayloadReader {
+public:
+    explicit PayloadReader(std::span<const u8> data_) : data{data_} {}
+
+    template <typename T>
+    bool Read(T& object) {
+        if (sizeof(T) > data.size() - offset) {
+            return false;
+        }
+        std::memcpy(&object, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    bool ReadOptional(std::optional<T>& object, u32 field, u32 fields) {
+        if ((fields & field) == 0) {
+            return true;
+        }
+        return Read(object.emplace());
+    }
+
+    bool ReadBytes(std::vector<u8>& out, size_t size) {
+        if (size > data.size() - offset) {
+            return false;
+        }
+        out.assign(data.begin() + offset, data.begin() + offset + size);
+        offset += size;
+        return true;
+    }
+
+private:
+    std::span<const u8> data;
+    size_t offset{};
+};
+
+class Recorder {
+public:
+    explicit Recorder(const std::filesystem::path& path) : file{path, FileAccessMode::Write} {
+        file.WriteObject(FileHeader{CaptureMagic, CaptureVersion});
+    }
+
+    bool IsOpen() const {
+        return file.IsOpen();
+    }
+
+    void RecordInstance(u32 context, u32 instance_id, AjmCodecType codec_type,
+                        AjmInstanceFlags flags) {
+        std::scoped_lock lk{mutex};
+        file.WriteObject(RecordHeader{RecordType::Instance, context, sizeof(InstanceRecord)});
+        file.WriteObject(InstanceRecord{instance_id, codec_type, flags.raw});
+    }
+
+    void RecordBatch(u32 context, const AjmBatch& batch) {
+        std::vector<u8> payload;
+        Append(payload, static_cast<u32>(batch.jobs.size()));
+        for (const auto& job : batch.jobs) {
+            const auto& input = job.input;
+            const auto& output = job.output;
+            const size_t record_offset = payload.size();
+            Append(payload, JobRecord{});
+
+            u32 fields{};
+            AppendOptional(payload, input.init_params, InputInitParams, fields);
+            AppendOptional(payload, input.resample_parameters, InputResampleParameters, fields);
+            AppendOptional(payload, input.statistics_engine_parameters,
+                           InputStatisticsEngineParameters, fields);
+            AppendOptional(payload, input.format, InputFormat, fields);
+            AppendOptional(payload, input.gapless_decode, InputGaplessDecode, fields);
+            payload.insert(payload.end(), input.buffer.begin(), input.buffer.end());
+            for (const auto& buffer : output.buffers) {
+                Append(payload, static_cast<u64>(buffer.size()));
+            }
+
+            const auto set_if = [&fields](const void* pointer, u32 field) {
+                fields |= pointer != nullptr ? field : 0;
+            };
+            set_if(output.p_result, OutputResult);
+            set_if(output.p_stream, OutputStream);
+            set_if(output.p_format, OutputFormat);
+            set_if(output.p_memory, OutputMemory);
+            set_if(output.p_engine_per_codec, OutputEnginePerCodec);
+            set_if(output.p_engine, OutputEngine);
+            set_if(output.p_gapless_decode, OutputGaplessDecode);
+            set_if(output.p_mframe, OutputMFrame);
+            set_if(output.p_codec_info, OutputCodecInfo);
+
+            const JobRecord record{
+                .instance_id = job.instance_id,
+                .fields = fields,
+                .flags = job.flags.raw,
+                .input_size = static_cast<u32>(input.buffer.size()),
+                .num_output_buffers = static_cast<u32>(output.buffers.size()),
+            };
+            std::memcpy(payload.data() + record_offset, &record, sizeof(record));
+        }
+
+        std::scoped_lock lk{mutex};
+        file.WriteObject(RecordHeader{RecordType::Batch, context, payload.size()});
+        file.WriteSpan(std::span<const u8>{payload});
+    }
+
+private:
+    IOFile file;
+    std::mutex mutex;
+};
+
+struct CapturedInstance {
+    AjmCodecType codec_type;
+    AjmInstanceFlags flags;
+};
+
+struct CapturedJob {
+    u32 instance; ///< Index into the captured instances or StatisticsInstance
+    u32 fields;
+    AjmJobFlags flags;
+    AjmJob::Input input;
+    std::vector<u64> output_sizes;
+};
+
+using CapturedBatch = std::vector<CapturedJob>;
+
+struct Capture {
+    std::vector<CapturedInstance> instances;
+    std::vector<CapturedBatch> batches;
+};
+
+/// Storage for the outputs of a replayed job.
+struct JobOutput {
+    AjmSidebandResult result;
+    AjmSidebandStream stream;
+    AjmSidebandFormat format;
+    AjmSidebandStatisticsMemory memory;
+    AjmSidebandStatisticsEnginePerCodec engine_per_codec;
+    AjmSidebandStatisticsEngine engine;
+    AjmSidebandGaplessDecode gapless_decode;
+    AjmSidebandMFrame mframe;
+    std::array<u8, CodecInfoSize> codec_info;
+    std::vector<u8> buffer;
+    u8 pcm_size; ///< Bytes per decoded sample, 0 for statistics jobs
+};
+
+/// A batch in flight along with the storage its jobs write to.
+struct ReplaySlot {
+    u32 batch_id;
+    bool in_use;
+    std::vector<JobOutput> outputs;
+};
+
+std::filesystem::path capture_path;
+std::unique_ptr<Recorder> recorder;
+std::once_flag recorder_init;
+std::atomic<bool> is_capturing{};
+
+/// The recorder is created on the first record, after logging has been set up.
+Recorder* GetRecorder() {
+    std::call_once(recorder_init, [] {
+        recorder = std::make_unique<Recorder>(capture_path);
+        if (!recorder->IsOpen()) {
+            LOG_ERROR(Lib_Ajm, "Unable to create AJM capture file {}",
+                      PathToUTF8String(capture_path));
+            recorder.reset();
+            is_capturing = false;
+            return;
+        }
+        LOG_INFO(Lib_Ajm, "Recording AJM batches to {}", PathToUTF8String(capture_path));
+    });
+    return recorder.get();
+}
+
+bool ParseBatch(PayloadReader& reader, const std::map<std::pair<u32, u32>, u32>& instance_map,
+                u32 context, CapturedBatch& batch) {
+    u32 num_jobs{};
+    if (!reader.Read(num_jobs)) {
+        return false;
+    }
+    batch.resize(num_jobs);
+    for (auto& job : batch) {
+        JobRecord record;
+        if (!reader.Read(record)) {
+            return false;
+        }
+        if (record.instance_id == AJM_INSTANCE_STATISTICS) {
+            job.instance = StatisticsInstance;
+        } else if (const auto it = instance_map.find({context, record.instance_id});
+                   it != instance_map.end()) {
+            job.instance = it->second;
+        } else {
+            LOG_ERROR(Lib_Ajm, "AJM capture references unknown instance {}", record.instance_id);
+            return false;
+        }
+        job.fields = record.fields;
+        job.flags.raw = record.flags;
+
+        auto& input = job.input;
+        const u32 fields = record.fields;
+        if (!reader.ReadOptional(input.init_params, InputInitParams, fields) ||
+            !reader.ReadOptional(input.resample_parameters, InputResampleParameters, fields) ||
+            !reader.ReadOptional(input.statistics_engine_parameters,
+                                 InputStatisticsEngineParameters, fields) ||
+            !reader.ReadOptional(input.format, InputFormat, fields) ||
+            !reader.ReadOptional(input.gapless_decode, InputGaplessDecode, fields) ||
+            !reader.ReadBytes(input.buffer, record.input_size)) {
+            return false;
+        }
+        job.output_sizes.resize(record.num_output_buffers);
+        for (auto& size : job.output_sizes) {
+            if (!reader.Read(size)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::optional<Capture> LoadCapture(const std::filesystem::path& path) {
+    const IOFile file{path, FileAccessMode::Read};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Lib_Ajm, "Unable to open AJM capture {}", PathToUTF8String(path));
+        return std::nullopt;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.Read(data) != data.size() || data.size() < sizeof(FileHeader)) {
+        LOG_ERROR(Lib_Ajm, "Unable to read AJM capture {}", PathToUTF8String(path));
+        return std::nullopt;
+    }
+    FileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != CaptureMagic || header.version != CaptureVersion) {
+        LOG_ERROR(Lib_Ajm, "Unsupported AJM capture {}", PathToUTF8String(path));
+        return std::nullopt;
+    }
+
+    // Instance ids are only unique within a context and may be reused after destruction.
+    std::map<std::pair<u32, u32>, u32> instance_map;
+    Capture capture;
+    size_t offset = sizeof(FileHeader);
+    while (offset + sizeof(RecordHeader) <= data.size()) {
+        RecordHeader record;
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        if (record.size > data.size() - offset) {
+            LOG_WARNING(Lib_Ajm, "AJM capture is truncated at offset {:#x}", offset);
+            break;
+        }
+        PayloadReader reader{std::span{data}.subspan(offset, record.size)};
+        offset += record.size;
+
+        if (record.type == RecordType::Instance) {
+            InstanceRecord instance;
+            if (!reader.Read(instance)) {
+                return std::nullopt;
+            }
+            instance_map[{record.context, instance.instance_id}] =
+                static_cast<u32>(capture.instances.size());
+            capture.instances.push_back({instance.codec_type, {.raw = instance.flags}});
+        } else if (record.type == RecordType::Batch) {
+            if (!ParseBatch(reader, instance_map, record.context,
+                            capture.batches.emplace_back())) {
+                LOG_ERROR(Lib_Ajm, "Malformed batch in AJM capture {}", PathToUTF8String(path));
+                return std::nullopt;
+            }
+        }
+    }
+    return capture;
+}
+
+/// Builds a batch of a capture whose jobs decode into the storage of the slot.
+std::shared_ptr<AjmBatch> BuildBatch(const Capture& capture, const CapturedBatch& captured,
+                                     std::span<const u32> instance_ids, ReplaySlot& slot) {
+    auto batch = std::make_shared<AjmBatch>();
+    slot.outputs.resize(captured.size());
+    for (size_t i = 0; i < captured.size(); i++) {
+        const auto& captured_job = captured[i];
+        auto& storage = slot.outputs[i];
+        auto& job = batch->jobs.emplace_back();
+
+        const bool is_statistics = captured_job.instance == StatisticsInstance;
+        job.instance_id =
+            is_statistics ? AJM_INSTANCE_STATISTICS : instance_ids[captured_job.instance];
+        job.flags = captured_job.flags;
+        job.input = captured_job.input;
+
+        u64 output_size{};
+        for (const u64 size : captured_job.output_sizes) {
+            output_size += size;
+        }
+        storage.buffer.resize(output_size);
+        u8* buffer = storage.buffer.data();
+        for (const u64 size : captured_job.output_sizes) {
+            job.output.buffers.emplace_back(buffer, size);
+            buffer += size;
+        }
+
+        // The stream sideband is always requested, it reports the decoded amount.
+        const auto fields = captured_job.fields;
+        const auto select = [fields](auto* pointer, u32 field) {
+            return (fields & field) != 0 ? pointer : nullptr;
+        };
+        auto& output = job.output;
+        output.p_result = &storage.result;
+        output.p_stream = &storage.stream;
+        output.p_format = select(&storage.format, OutputFormat);
+        output.p_memory = select(&storage.memory, OutputMemory);
+        output.p_engine_per_codec = select(&storage.engine_per_codec, OutputEnginePerCodec);
+        output.p_engine = select(&storage.engine, OutputEngine);
+        output.p_gapless_decode = select(&storage.gapless_decode, OutputGaplessDecode);
+        output.p_mframe = select(&storage.mframe, OutputMFrame);
+        output.p_codec_info = select(storage.codec_info.data(), OutputCodecInfo);
+
+        storage.stream = {};
+        storage.pcm_size = 0;
+        if (!is_statistics) {
+            const auto& flags = capture.instances[captured_job.instance].flags;
+            storage.pcm_size = GetPCMSize(AjmFormatEncoding(flags.format));
+        }
+    }
+    return batch;
+}
+
+/// Waits for the batch of a slot and returns the number of samples it decoded.
+u64 RetireSlot(AjmContext& context, ReplaySlot& slot) {
+    if (!slot.in_use) {
+        return 0;
+    }
+    context.BatchWait(slot.batch_id, -1, nullptr);
+    slot.in_use = false;
+    u64 num_samples{};
+    for (const auto& output : slot.outputs) {
+        if (output.pcm_size != 0 && output.stream.output_written > 0) {
+            num_samples += output.stream.output_written / output.pcm_size;
+        }
+    }
+    return num_samples;
+}
+
+} // Anonymous namespace
+
+void StartAjmCapture(const std::filesystem::path& path) {
+    capture_path = path;
+    is_capturing = true;
+}
+
+bool IsAjmCapturing() {
+    return is_capturing;
+}
+
+void CaptureAjmInstance(u32 context, u32 instance_id, AjmCodecType codec_type,
+                        AjmInstanceFlags flags) {
+    if (auto* rec = GetRecorder()) {
+        rec->RecordInstance(context, instance_id, codec_type, flags);
+    }
+}
+
+void CaptureAjmBatch(u32 context, const AjmBatch& batch) {
+    if (auto* rec = GetRecorder()) {
+        rec->RecordBatch(context, batch);
+    }
+}
+
+bool ReplayAjmCapture(const std::filesystem::path& path) {
+    const auto capture = LoadCapture(path);
+    if (!capture) {
+        return false;
+    }
+
+    const u32 max_workers = std::max(1U, std::thread::hardware_concurrency());
+    std::vector<u32> instance_ids(capture->instances.size());
+    std::vector<ReplaySlot> slots(MaxBatchesInFlight);
+    for (u32 num_workers = 1;; num_workers = std::min(num_workers * 2, max_workers)) {
+        // Each pass starts from fresh instances, so every pass decodes the same stream.
+        AjmContext context{num_workers};
+        for (size_t i = 0; i < capture->instances.size(); i++) {
+            const auto& instance = capture->instances[i];
+            context.ModuleRegister(instance.codec_type);
+            if (context.InstanceCreate(instance.codec_type, instance.flags, &instance_ids[i]) !=
+                ORBIS_OK) {
+                LOG_ERROR(Lib_Ajm, "Unable to create instance {} of AJM capture", i);
+                return false;
+            }
+        }
+
+        u64 num_samples{};
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < capture->batches.size(); i++) {
+            auto& slot = slots[i % slots.size()];
+            num_samples += RetireSlot(context, slot);
+            auto batch = BuildBatch(*capture, capture->batches[i], instance_ids, slot);
+            if (context.BatchSubmit(std::move(batch), &slot.batch_id) != ORBIS_OK) {
+                LOG_ERROR(Lib_Ajm, "Unable to submit batch {} of AJM capture", i);
+                return false;
+            }
+            slot.in_use = true;
+        }
+        for (auto& slot : slots) {
+            num_samples += RetireSlot(context, slot);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        const double elapsed_ms = std::chrono::duration<double, std::milli>(elapsed).count();
+        fmt::print("{:>3} workers: {} batches, {} samples in {:.3f} ms ({:.3f} Msamples/s)\n",
+                   num_workers, capture->batches.size(), num_samples, elapsed_ms,
+                   elapsed_ms > 0.0 ? num_samples / elapsed_ms / 1000.0 : 0.0);
+        if (num_workers == max_workers) {
+            break;
+        }
+    }
+    return true;
+}
+
+} // namespace Libraries::Ajm
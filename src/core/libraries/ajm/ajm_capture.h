@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+
+#include "common/types.h"
+#include "core/libraries/ajm/ajm.h"
+
+namespace Libraries::Ajm {
+
+struct AjmBatch;
+
+/// Starts recording every instance and batch of every AJM context into the given file.
+void StartAjmCapture(const std::filesystem::path& path);
+
+/// Returns true while instances and batches are being recorded.
+bool IsAjmCapturing();
+
+/// Records the creation of an instance in the context with the given capture id.
+void CaptureAjmInstance(u32 context, u32 instance_id, AjmCodecType codec_type,
+                        AjmInstanceFlags flags);
+
+/// Records the jobs of a batch along with their input data and the sizes of their outputs.
+void CaptureAjmBatch(u32 context, const AjmBatch& batch);
+
+/**
+ * Decodes a capture on contexts with an increasing number of workers, from one up to the number
+ * of cores, and prints the decoded samples per second of each to stdout.
+ */
+bool ReplayAjmCapture(const std::filesystem::path& path);
+
+} // namespace Libraries::Ajm
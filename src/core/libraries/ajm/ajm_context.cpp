@@ -6,6 +6,7 @@
 #include "common/thread.h"
 #include "core/libraries/ajm/ajm.h"
 #include "core/libraries/ajm/ajm_at9.h"
+#include "core/libraries/ajm/ajm_capture.h"
 #include "core/libraries/ajm/ajm_context.h"
 #include "core/libraries/ajm/ajm_error.h"
 #include "core/libraries/ajm/ajm_instance.h"
@@ -13,6 +14,8 @@
 #include "core/libraries/ajm/ajm_mp3.h"
 #include "core/libraries/error_codes.h"
 
+#include <algorithm>
+#include <atomic>
 #include <span>
 #include <utility>
 
@@ -20,10 +23,20 @@ namespace Libraries::Ajm {
 
 static constexpr u32 ORBIS_AJM_WAIT_INFINITE = -1;
 
-AjmContext::AjmContext() {
-    worker_thread = std::jthread([this](std::stop_token stop) { this->WorkerThread(stop); });
+static std::atomic<u32> next_capture_id{};
+
+AjmContext::AjmContext(u32 num_workers) : capture_id{next_capture_id++} {
+    if (num_workers == 0) {
+        num_workers = std::clamp(std::thread::hardware_concurrency() / 2, 1U, MaxWorkers);
+    }
+    worker_threads.reserve(num_workers);
+    for (u32 i = 0; i < num_workers; i++) {
+        worker_threads.emplace_back([this](std::stop_token stop) { this->WorkerThread(stop); });
+    }
 }
 
+AjmContext::~AjmContext() = default;
+
 bool AjmContext::IsRegistered(AjmCodecType type) const {
     return registered_codecs[std::to_underlying(type)];
 }
@@ -62,36 +75,52 @@ s32 AjmContext::ModuleRegister(AjmCodecType type) {
 void AjmContext::WorkerThread(std::stop_token stop) {
     Common::SetCurrentThreadName("shadPS4:AjmWorker");
     while (!stop.stop_requested()) {
-        auto batch = batch_queue.PopWait(stop);
-        if (batch != nullptr && !batch->canceled) {
-            bool expected = false;
-            batch->processed.compare_exchange_strong(expected, true);
-            ProcessBatch(batch->id, batch->jobs);
-            batch->finished.release();
+        u32 instance_id{};
+        JobRun run;
+        {
+            std::unique_lock lock{queue_mutex};
+            if (!queue_cv.wait(lock, stop, [this] { return !ready_instances.empty(); })) {
+                return;
+            }
+            instance_id = ready_instances.front();
+            ready_instances.pop_front();
+            auto& runs = instance_queues[instance_id];
+            run = std::move(runs.front());
+            runs.pop_front();
         }
-    }
-}
 
-void AjmContext::ProcessBatch(u32 id, std::span<AjmJob> jobs) {
-    // Perform operation requested by control flags.
-    for (auto& job : jobs) {
-        LOG_TRACE(Lib_Ajm, "Processing job {} for instance {}. flags = {:#x}", id, job.instance_id,
-                  job.flags.raw);
+        ExecuteRun(run);
 
-        if (job.instance_id == AJM_INSTANCE_STATISTICS) {
-            AjmInstanceStatistics::Getinstance().ExecuteJob(job);
+        std::scoped_lock lock{queue_mutex};
+        const auto it = instance_queues.find(instance_id);
+        if (it->second.empty()) {
+            instance_queues.erase(it);
         } else {
-            std::shared_ptr<AjmInstance> instance;
-            {
-                std::shared_lock lock(instances_mutex);
-                auto* p_instance = instances.Get(job.instance_id);
-                ASSERT_MSG(p_instance != nullptr, "Attempting to execute job on null instance");
-                instance = *p_instance;
-            }
+            // Requeue at the back so a busy instance does not starve the others.
+            ready_instances.push_back(instance_id);
+            queue_cv.notify_one();
+        }
+    }
+}
 
-            instance->ExecuteJob(job);
+void AjmContext::ExecuteRun(const JobRun& run) {
+    auto& batch = *run.batch;
+    if (!batch.canceled) {
+        batch.processed = true;
+        const auto jobs = std::span{batch.jobs.data() + run.first_job, run.num_jobs};
+        for (auto& job : jobs) {
+            LOG_TRACE(Lib_Ajm, "Processing job {} for instance {}. flags = {:#x}", batch.id,
+                      job.instance_id, job.flags.raw);
+            if (run.instance) {
+                run.instance->ExecuteJob(job);
+            } else {
+                AjmInstanceStatistics::Getinstance().ExecuteJob(job);
+            }
         }
     }
+    if (--batch.pending_runs == 0) {
+        batch.finished.release();
+    }
 }
 
 s32 AjmContext::BatchWait(const u32 batch_id, const u32 timeout, AjmBatchError* const batch_error) {
@@ -137,24 +166,63 @@ int AjmContext::BatchStartBuffer(u8* p_batch, u32 batch_size, const int priority
     }
 
     const auto batch_info = AjmBatch::FromBatchBuffer({p_batch, batch_size});
+    if (IsAjmCapturing()) {
+        CaptureAjmBatch(capture_id, *batch_info);
+    }
+    return BatchSubmit(batch_info, out_batch_id);
+}
+
+s32 AjmContext::BatchSubmit(std::shared_ptr<AjmBatch> batch, u32* out_batch_id) {
     std::optional<u32> batch_id;
     {
         std::unique_lock guard(batches_mutex);
-        batch_id = batches.Create(batch_info);
+        batch_id = batches.Create(batch);
     }
     if (!batch_id.has_value()) {
         return ORBIS_AJM_ERROR_OUT_OF_MEMORY;
     }
     *out_batch_id = batch_id.value();
-    batch_info->id = *out_batch_id;
+    batch->id = *out_batch_id;
 
-    if (!batch_info->jobs.empty()) {
-        batch_queue.EmplaceWait(batch_info);
-    } else {
+    if (batch->jobs.empty()) {
         // Empty batches are not submitted to the processor and are marked as finished
-        batch_info->finished.release();
+        batch->finished.release();
+        return ORBIS_OK;
     }
 
+    // Split the batch into runs of jobs for the same instance.
+    boost::container::small_vector<JobRun, 16> runs;
+    {
+        std::shared_lock lock(instances_mutex);
+        for (u32 i = 0; i < batch->jobs.size(); i++) {
+            const u32 instance_id = batch->jobs[i].instance_id;
+            if (i != 0 && batch->jobs[i - 1].instance_id == instance_id) {
+                runs.back().num_jobs++;
+                continue;
+            }
+            std::shared_ptr<AjmInstance> instance;
+            if (instance_id != AJM_INSTANCE_STATISTICS) {
+                auto* p_instance = instances.Get(instance_id);
+                ASSERT_MSG(p_instance != nullptr, "Attempting to execute job on null instance");
+                instance = *p_instance;
+            }
+            runs.push_back({batch, std::move(instance), i, 1});
+        }
+    }
+    batch->pending_runs = static_cast<u32>(runs.size());
+
+    {
+        std::scoped_lock lock{queue_mutex};
+        for (auto& run : runs) {
+            const u32 instance_id = batch->jobs[run.first_job].instance_id;
+            const auto [it, is_idle] = instance_queues.try_emplace(instance_id);
+            it->second.push_back(std::move(run));
+            if (is_idle) {
+                ready_instances.push_back(instance_id);
+            }
+        }
+    }
+    queue_cv.notify_all();
     return ORBIS_OK;
 }
 
@@ -177,6 +245,9 @@ s32 AjmContext::InstanceCreate(AjmCodecType codec_type, AjmInstanceFlags flags,
         return ORBIS_AJM_ERROR_OUT_OF_RESOURCES;
     }
     *out_instance = opt_index.value();
+    if (IsAjmCapturing()) {
+        CaptureAjmInstance(capture_id, *out_instance, codec_type, flags);
+    }
 
     LOG_INFO(Lib_Ajm, "instance = {}", *out_instance);
     return ORBIS_OK;
@@ -3,7 +3,6 @@
 
 #pragma once
 
-#include "common/bounded_threadsafe_queue.h"
 #include "common/slot_array.h"
 #include "common/types.h"
 #include "core/libraries/ajm/ajm.h"
@@ -11,17 +10,28 @@
 #include "core/libraries/ajm/ajm_instance.h"
 
 #include <array>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <shared_mutex>
-#include <span>
 #include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace Libraries::Ajm {
 
+/**
+ * Decodes submitted batches on a pool of worker threads. Jobs are queued per instance, so
+ * different instances decode in parallel while the jobs of each instance keep the order they
+ * were submitted in.
+ */
 class AjmContext {
 public:
-    AjmContext();
+    /// Creates a context with the given number of workers, or one based on the core count if 0.
+    explicit AjmContext(u32 num_workers = 0);
+    ~AjmContext();
 
     s32 InstanceCreate(AjmCodecType codec_type, AjmInstanceFlags flags, u32* out_instance_id);
     s32 InstanceDestroy(u32 instance_id);
@@ -31,17 +41,28 @@ public:
     s32 BatchWait(const u32 batch_id, const u32 timeout, AjmBatchError* const p_batch_error);
     s32 BatchStartBuffer(u8* p_batch, u32 batch_size, const int priority,
                          AjmBatchError* p_batch_error, u32* p_batch_id);
+    s32 BatchSubmit(std::shared_ptr<AjmBatch> batch, u32* p_batch_id);
 
     void WorkerThread(std::stop_token stop);
-    void ProcessBatch(u32 id, std::span<AjmJob> jobs);
 
 private:
     static constexpr u32 MaxInstances = 0x2fff;
     static constexpr u32 MaxBatches = 0x0400;
+    static constexpr u32 MaxWorkers = 8;
     static constexpr u32 NumAjmCodecs = std::to_underlying(AjmCodecType::Max);
 
+    /// Consecutive jobs of a batch that target the same instance.
+    struct JobRun {
+        std::shared_ptr<AjmBatch> batch;
+        std::shared_ptr<AjmInstance> instance; ///< Null for the statistics instance
+        u32 first_job;
+        u32 num_jobs;
+    };
+
     [[nodiscard]] bool IsRegistered(AjmCodecType type) const;
 
+    void ExecuteRun(const JobRun& run);
+
     std::array<bool, NumAjmCodecs> registered_codecs{};
 
     std::shared_mutex instances_mutex;
@@ -50,8 +71,15 @@ private:
     std::shared_mutex batches_mutex;
     Common::SlotArray<u32, std::shared_ptr<AjmBatch>, MaxBatches, 1> batches;
 
-    std::jthread worker_thread{};
-    Common::MPSCQueue<std::shared_ptr<AjmBatch>> batch_queue;
+    u32 capture_id{};
+
+    /// Instances with queued jobs, each present while a worker is on it or it waits for one.
+    std::mutex queue_mutex;
+    std::condition_variable_any queue_cv;
+    std::unordered_map<u32, std::deque<JobRun>> instance_queues;
+    std::deque<u32> ready_instances;
+
+    std::vector<std::jthread> worker_threads;
 };
 
 } // namespace Libraries::Ajm
@@ -41,6 +41,19 @@ public:
         return samples_written;
     }
 
+    /// Returns the contiguous space left in the chunk that is written next.
+    std::span<u8> GetCurrentChunk() const {
+        return IsEmpty() ? std::span<u8>{} : *m_current;
+    }
+
+    /// Marks bytes of the current chunk as written after filling them in place.
+    void Advance(size_t size) {
+        *m_current = m_current->subspan(size);
+        if (m_current->empty()) {
+            ++m_current;
+        }
+    }
+
     bool IsEmpty() const {
         return m_current == m_chunks.end();
     }
@@ -75,45 +75,99 @@ static AVSampleFormat AjmToAVSampleFormat(AjmFormatEncoding format) {
     }
 }
 
-AVFrame* AjmMp3Decoder::ConvertAudioFrame(AVFrame* frame) {
-    AVSampleFormat format = AjmToAVSampleFormat(m_format);
-    if (frame->format == format) {
-        return frame;
+bool AjmMp3Decoder::UpdateResampler(const AVFrame* frame) {
+    if (m_swr_context && frame->format == m_swr_in_format &&
+        frame->sample_rate == m_swr_sample_rate &&
+        av_channel_layout_compare(&frame->ch_layout, &m_swr_ch_layout) == 0) {
+        return true;
     }
 
-    AVFrame* new_frame = av_frame_alloc();
-    new_frame->pts = frame->pts;
-    new_frame->pkt_dts = frame->pkt_dts < 0 ? 0 : frame->pkt_dts;
-    new_frame->format = format;
-    new_frame->ch_layout = frame->ch_layout;
-    new_frame->sample_rate = frame->sample_rate;
-
-    AVChannelLayout in_ch_layout = frame->ch_layout;
-    AVChannelLayout out_ch_layout = new_frame->ch_layout;
-    swr_alloc_set_opts2(&m_swr_context, &out_ch_layout, AVSampleFormat(new_frame->format),
-                        frame->sample_rate, &in_ch_layout, AVSampleFormat(frame->format),
-                        frame->sample_rate, 0, nullptr);
-    swr_init(m_swr_context);
-    const auto res = swr_convert_frame(m_swr_context, new_frame, frame);
-    if (res < 0) {
-        LOG_ERROR(Lib_AvPlayer, "Could not convert frame: {}", av_err2str(res));
-        av_frame_free(&new_frame);
-        av_frame_free(&frame);
-        return nullptr;
+    swr_free(&m_swr_context);
+    av_channel_layout_uninit(&m_swr_ch_layout);
+    auto ret = swr_alloc_set_opts2(&m_swr_context, &frame->ch_layout, AjmToAVSampleFormat(m_format),
+                                   frame->sample_rate, &frame->ch_layout,
+                                   AVSampleFormat(frame->format), frame->sample_rate, 0, nullptr);
+    if (ret >= 0) {
+        ret = swr_init(m_swr_context);
+    }
+    if (ret < 0) {
+        LOG_ERROR(Lib_Ajm, "Could not create resampler: {}", av_err2str(ret));
+        swr_free(&m_swr_context);
+        return false;
+    }
+    av_channel_layout_copy(&m_swr_ch_layout, &frame->ch_layout);
+    m_swr_in_format = frame->format;
+    m_swr_sample_rate = frame->sample_rate;
+    return true;
+}
+
+u32 AjmMp3Decoder::WriteFrame(const AVFrame* frame, SparseOutputBuffer& output,
+                              u32 skipped_samples, u32 max_pcm) {
+    const u32 num_channels = frame->ch_layout.nb_channels;
+    const u8* pcm_data = frame->data[0];
+    if (frame->format != AjmToAVSampleFormat(m_format)) {
+        if (!UpdateResampler(frame)) {
+            return 0;
+        }
+        const auto** in_data = const_cast<const u8**>(frame->extended_data);
+        const u32 num_pcm = frame->nb_samples * num_channels;
+        const size_t frame_size = num_pcm * GetPCMSize(m_format);
+
+        // Convert straight into guest memory when the whole frame fits the current chunk.
+        const auto chunk = output.GetCurrentChunk();
+        if (skipped_samples == 0 && num_pcm <= max_pcm && chunk.size() >= frame_size) {
+            u8* out_data = chunk.data();
+            const auto ret = swr_convert(m_swr_context, &out_data, frame->nb_samples,
+                                         in_data, frame->nb_samples);
+            if (ret < 0) {
+                LOG_ERROR(Lib_Ajm, "Could not convert frame: {}", av_err2str(ret));
+                return 0;
+            }
+            output.Advance(ret * num_channels * GetPCMSize(m_format));
+            return ret * num_channels;
+        }
+
+        if (m_pcm_buffer.size() < frame_size) {
+            m_pcm_buffer.resize(frame_size);
+        }
+        u8* out_data = m_pcm_buffer.data();
+        const auto ret =
+            swr_convert(m_swr_context, &out_data, frame->nb_samples, in_data, frame->nb_samples);
+        if (ret < 0) {
+            LOG_ERROR(Lib_Ajm, "Could not convert frame: {}", av_err2str(ret));
+            return 0;
+        }
+        pcm_data = m_pcm_buffer.data();
+    }
+
+    switch (m_format) {
+    case AjmFormatEncoding::S16:
+        return WriteOutputPCM<s16>(pcm_data, frame->nb_samples, num_channels, output,
+                                   skipped_samples, max_pcm);
+    case AjmFormatEncoding::S32:
+        return WriteOutputPCM<s32>(pcm_data, frame->nb_samples, num_channels, output,
+                                   skipped_samples, max_pcm);
+    case AjmFormatEncoding::Float:
+        return WriteOutputPCM<float>(pcm_data, frame->nb_samples, num_channels, output,
+                                     skipped_samples, max_pcm);
+    default:
+        UNREACHABLE();
     }
-    av_frame_free(&frame);
-    return new_frame;
 }
 
 AjmMp3Decoder::AjmMp3Decoder(AjmFormatEncoding format, AjmMp3CodecFlags flags)
     : m_format(format), m_flags(flags), m_codec(avcodec_find_decoder(AV_CODEC_ID_MP3)),
-      m_codec_context(avcodec_alloc_context3(m_codec)), m_parser(av_parser_init(m_codec->id)) {
+      m_codec_context(avcodec_alloc_context3(m_codec)), m_parser(av_parser_init(m_codec->id)),
+      m_packet(av_packet_alloc()), m_frame(av_frame_alloc()) {
     int ret = avcodec_open2(m_codec_context, m_codec, nullptr);
     ASSERT_MSG(ret >= 0, "Could not open m_codec");
 }
 
 AjmMp3Decoder::~AjmMp3Decoder() {
     swr_free(&m_swr_context);
+    av_channel_layout_uninit(&m_swr_ch_layout);
+    av_frame_free(&m_frame);
+    av_packet_free(&m_packet);
     av_parser_close(m_parser);
     avcodec_free_context(&m_codec_context);
 }
@@ -147,7 +201,7 @@ u32 AjmMp3Decoder::GetMinimumInputSize() const {
 DecoderResult AjmMp3Decoder::ProcessData(std::span<u8>& in_buf, SparseOutputBuffer& output,
                                          AjmInstanceGapless& gapless) {
     DecoderResult result{};
-    AVPacket* pkt = av_packet_alloc();
+    AVPacket* pkt = m_packet;
 
     if ((!m_header.has_value() || m_frame_samples == 0) && in_buf.size() >= 4) {
         m_header = std::byteswap(*reinterpret_cast<u32*>(in_buf.data()));
@@ -178,15 +232,13 @@ DecoderResult AjmMp3Decoder::ProcessData(std::span<u8>& in_buf, SparseOutputBuff
 
         // Read all the output frames (in general there may be any number of them
         while (ret >= 0) {
-            AVFrame* frame = av_frame_alloc();
+            AVFrame* frame = m_frame;
             ret = avcodec_receive_frame(m_codec_context, frame);
             if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                av_frame_free(&frame);
                 break;
             } else if (ret < 0) {
                 UNREACHABLE_MSG("Error during decoding");
             }
-            frame = ConvertAudioFrame(frame);
 
             result.frames_decoded += 1;
             u32 skip_samples = 0;
@@ -200,20 +252,7 @@ DecoderResult AjmMp3Decoder::ProcessData(std::span<u8>& in_buf, SparseOutputBuff
                     ? gapless.current.total_samples * m_codec_context->ch_layout.nb_channels
                     : std::numeric_limits<u32>::max();
 
-            u32 pcm_written = 0;
-            switch (m_format) {
-            case AjmFormatEncoding::S16:
-                pcm_written = WriteOutputPCM<s16>(frame, output, skip_samples, max_pcm);
-                break;
-            case AjmFormatEncoding::S32:
-                pcm_written = WriteOutputPCM<s32>(frame, output, skip_samples, max_pcm);
-                break;
-            case AjmFormatEncoding::Float:
-                pcm_written = WriteOutputPCM<float>(frame, output, skip_samples, max_pcm);
-                break;
-            default:
-                UNREACHABLE();
-            }
+            const u32 pcm_written = WriteFrame(frame, output, skip_samples, max_pcm);
 
             const auto samples = pcm_written / m_codec_context->ch_layout.nb_channels;
             gapless.current.skipped_samples += frame->nb_samples - samples;
@@ -222,12 +261,11 @@ DecoderResult AjmMp3Decoder::ProcessData(std::span<u8>& in_buf, SparseOutputBuff
             }
             result.samples_written += samples;
 
-            av_frame_free(&frame);
+            // Hands the frame buffers back to the decoder's pool for the next frame.
+            av_frame_unref(frame);
         }
     }
 
-    av_packet_free(&pkt);
-
     return result;
 }
 
@@ -6,6 +6,8 @@
 #include "common/types.h"
 #include "core/libraries/ajm/ajm_instance.h"
 
+#include <vector>
+
 extern "C" {
 #include <libavcodec/avcodec.h>
 struct SwrContext;
@@ -80,22 +82,30 @@ public:
 
 private:
     template <class T>
-    size_t WriteOutputPCM(AVFrame* frame, SparseOutputBuffer& output, u32 skipped_samples,
-                          u32 max_pcm) {
-        std::span<T> pcm_data(reinterpret_cast<T*>(frame->data[0]),
-                              frame->nb_samples * frame->ch_layout.nb_channels);
-        pcm_data = pcm_data.subspan(skipped_samples * frame->ch_layout.nb_channels);
+    size_t WriteOutputPCM(const u8* data, u32 num_samples, u32 num_channels,
+                          SparseOutputBuffer& output, u32 skipped_samples, u32 max_pcm) {
+        std::span<const T> pcm_data(reinterpret_cast<const T*>(data), num_samples * num_channels);
+        pcm_data = pcm_data.subspan(skipped_samples * num_channels);
         return output.Write(pcm_data.subspan(0, std::min(u32(pcm_data.size()), max_pcm)));
     }
 
-    AVFrame* ConvertAudioFrame(AVFrame* frame);
+    bool UpdateResampler(const AVFrame* frame);
+    u32 WriteFrame(const AVFrame* frame, SparseOutputBuffer& output, u32 skipped_samples,
+                   u32 max_pcm);
 
     const AjmFormatEncoding m_format;
     const AjmMp3CodecFlags m_flags;
     const AVCodec* m_codec = nullptr;
     AVCodecContext* m_codec_context = nullptr;
     AVCodecParserContext* m_parser = nullptr;
+    AVPacket* m_packet = nullptr;
+    AVFrame* m_frame = nullptr;
+    // The resampler is kept for as long as the decoded frames keep the format it was set up for.
     SwrContext* m_swr_context = nullptr;
+    AVChannelLayout m_swr_ch_layout{};
+    int m_swr_in_format = AV_SAMPLE_FMT_NONE;
+    int m_swr_sample_rate = 0;
+    std::vector<u8> m_pcm_buffer;
     std::optional<u32> m_header;
     u32 m_frame_samples = 0;
     u32 m_frame_size = 0;
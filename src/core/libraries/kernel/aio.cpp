@@ -1,12 +1,25 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <thread>
+#include <vector>
 
 #include "aio.h"
 #include "common/assert.h"
+#include "common/config.h"
 #include "common/debug.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/libraries/kernel/equeue.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/libs.h"
@@ -14,10 +27,300 @@
 
 namespace Libraries::Kernel {
 
-#define MAX_QUEUE 512
+namespace {
+
+constexpr u32 MaxRequests = 0x1000;
+constexpr u32 RequestIdBits = 12;
+constexpr u32 NumPriorities = 3;
+constexpr u32 MaxWorkers = 16;
+static_assert(MaxRequests == 1U << RequestIdBits);
+
+struct AioRequest {
+    std::atomic<OrbisKernelAioSubmitId> id{}; ///< Submit id the slot belongs to, 0 when free
+    std::atomic<s32> state{};
+    std::atomic<u32> num_pending{};
+    std::atomic<bool> busy{}; ///< Cleared once the final state is published
+    std::atomic<bool> canceled{};
+    std::atomic<bool> failed{};
+    bool is_write{};
+    std::vector<OrbisKernelAioRWRequest> commands;
+};
+
+struct AioCommand {
+    u32 slot;
+    u32 index;
+};
+
+bool IsFinished(s32 state) {
+    return state == ORBIS_KERNEL_AIO_STATE_COMPLETED || state == ORBIS_KERNEL_AIO_STATE_ABORTED;
+}
+
+/**
+ * Runs submitted commands on a pool of I/O threads. Commands wait in one queue per priority and
+ * the highest priority is always served first. Request state is only changed with atomic
+ * stores, so polling never blocks and waiting only sleeps until a request completes.
+ */
+class AioEngine {
+public:
+    s32 Submit(std::span<const OrbisKernelAioRWRequest> commands, bool is_write, s32 prio,
+               OrbisKernelAioSubmitId* out_id) {
+        std::call_once(workers_started, [this] { StartWorkers(); });
+
+        std::unique_lock lock{queue_mutex};
+        const auto slot = AllocateSlot();
+        if (!slot) {
+            LOG_ERROR(Kernel, "Too many AIO requests in flight");
+            return ORBIS_KERNEL_ERROR_EAGAIN;
+        }
+        auto& request = requests[*slot];
+        const auto id = static_cast<OrbisKernelAioSubmitId>(
+            ((next_generation++ & 0x7FFFF) << RequestIdBits) | *slot);
+        request.commands.assign(commands.begin(), commands.end());
+        request.is_write = is_write;
+        request.canceled = false;
+        request.failed = false;
+        request.state = commands.empty() ? ORBIS_KERNEL_AIO_STATE_COMPLETED
+                                         : ORBIS_KERNEL_AIO_STATE_SUBMITTED;
+        request.num_pending = static_cast<u32>(commands.size());
+        request.busy = !commands.empty();
+        request.id = id;
+        *out_id = id;
+
+        auto& queue = queues[PriorityIndex(prio)];
+        for (u32 i = 0; i < commands.size(); i++) {
+            queue.push_back({*slot, i});
+        }
+        lock.unlock();
+        if (commands.size() > 1) {
+            queue_cv.notify_all();
+        } else {
+            queue_cv.notify_one();
+        }
+        return ORBIS_OK;
+    }
+
+    s32 Poll(OrbisKernelAioSubmitId id, s32* state) {
+        const auto* request = Find(id);
+        if (!request) {
+            return ORBIS_KERNEL_ERROR_ESRCH;
+        }
+        *state = request->state;
+        return ORBIS_OK;
+    }
 
-static s32* id_state;
-static s32 id_index;
+    s32 Cancel(OrbisKernelAioSubmitId id, s32* state) {
+        auto* request = Find(id);
+        if (!request) {
+            return ORBIS_KERNEL_ERROR_ESRCH;
+        }
+        // Only commands still in the queues are aborted here. Commands a worker already took
+        // are left to finish, and the worker publishes the final state once they are done, so
+        // the guest never sees the request aborted while its buffers are still in use.
+        std::unique_lock lock{queue_mutex};
+        if (request->id != id) {
+            return ORBIS_KERNEL_ERROR_ESRCH;
+        }
+        request->canceled = true;
+        const u32 slot = static_cast<u32>(id) & (MaxRequests - 1);
+        u32 num_removed = 0;
+        for (auto& queue : queues) {
+            num_removed += static_cast<u32>(std::erase_if(queue, [&](const AioCommand& command) {
+                if (command.slot != slot) {
+                    return false;
+                }
+                SetResult(request->commands[command.index], ORBIS_KERNEL_ERROR_ECANCELED);
+                return true;
+            }));
+        }
+        lock.unlock();
+        if (num_removed != 0 && request->num_pending.fetch_sub(num_removed) == num_removed) {
+            Finish(*request);
+        }
+        *state = request->state;
+        return ORBIS_OK;
+    }
+
+    s32 Delete(OrbisKernelAioSubmitId id) {
+        auto* request = Find(id);
+        if (!request) {
+            return ORBIS_KERNEL_ERROR_ESRCH;
+        }
+        request->canceled = true;
+        if (!request->busy) {
+            // Frees the slot, a pending request leaves it to be reused once it completes.
+            OrbisKernelAioSubmitId expected = id;
+            request->id.compare_exchange_strong(expected, 0);
+        }
+        return ORBIS_OK;
+    }
+
+    s32 Wait(std::span<const OrbisKernelAioSubmitId> ids, std::span<s32> states, bool wait_all,
+             const u32* usec) {
+        for (const auto id : ids) {
+            if (!Find(id)) {
+                return ORBIS_KERNEL_ERROR_ESRCH;
+            }
+        }
+        const auto is_done = [&] {
+            const auto is_request_done = [this](OrbisKernelAioSubmitId id) {
+                const auto* request = Find(id);
+                return !request || IsFinished(request->state);
+            };
+            return wait_all ? std::ranges::all_of(ids, is_request_done)
+                            : std::ranges::any_of(ids, is_request_done);
+        };
+
+        bool timed_out = false;
+        if (!is_done()) {
+            ++num_waiters;
+            std::unique_lock lock{wait_mutex};
+            if (usec && *usec != 0) {
+                timed_out =
+                    !completion_cv.wait_for(lock, std::chrono::microseconds{*usec}, is_done);
+            } else {
+                completion_cv.wait(lock, is_done);
+            }
+            --num_waiters;
+        }
+
+        for (size_t i = 0; i < ids.size(); i++) {
+            const auto* request = Find(ids[i]);
+            states[i] = request ? request->state.load() : ORBIS_KERNEL_AIO_STATE_ABORTED;
+        }
+        return timed_out ? ORBIS_KERNEL_ERROR_ETIMEDOUT : ORBIS_OK;
+    }
+
+private:
+    static u32 PriorityIndex(s32 prio) {
+        switch (prio) {
+        case ORBIS_KERNEL_AIO_PRIORITY_HIGH:
+            return 0;
+        case ORBIS_KERNEL_AIO_PRIORITY_LOW:
+            return 2;
+        default:
+            return 1;
+        }
+    }
+
+    AioRequest* Find(OrbisKernelAioSubmitId id) {
+        const u32 slot = static_cast<u32>(id) & (MaxRequests - 1);
+        if (id <= 0 || slot == 0 || requests[slot].id != id) {
+            return nullptr;
+        }
+        return &requests[slot];
+    }
+
+    /// Slots are handed out in ring order, so the least recently submitted requests are reused
+    /// first when the guest never deletes them. Slot 0 is skipped so that no id is 0.
+    std::optional<u32> AllocateSlot() {
+        for (u32 i = 0; i < MaxRequests - 1; i++) {
+            const u32 slot = next_slot;
+            next_slot = next_slot == MaxRequests - 1 ? 1 : next_slot + 1;
+            if (!requests[slot].busy) {
+                return slot;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void StartWorkers() {
+        const int config_workers = Config::getAioWorkerCount();
+        const u32 num_workers =
+            config_workers > 0
+                ? std::min<u32>(config_workers, MaxWorkers)
+                : std::clamp(std::thread::hardware_concurrency() / 2, 2U, MaxWorkers / 2);
+        LOG_INFO(Kernel, "Starting {} AIO workers", num_workers);
+        workers.reserve(num_workers);
+        for (u32 i = 0; i < num_workers; i++) {
+            workers.emplace_back([this](std::stop_token stop) { WorkerThread(stop); });
+        }
+    }
+
+    void WorkerThread(std::stop_token stop) {
+        Common::SetCurrentThreadName("shadPS4:AioWorker");
+        while (!stop.stop_requested()) {
+            AioCommand command;
+            {
+                std::unique_lock lock{queue_mutex};
+                const auto is_not_empty = [](const auto& queue) { return !queue.empty(); };
+                if (!queue_cv.wait(lock, stop,
+                                   [&] { return std::ranges::any_of(queues, is_not_empty); })) {
+                    return;
+                }
+                // Queues are ordered from the highest priority down.
+                auto& queue = *std::ranges::find_if(queues, is_not_empty);
+                command = queue.front();
+                queue.pop_front();
+            }
+            Execute(command);
+        }
+    }
+
+    void Execute(const AioCommand& command) {
+        auto& request = requests[command.slot];
+        const auto& rw = request.commands[command.index];
+
+        s64 ret = ORBIS_KERNEL_ERROR_ECANCELED;
+        if (!request.canceled) {
+            s32 expected = ORBIS_KERNEL_AIO_STATE_SUBMITTED;
+            request.state.compare_exchange_strong(expected, ORBIS_KERNEL_AIO_STATE_PROCESSING);
+            ret = request.is_write ? sceKernelPwrite(rw.fd, rw.buf, rw.nbyte, rw.offset)
+                                   : sceKernelPread(rw.fd, rw.buf, rw.nbyte, rw.offset);
+        }
+        SetResult(rw, ret);
+        if (ret < 0) {
+            request.failed = true;
+        }
+        if (--request.num_pending == 0) {
+            Finish(request);
+        }
+    }
+
+    static void SetResult(const OrbisKernelAioRWRequest& rw, s64 ret) {
+        rw.result->returnValue = ret;
+        std::atomic_ref{rw.result->state}.store(
+            ret < 0 ? ORBIS_KERNEL_AIO_STATE_ABORTED : ORBIS_KERNEL_AIO_STATE_COMPLETED,
+            std::memory_order_release);
+    }
+
+    /// Publishes the final state once no command of the request is queued or running.
+    void Finish(AioRequest& request) {
+        const bool aborted = request.canceled || request.failed;
+        request.state =
+            aborted ? ORBIS_KERNEL_AIO_STATE_ABORTED : ORBIS_KERNEL_AIO_STATE_COMPLETED;
+        request.busy = false;
+        NotifyWaiters();
+    }
+
+    /// Waiters register before checking the state, so completions only take the wait lock
+    /// while someone is waiting.
+    void NotifyWaiters() {
+        if (num_waiters == 0) {
+            return;
+        }
+        std::scoped_lock lock{wait_mutex};
+        completion_cv.notify_all();
+    }
+
+    std::array<AioRequest, MaxRequests> requests;
+
+    std::mutex queue_mutex;
+    std::condition_variable_any queue_cv;
+    std::array<std::deque<AioCommand>, NumPriorities> queues;
+    u32 next_slot = 1;
+    u32 next_generation = 1;
+
+    std::mutex wait_mutex;
+    std::condition_variable completion_cv;
+    std::atomic<u32> num_waiters{};
+
+    std::once_flag workers_started;
+    std::vector<std::jthread> workers;
+};
+
+std::unique_ptr<AioEngine> aio_engine;
+
+} // Anonymous namespace
 
 s32 PS4_SYSV_ABI sceKernelAioInitializeImpl(void* p, s32 size) {
 
@@ -28,8 +331,7 @@ s32 PS4_SYSV_ABI sceKernelAioDeleteRequest(OrbisKernelAioSubmitId id, s32* ret)
     if (ret == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    id_state[id] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-    *ret = 0;
+    *ret = aio_engine->Delete(id);
     return 0;
 }
 
@@ -38,8 +340,7 @@ s32 PS4_SYSV_ABI sceKernelAioDeleteRequests(OrbisKernelAioSubmitId id[], s32 num
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < num; i++) {
-        id_state[id[i]] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-        ret[i] = 0;
+        ret[i] = aio_engine->Delete(id[i]);
     }
 
     return 0;
@@ -48,8 +349,7 @@ s32 PS4_SYSV_ABI sceKernelAioPollRequest(OrbisKernelAioSubmitId id, s32* state)
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    *state = id_state[id];
-    return 0;
+    return aio_engine->Poll(id, state);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioPollRequests(OrbisKernelAioSubmitId id[], s32 num, s32 state[]) {
@@ -57,7 +357,9 @@ s32 PS4_SYSV_ABI sceKernelAioPollRequests(OrbisKernelAioSubmitId id[], s32 num,
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < num; i++) {
-        state[i] = id_state[id[i]];
+        if (const s32 result = aio_engine->Poll(id[i], &state[i]); result < 0) {
+            return result;
+        }
     }
 
     return 0;
@@ -67,13 +369,11 @@ s32 PS4_SYSV_ABI sceKernelAioCancelRequest(OrbisKernelAioSubmitId id, s32* state
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    if (id) {
-        id_state[id] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-        *state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-    } else {
+    if (id == 0) {
         *state = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+        return 0;
     }
-    return 0;
+    return aio_engine->Cancel(id, state);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioCancelRequests(OrbisKernelAioSubmitId id[], s32 num, s32 state[]) {
@@ -81,11 +381,10 @@ s32 PS4_SYSV_ABI sceKernelAioCancelRequests(OrbisKernelAioSubmitId id[], s32 num
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < num; i++) {
-        if (id[i]) {
-            id_state[id[i]] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            state[i] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-        } else {
+        if (id[i] == 0) {
             state[i] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
+        } else if (const s32 result = aio_engine->Cancel(id[i], &state[i]); result < 0) {
+            return result;
         }
     }
 
@@ -96,27 +395,7 @@ s32 PS4_SYSV_ABI sceKernelAioWaitRequest(OrbisKernelAioSubmitId id, s32* state,
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    u32 timer = 0;
-
-    s32 timeout = 0;
-
-    while (id_state[id] == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
-        sceKernelUsleep(10);
-
-        timer += 10;
-        if (*usec) {
-            if (timer > *usec) {
-                timeout = 1;
-                break;
-            }
-        }
-    }
-
-    *state = id_state[id];
-
-    if (timeout)
-        return ORBIS_KERNEL_ERROR_ETIMEDOUT;
-    return 0;
+    return aio_engine->Wait({&id, 1}, {state, 1}, true, usec);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioWaitRequests(OrbisKernelAioSubmitId id[], s32 num, s32 state[],
@@ -124,37 +403,11 @@ s32 PS4_SYSV_ABI sceKernelAioWaitRequests(OrbisKernelAioSubmitId id[], s32 num,
     if (state == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    u32 timer = 0;
-    s32 timeout = 0;
-    s32 completion = 0;
-
-    for (s32 i = 0; i < num; i++) {
-        if (!completion && !timeout) {
-            while (id_state[id[i]] == ORBIS_KERNEL_AIO_STATE_PROCESSING) {
-                sceKernelUsleep(10);
-                timer += 10;
-
-                if (*usec) {
-                    if (timer > *usec) {
-                        timeout = 1;
-                        break;
-                    }
-                }
-            }
-        }
-
-        if (mode == 0x02) {
-            if (id_state[id[i]] == ORBIS_KERNEL_AIO_STATE_COMPLETED)
-                completion = 1;
-        }
-
-        state[i] = id_state[id[i]];
+    if (num <= 0) {
+        return ORBIS_KERNEL_ERROR_EINVAL;
     }
-
-    if (timeout)
-        return ORBIS_KERNEL_ERROR_ETIMEDOUT;
-
-    return 0;
+    return aio_engine->Wait({id, static_cast<size_t>(num)}, {state, static_cast<size_t>(num)},
+                            mode != ORBIS_KERNEL_AIO_WAIT_OR, usec);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommands(OrbisKernelAioRWRequest req[], s32 size, s32 prio,
@@ -165,32 +418,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommands(OrbisKernelAioRWRequest req[], s
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-    for (s32 i = 0; i < size; i++) {
-
-        s64 ret = sceKernelPread(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-        }
-    }
-
-    id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-
-    *id = id_index;
-
-    id_index = (id_index + 1) % MAX_QUEUE;
-
-    if (!id_index)
-        id_index++;
-
-    return 0;
+    return aio_engine->Submit({req, static_cast<size_t>(std::max(size, 0))}, false, prio, id);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommandsMultiple(OrbisKernelAioRWRequest req[], s32 size,
@@ -202,29 +430,10 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitReadCommandsMultiple(OrbisKernelAioRWRequest
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-        s64 ret = sceKernelPread(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
+        if (const s32 result = aio_engine->Submit({&req[i], 1}, false, prio, &id[i]);
+            result < 0) {
+            return result;
         }
-
-        id[i] = id_index;
-
-        id_index = (id_index + 1) % MAX_QUEUE;
-
-        if (!id_index)
-            id_index++;
     }
 
     return 0;
@@ -238,35 +447,7 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommands(OrbisKernelAioRWRequest req[],
     if (id == nullptr) {
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
-    for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-
-        s64 ret = sceKernelPwrite(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-        }
-    }
-
-    *id = id_index;
-
-    id_index = (id_index + 1) % MAX_QUEUE;
-
-    // skip id_index equals 0 , because sceKernelAioCancelRequest will submit id
-    // equal to 0
-    if (!id_index)
-        id_index++;
-
-    return 0;
+    return aio_engine->Submit({req, static_cast<size_t>(std::max(size, 0))}, true, prio, id);
 }
 
 s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommandsMultiple(OrbisKernelAioRWRequest req[], s32 size,
@@ -278,26 +459,10 @@ s32 PS4_SYSV_ABI sceKernelAioSubmitWriteCommandsMultiple(OrbisKernelAioRWRequest
         return ORBIS_KERNEL_ERROR_EFAULT;
     }
     for (s32 i = 0; i < size; i++) {
-        id_state[id_index] = ORBIS_KERNEL_AIO_STATE_PROCESSING;
-        s64 ret = sceKernelPwrite(req[i].fd, req[i].buf, req[i].nbyte, req[i].offset);
-
-        if (ret < 0) {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_ABORTED;
-            req[i].result->returnValue = ret;
-
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_ABORTED;
-
-        } else {
-            req[i].result->state = ORBIS_KERNEL_AIO_STATE_COMPLETED;
-            req[i].result->returnValue = ret;
-            id_state[id_index] = ORBIS_KERNEL_AIO_STATE_COMPLETED;
+        if (const s32 result = aio_engine->Submit({&req[i], 1}, true, prio, &id[i]);
+            result < 0) {
+            return result;
         }
-
-        id[i] = id_index;
-        id_index = (id_index + 1) % MAX_QUEUE;
-
-        if (!id_index)
-            id_index++;
     }
     return 0;
 }
@@ -313,9 +478,7 @@ s32 PS4_SYSV_ABI sceKernelAioInitializeParam() {
 }
 
 void RegisterAio(Core::Loader::SymbolsResolver* sym) {
-    id_index = 1;
-    id_state = (int*)malloc(sizeof(int) * MAX_QUEUE);
-    memset(id_state, 0, sizeof(sizeof(int) * MAX_QUEUE));
+    aio_engine = std::make_unique<AioEngine>();
 
     LIB_FUNCTION("fR521KIGgb8", "libkernel", 1, "libkernel", sceKernelAioCancelRequest);
     LIB_FUNCTION("3Lca1XBrQdY", "libkernel", 1, "libkernel", sceKernelAioCancelRequests);
@@ -336,4 +499,4 @@ void RegisterAio(Core::Loader::SymbolsResolver* sym) {
     LIB_FUNCTION("lgK+oIWkJyA", "libkernel", 1, "libkernel", sceKernelAioWaitRequests);
 }
 
-} // namespace Libraries::Kernel
\ No newline at end of file
+} // namespace Libraries::Kernel
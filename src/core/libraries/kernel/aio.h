@@ -24,6 +24,17 @@ enum AioState {
     ORBIS_KERNEL_AIO_STATE_ABORTED = 4
 };
 
+enum AioPriority {
+    ORBIS_KERNEL_AIO_PRIORITY_LOW = 1,
+    ORBIS_KERNEL_AIO_PRIORITY_MID = 2,
+    ORBIS_KERNEL_AIO_PRIORITY_HIGH = 3
+};
+
+enum AioWaitMode {
+    ORBIS_KERNEL_AIO_WAIT_AND = 1,
+    ORBIS_KERNEL_AIO_WAIT_OR = 2
+};
+
 struct OrbisKernelAioResult {
     s64 returnValue;
     u32 state;
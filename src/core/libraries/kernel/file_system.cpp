@@ -3,6 +3,7 @@
 
 #include <map>
 #include <ranges>
+#include <boost/container/small_vector.hpp>
 #include <magic_enum/magic_enum.hpp>
 
 #include "common/assert.h"
@@ -111,7 +112,7 @@ s32 PS4_SYSV_ABI open(const char* raw_path, s32 flags, u16 mode) {
 
     std::string_view path{raw_path};
     u32 handle = h->CreateHandle();
-    auto* file = h->GetFile(handle);
+    auto file = h->GetFile(handle);
 
     if (path.starts_with("/dev/")) {
         for (const auto& [prefix, factory] : available_device) {
@@ -265,7 +266,7 @@ s32 PS4_SYSV_ABI sceKernelOpen(const char* path, s32 flags, /* SceKernelMode*/ u
 
 s32 PS4_SYSV_ABI close(s32 fd) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -274,14 +275,12 @@ s32 PS4_SYSV_ABI close(s32 fd) {
         *__Error() = POSIX_EPERM;
         return -1;
     }
-    if (file->type == Core::FileSys::FileType::Regular) {
-        file->f.Close();
-    } else if (file->type == Core::FileSys::FileType::Socket) {
+    if (file->type == Core::FileSys::FileType::Socket) {
         file->socket->Close();
     }
     file->is_opened = false;
     LOG_INFO(Kernel_Fs, "Closing {}", file->m_guest_name);
-    // FIXME: Lock file mutex before deleting it?
+    // Host files are closed once other threads still using this one are done with it.
     h->DeleteHandle(fd);
     return ORBIS_OK;
 }
@@ -301,7 +300,7 @@ s32 PS4_SYSV_ABI sceKernelClose(s32 fd) {
 
 s64 PS4_SYSV_ABI write(s32 fd, const void* buf, u64 nbytes) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -348,9 +347,25 @@ s64 ReadFile(Common::FS::IOFile& file, void* buf, u64 nbytes) {
     return file.ReadRaw<u8>(buf, nbytes);
 }
 
+s64 ReadFileAt(Common::FS::IOFile& file, const OrbisKernelIovec* iov, s32 iovcnt, s64 offset) {
+    const auto* memory = Core::Memory::Instance();
+    // Invalidate up to the actual number of bytes that could be read.
+    const u64 size = file.GetSizeFromHandle();
+    u64 remaining = size > u64(offset) ? size - offset : 0;
+    boost::container::small_vector<Common::FS::IOBuffer, 8> buffers;
+    for (s32 i = 0; i < iovcnt; i++) {
+        const u64 invalidate_size = std::min<u64>(iov[i].iov_len, remaining);
+        memory->InvalidateMemory(reinterpret_cast<VAddr>(iov[i].iov_base), invalidate_size);
+        remaining -= invalidate_size;
+        buffers.push_back({iov[i].iov_base, iov[i].iov_len});
+    }
+
+    return file.ReadAt({buffers.data(), buffers.size()}, offset);
+}
+
 s64 PS4_SYSV_ABI readv(s32 fd, const OrbisKernelIovec* iov, s32 iovcnt) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -400,7 +415,7 @@ s64 PS4_SYSV_ABI sceKernelReadv(s32 fd, const OrbisKernelIovec* iov, s32 iovcnt)
 
 s64 PS4_SYSV_ABI writev(s32 fd, const OrbisKernelIovec* iov, s32 iovcnt) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -442,7 +457,7 @@ s64 PS4_SYSV_ABI sceKernelWritev(s32 fd, const OrbisKernelIovec* iov, s32 iovcnt
 
 s64 PS4_SYSV_ABI posix_lseek(s32 fd, s64 offset, s32 whence) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -512,7 +527,7 @@ s64 PS4_SYSV_ABI sceKernelLseek(s32 fd, s64 offset, s32 whence) {
 
 s64 PS4_SYSV_ABI read(s32 fd, void* buf, u64 nbytes) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -730,7 +745,7 @@ s32 PS4_SYSV_ABI fstat(s32 fd, OrbisKernelStat* sb) {
         return -1;
     }
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -792,7 +807,7 @@ s32 PS4_SYSV_ABI sceKernelFstat(s32 fd, OrbisKernelStat* sb) {
 
 s32 PS4_SYSV_ABI posix_ftruncate(s32 fd, s64 length) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
 
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
@@ -902,14 +917,14 @@ s64 PS4_SYSV_ABI posix_preadv(s32 fd, OrbisKernelIovec* iov, s32 iovcnt, s64 off
     }
 
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
     }
 
-    std::scoped_lock lk{file->m_mutex};
     if (file->type == Core::FileSys::FileType::Device) {
+        std::scoped_lock lk{file->m_mutex};
         s64 result = file->device->preadv(iov, iovcnt, offset);
         if (result < 0) {
             ErrSceToPosix(result);
@@ -917,6 +932,7 @@ s64 PS4_SYSV_ABI posix_preadv(s32 fd, OrbisKernelIovec* iov, s32 iovcnt, s64 off
         }
         return result;
     } else if (file->type == Core::FileSys::FileType::Directory) {
+        std::scoped_lock lk{file->m_mutex};
         s64 result = file->directory->preadv(iov, iovcnt, offset);
         if (result < 0) {
             ErrSceToPosix(result);
@@ -930,19 +946,22 @@ s64 PS4_SYSV_ABI posix_preadv(s32 fd, OrbisKernelIovec* iov, s32 iovcnt, s64 off
         return -1;
     }
 
-    const s64 pos = file->f.Tell();
-    SCOPE_EXIT {
-        file->f.Seek(pos);
-    };
-    if (!file->f.Seek(offset)) {
+    // Regular files are read at the offset without touching the file position, so concurrent
+    // reads of a read-only file do not need the file lock. The positional read bypasses the stdio
+    // buffer that write() fills, so files open for writing are flushed and read under the lock.
+    s64 result;
+    if (file->f.GetAccessMode() == Common::FS::FileAccessMode::Read) {
+        result = ReadFileAt(file->f, iov, iovcnt, offset);
+    } else {
+        std::scoped_lock lk{file->m_mutex};
+        file->f.Flush();
+        result = ReadFileAt(file->f, iov, iovcnt, offset);
+    }
+    if (result < 0) {
         *__Error() = POSIX_EIO;
         return -1;
     }
-    s64 total_read = 0;
-    for (s32 i = 0; i < iovcnt; i++) {
-        total_read += ReadFile(file->f, iov[i].iov_base, iov[i].iov_len);
-    }
-    return total_read;
+    return result;
 }
 
 s64 PS4_SYSV_ABI sceKernelPreadv(s32 fd, OrbisKernelIovec* iov, s32 iovcnt, s64 offset) {
@@ -966,7 +985,7 @@ s64 PS4_SYSV_ABI sceKernelPread(s32 fd, void* buf, u64 nbytes, s64 offset) {
 
 s32 PS4_SYSV_ABI posix_fsync(s32 fd) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -999,7 +1018,7 @@ static s64 GetDents(s32 fd, char* buf, u64 nbytes, s64* basep) {
         return -1;
     }
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -1074,7 +1093,7 @@ s64 PS4_SYSV_ABI posix_pwritev(s32 fd, const OrbisKernelIovec* iov, s32 iovcnt,
     }
 
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
-    auto* file = h->GetFile(fd);
+    auto file = h->GetFile(fd);
     if (file == nullptr) {
         *__Error() = POSIX_EBADF;
         return -1;
@@ -1162,7 +1181,7 @@ s32 PS4_SYSV_ABI posix_unlink(const char* path) {
         return -1;
     }
 
-    auto* file = h->GetFile(host_path);
+    auto file = h->GetFile(host_path);
     if (file == nullptr) {
         // File to unlink hasn't been opened, manually open and unlink it.
         Common::FS::IOFile file(host_path, Common::FS::FileAccessMode::ReadWrite);
@@ -1233,7 +1252,7 @@ s32 PS4_SYSV_ABI posix_select(s32 nfds, fd_set_posix* readfds, fd_set_posix* wri
             continue;
         }
 
-        auto* file = h->GetFile(i);
+        auto file = h->GetFile(i);
         if (!file || ((file->type == Core::FileSys::FileType::Regular && !file->f.IsOpen()) ||
                       (file->type == Core::FileSys::FileType::Socket && !file->is_opened))) {
             LOG_ERROR(Kernel_Fs, "fd {} is null or not opened", i);
@@ -1389,7 +1408,7 @@ s32 PS4_SYSV_ABI posix_select(s32 nfds, fd_set* readfds, fd_set* writefds, fd_se
         auto write = writefds && FD_ISSET(i, writefds);
         auto except = exceptfds && FD_ISSET(i, exceptfds);
         if (read || write || except) {
-            auto* file = h->GetFile(i);
+            auto file = h->GetFile(i);
             if (file == nullptr ||
                 ((file->type == Core::FileSys::FileType::Regular && !file->f.IsOpen()) ||
                  (file->type == Core::FileSys::FileType::Socket && !file->is_opened))) {
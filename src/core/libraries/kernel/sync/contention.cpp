@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <mutex>
+
+#include "common/config.h"
+#include "core/libraries/kernel/sync/contention.h"
+
+namespace Libraries::Kernel {
+
+static std::mutex tracked_mutex;
+static std::vector<std::weak_ptr<ContentionCounters>> tracked;
+
+bool IsContentionTracked() {
+    return Config::syncContentionCounters();
+}
+
+std::shared_ptr<ContentionCounters> TrackContention(const char* kind, std::string_view name) {
+    if (!IsContentionTracked()) {
+        return nullptr;
+    }
+    auto counters = std::make_shared<ContentionCounters>();
+    counters->kind = kind;
+    counters->name = name;
+
+    std::scoped_lock lock{tracked_mutex};
+    // Titles that create short lived objects in a loop would otherwise grow the list forever.
+    if (tracked.size() == tracked.capacity()) {
+        std::erase_if(tracked, [](const auto& entry) { return entry.expired(); });
+    }
+    tracked.emplace_back(counters);
+    return counters;
+}
+
+std::vector<ContentionSnapshot> GetContentionSnapshot() {
+    std::vector<ContentionSnapshot> snapshot;
+    std::scoped_lock lock{tracked_mutex};
+    snapshot.reserve(tracked.size());
+    for (const auto& entry : tracked) {
+        const auto counters = entry.lock();
+        if (!counters) {
+            continue;
+        }
+        snapshot.emplace_back(counters->kind, counters->name,
+                              counters->acquires.load(std::memory_order_relaxed),
+                              counters->contended.load(std::memory_order_relaxed),
+                              counters->wait_ns.load(std::memory_order_relaxed));
+    }
+    return snapshot;
+}
+
+} // namespace Libraries::Kernel
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/types.h"
+#include "core/libraries/kernel/sync/futex.h"
+
+namespace Libraries::Kernel {
+
+/// How often a guest synchronization object was acquired and how long threads waited for it.
+struct ContentionCounters {
+    const char* kind;
+    std::string name;
+    std::atomic<u64> acquires{};
+    std::atomic<u64> contended{};
+    std::atomic<u64> wait_ns{};
+
+    void RecordAcquire() {
+        acquires.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Records an acquire that had to block, given the time returned by Deadline::Now before.
+    void RecordWait(s64 wait_start) {
+        acquires.fetch_add(1, std::memory_order_relaxed);
+        contended.fetch_add(1, std::memory_order_relaxed);
+        wait_ns.fetch_add(static_cast<u64>(Deadline::Now() - wait_start),
+                          std::memory_order_relaxed);
+    }
+};
+
+struct ContentionSnapshot {
+    std::string kind;
+    std::string name;
+    u64 acquires;
+    u64 contended;
+    u64 wait_ns;
+};
+
+/// Returns whether objects created now get contention counters.
+bool IsContentionTracked();
+
+/**
+ * Creates the counters of a newly created object, or returns null when contention tracking is
+ * disabled in the config. The counters stay listed for as long as the object holds them.
+ */
+std::shared_ptr<ContentionCounters> TrackContention(const char* kind, std::string_view name);
+
+/// Copies the counters of all live tracked objects.
+std::vector<ContentionSnapshot> GetContentionSnapshot();
+
+} // namespace Libraries::Kernel
@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "core/libraries/kernel/sync/futex.h"
+
+#ifdef _WIN64
+#include <windows.h>
+#elif defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace Libraries::Kernel {
+
+static_assert(sizeof(std::atomic<u32>) == sizeof(u32));
+
+#ifdef _WIN64
+
+bool FutexWait(std::atomic<u32>& word, u32 expected, const Deadline& deadline) {
+    DWORD timeout_ms = INFINITE;
+    if (!deadline.IsInfinite()) {
+        const auto remaining = deadline.Remaining();
+        if (remaining.count() == 0) {
+            return false;
+        }
+        const auto rel_ms = std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+        timeout_ms = static_cast<DWORD>(std::min<s64>(rel_ms, INFINITE - 1));
+    }
+    if (!WaitOnAddress(&word, &expected, sizeof(u32), timeout_ms)) {
+        return GetLastError() != ERROR_TIMEOUT;
+    }
+    return true;
+}
+
+void FutexWakeOne(std::atomic<u32>& word) {
+    WakeByAddressSingle(&word);
+}
+
+void FutexWakeAll(std::atomic<u32>& word) {
+    WakeByAddressAll(&word);
+}
+
+#elif defined(__linux__)
+
+bool FutexWait(std::atomic<u32>& word, u32 expected, const Deadline& deadline) {
+    // With the bitset variant the timeout is absolute on CLOCK_MONOTONIC, which steady_clock is
+    // based on, so it is passed through as is.
+    timespec abs_time{};
+    timespec* timeout = nullptr;
+    if (!deadline.IsInfinite()) {
+        abs_time.tv_sec = static_cast<time_t>(deadline.Nanoseconds() / 1'000'000'000);
+        abs_time.tv_nsec = static_cast<long>(deadline.Nanoseconds() % 1'000'000'000);
+        timeout = &abs_time;
+    }
+    const long ret = syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAIT_BITSET_PRIVATE,
+                             expected, timeout, nullptr, FUTEX_BITSET_MATCH_ANY);
+    return ret == 0 || errno != ETIMEDOUT;
+}
+
+void FutexWakeOne(std::atomic<u32>& word) {
+    syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<u32>& word) {
+    syscall(SYS_futex, reinterpret_cast<u32*>(&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr,
+            nullptr, 0);
+}
+
+#else
+
+// Without a host primitive to wait on an address, waiters park on one of a fixed set of
+// condition variables picked by hashing the address of the word.
+struct ParkingBucket {
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+static std::array<ParkingBucket, 64> parking_buckets;
+
+static ParkingBucket& GetBucket(const std::atomic<u32>& word) {
+    const auto addr = reinterpret_cast<uintptr_t>(&word);
+    return parking_buckets[(addr >> 4) % parking_buckets.size()];
+}
+
+bool FutexWait(std::atomic<u32>& word, u32 expected, const Deadline& deadline) {
+    auto& bucket = GetBucket(word);
+    std::unique_lock lock{bucket.mutex};
+    if (word.load() != expected) {
+        return true;
+    }
+    if (deadline.IsInfinite()) {
+        bucket.cv.wait(lock);
+        return true;
+    }
+    const std::chrono::steady_clock::time_point abs_time{
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds{deadline.Nanoseconds()})};
+    return bucket.cv.wait_until(lock, abs_time) == std::cv_status::no_timeout;
+}
+
+void FutexWakeOne(std::atomic<u32>& word) {
+    // Other words may share the bucket, so everyone has to check their word again.
+    FutexWakeAll(word);
+}
+
+void FutexWakeAll(std::atomic<u32>& word) {
+    auto& bucket = GetBucket(word);
+    std::scoped_lock lock{bucket.mutex};
+    bucket.cv.notify_all();
+}
+
+#endif
+
+} // namespace Libraries::Kernel
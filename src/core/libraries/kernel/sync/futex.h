@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+#include "common/types.h"
+
+namespace Libraries::Kernel {
+
+/**
+ * Point on the host monotonic clock at which a wait gives up. Guest timeouts are converted once
+ * when the wait begins, so waking up early and waiting again neither drifts nor converts again.
+ */
+class Deadline {
+public:
+    /// Creates a deadline that never passes.
+    constexpr Deadline() = default;
+
+    static Deadline After(std::chrono::nanoseconds rel_time) {
+        if (rel_time.count() < 0) {
+            rel_time = {};
+        }
+        const s64 now = Now();
+        if (rel_time.count() >= std::numeric_limits<s64>::max() - now) {
+            return {};
+        }
+        return Deadline{now + rel_time.count()};
+    }
+
+    static Deadline AfterMicroseconds(u64 usec) {
+        if (usec >= static_cast<u64>(std::numeric_limits<s64>::max() / 1000)) {
+            return {};
+        }
+        return After(std::chrono::microseconds{usec});
+    }
+
+    /// Converts an absolute guest time, which is based on the realtime clock.
+    static Deadline FromRealtime(std::chrono::system_clock::time_point abs_time) {
+        return After(abs_time - std::chrono::system_clock::now());
+    }
+
+    /// Returns the current time of the clock deadlines are measured on, in nanoseconds.
+    static s64 Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    bool IsInfinite() const {
+        return ns == Infinite;
+    }
+
+    bool HasPassed() const {
+        return !IsInfinite() && Now() >= ns;
+    }
+
+    std::chrono::nanoseconds Remaining() const {
+        return std::chrono::nanoseconds{IsInfinite() ? Infinite : std::max<s64>(ns - Now(), 0)};
+    }
+
+    s64 Nanoseconds() const {
+        return ns;
+    }
+
+private:
+    static constexpr s64 Infinite = std::numeric_limits<s64>::max();
+
+    explicit constexpr Deadline(s64 ns_) : ns{ns_} {}
+
+    s64 ns = Infinite;
+};
+
+/**
+ * Blocks while the word holds the expected value, until another thread wakes it or the deadline
+ * passes. Returns false if the deadline passed. Like the host primitives it is built on, it may
+ * also return spuriously, so callers always check the condition they wait for again.
+ */
+bool FutexWait(std::atomic<u32>& word, u32 expected, const Deadline& deadline = {});
+
+/// Wakes one thread waiting on the word.
+void FutexWakeOne(std::atomic<u32>& word);
+
+/// Wakes all threads waiting on the word.
+void FutexWakeAll(std::atomic<u32>& word);
+
+} // namespace Libraries::Kernel
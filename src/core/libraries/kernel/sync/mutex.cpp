@@ -3,50 +3,121 @@
 
 #include "mutex.h"
 
-#include "common/assert.h"
-
 namespace Libraries::Kernel {
 
-TimedMutex::TimedMutex() {
-#ifdef _WIN64
-    mtx = CreateMutex(nullptr, false, nullptr);
-    ASSERT(mtx);
-#endif
+bool TimedMutex::LockSlow(const Deadline& deadline) {
+    if (fair) {
+        return LockFair(deadline);
+    }
+    // Marking the mutex as contended makes the owner wake one waiter when it unlocks.
+    while (state.exchange(Contended, std::memory_order_acquire) != Free) {
+        if (!FutexWait(state, Contended, deadline)) {
+            return state.exchange(Contended, std::memory_order_acquire) == Free;
+        }
+    }
+    return true;
+}
+
+bool TimedMutex::LockFair(const Deadline& deadline) {
+    std::unique_lock lock{queue_mutex};
+    u32 current = state.load(std::memory_order_relaxed);
+    for (;;) {
+        if (current == Free) {
+            if (state.compare_exchange_weak(current, Locked, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+                return true;
+            }
+        } else if (current == Contended ||
+                   state.compare_exchange_weak(current, Contended, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    Waiter waiter;
+    (queue_tail ? queue_tail->next : queue_head) = &waiter;
+    queue_tail = &waiter;
+    lock.unlock();
+
+    while (!waiter.granted.load(std::memory_order_acquire)) {
+        if (FutexWait(waiter.granted, 0, deadline)) {
+            continue;
+        }
+        lock.lock();
+        if (waiter.granted.load(std::memory_order_acquire)) {
+            return true;
+        }
+        Waiter* prev = nullptr;
+        for (Waiter* it = queue_head; it != &waiter; it = it->next) {
+            prev = it;
+        }
+        (prev ? prev->next : queue_head) = waiter.next;
+        if (queue_tail == &waiter) {
+            queue_tail = prev;
+        }
+        return false;
+    }
+    return true;
+}
+
+void TimedMutex::unlock() {
+    if (fair) {
+        UnlockFair();
+        return;
+    }
+    if (state.exchange(Free, std::memory_order_release) == Contended) {
+        FutexWakeOne(state);
+    }
 }
 
-TimedMutex::~TimedMutex() {
-#ifdef _WIN64
-    CloseHandle(mtx);
-#endif
+void TimedMutex::UnlockFair() {
+    u32 expected = Locked;
+    if (state.compare_exchange_strong(expected, Free, std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+        return;
+    }
+    std::scoped_lock lock{queue_mutex};
+    Waiter* waiter = queue_head;
+    if (!waiter) {
+        state.store(Free, std::memory_order_release);
+        return;
+    }
+    queue_head = waiter->next;
+    if (!queue_head) {
+        queue_tail = nullptr;
+    }
+    // The mutex stays held and passes to the waiter. Once granted, the waiter may return and
+    // free its wait word before the wake below, which is harmless as only the address is used.
+    state.store(queue_head ? Contended : Locked, std::memory_order_relaxed);
+    waiter->granted.store(1, std::memory_order_release);
+    FutexWakeOne(waiter->granted);
 }
 
-void TimedMutex::lock() {
-#ifdef _WIN64
+template <typename TryLock>
+bool SharedTimedMutex::WaitUntil(const Deadline& deadline, TryLock&& acquire) {
     for (;;) {
-        u64 res = WaitForSingleObjectEx(mtx, INFINITE, true);
-        if (res == WAIT_OBJECT_0) {
-            return;
+        // The sequence is read before trying again, so an unlock in between makes the wait
+        // return immediately instead of being missed.
+        const u32 seq = wake_seq.load(std::memory_order_acquire);
+        num_waiters.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (acquire()) {
+            num_waiters.fetch_sub(1);
+            return true;
+        }
+        const bool woken = FutexWait(wake_seq, seq, deadline);
+        num_waiters.fetch_sub(1);
+        if (!woken) {
+            return acquire();
         }
     }
-#else
-    mtx.lock();
-#endif
 }
 
-bool TimedMutex::try_lock() {
-#ifdef _WIN64
-    return WaitForSingleObjectEx(mtx, 0, true) == WAIT_OBJECT_0;
-#else
-    return mtx.try_lock();
-#endif
+bool SharedTimedMutex::try_lock_until(const Deadline& deadline) {
+    return try_lock() || WaitUntil(deadline, [this] { return try_lock(); });
 }
 
-void TimedMutex::unlock() {
-#ifdef _WIN64
-    ReleaseMutex(mtx);
-#else
-    mtx.unlock();
-#endif
+bool SharedTimedMutex::try_lock_shared_until(const Deadline& deadline) {
+    return try_lock_shared() || WaitUntil(deadline, [this] { return try_lock_shared(); });
 }
 
-} // namespace Libraries::Kernel
\ No newline at end of file
+} // namespace Libraries::Kernel
@@ -3,78 +3,134 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <mutex>
 
 #include "common/types.h"
-
-#ifdef _WIN64
-#include <windows.h>
-#else
-#include <mutex>
-#endif
+#include "core/libraries/kernel/sync/futex.h"
 
 namespace Libraries::Kernel {
 
+/**
+ * Mutex on top of a futex word that is 0 when free, 1 when held and 2 when held with waiters,
+ * so neither locking nor unlocking enters the host kernel without contention.
+ *
+ * In fair mode, waiters queue up in arrival order and unlocking hands the mutex directly to the
+ * first of them without ever releasing it, so newly arriving threads cannot barge in.
+ */
 class TimedMutex {
 public:
-    TimedMutex();
-    ~TimedMutex();
+    TimedMutex() = default;
+    ~TimedMutex() = default;
 
-    void lock();
-    bool try_lock();
+    void SetFair(bool fair_) {
+        fair = fair_;
+    }
 
-    void unlock();
+    void lock() {
+        if (!try_lock()) {
+            LockSlow(Deadline{});
+        }
+    }
+
+    bool try_lock() {
+        u32 expected = Free;
+        return state.compare_exchange_strong(expected, Locked, std::memory_order_acquire,
+                                             std::memory_order_relaxed);
+    }
+
+    bool try_lock_until(const Deadline& deadline) {
+        return try_lock() || LockSlow(deadline);
+    }
 
     template <class Rep, class Period>
     bool try_lock_for(const std::chrono::duration<Rep, Period>& rel_time) {
-#ifdef _WIN64
-        constexpr auto zero = std::chrono::duration<Rep, Period>::zero();
-        const auto now = std::chrono::steady_clock::now();
-
-        std::chrono::steady_clock::time_point abs_time = now;
-        if (rel_time > zero) {
-            constexpr auto max = (std::chrono::steady_clock::time_point::max)();
-            if (abs_time < max - rel_time) {
-                abs_time += rel_time;
-            } else {
-                abs_time = max;
-            }
-        }
+        return try_lock() || LockSlow(Deadline::After(rel_time));
+    }
+
+    void unlock();
+
+private:
+    static constexpr u32 Free = 0;
+    static constexpr u32 Locked = 1;
+    static constexpr u32 Contended = 2;
+
+    struct Waiter {
+        std::atomic<u32> granted{};
+        Waiter* next{};
+    };
+
+    bool LockSlow(const Deadline& deadline);
+    bool LockFair(const Deadline& deadline);
+    void UnlockFair();
 
-        return try_lock_until(abs_time);
-#else
-        return mtx.try_lock_for(rel_time);
-#endif
+    std::atomic<u32> state{Free};
+    bool fair{};
+    std::mutex queue_mutex;
+    Waiter* queue_head{};
+    Waiter* queue_tail{};
+};
+
+/// Reader-writer lock on top of a futex, with the same interface as std::shared_timed_mutex.
+class SharedTimedMutex {
+public:
+    void lock() {
+        try_lock_until(Deadline{});
     }
 
-    template <class Clock, class Duration>
-    bool try_lock_until(const std::chrono::time_point<Clock, Duration>& abs_time) {
-#ifdef _WIN64
-        for (;;) {
-            const auto now = Clock::now();
-            if (abs_time <= now) {
-                return false;
-            }
+    bool try_lock() {
+        u32 expected = 0;
+        return state.compare_exchange_strong(expected, WriterBit, std::memory_order_acquire,
+                                             std::memory_order_relaxed);
+    }
+
+    bool try_lock_until(const Deadline& deadline);
+
+    void unlock() {
+        state.fetch_and(~WriterBit);
+        WakeWaiters();
+    }
+
+    void lock_shared() {
+        try_lock_shared_until(Deadline{});
+    }
 
-            const auto rel_ms = std::chrono::ceil<std::chrono::milliseconds>(abs_time - now);
-            u64 res = WaitForSingleObjectEx(mtx, static_cast<u64>(rel_ms.count()), true);
-            if (res == WAIT_OBJECT_0) {
+    bool try_lock_shared() {
+        u32 current = state.load(std::memory_order_relaxed);
+        while (!(current & WriterBit)) {
+            if (state.compare_exchange_weak(current, current + 1, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
                 return true;
-            } else if (res == WAIT_TIMEOUT) {
-                return false;
             }
         }
-#else
-        return mtx.try_lock_until(abs_time);
-#endif
+        return false;
+    }
+
+    bool try_lock_shared_until(const Deadline& deadline);
+
+    void unlock_shared() {
+        if (state.fetch_sub(1) == 1) {
+            WakeWaiters();
+        }
     }
 
 private:
-#ifdef _WIN64
-    HANDLE mtx;
-#else
-    std::timed_mutex mtx;
-#endif
+    static constexpr u32 WriterBit = 1U << 31;
+
+    template <typename TryLock>
+    bool WaitUntil(const Deadline& deadline, TryLock&& acquire);
+
+    void WakeWaiters() {
+        if (num_waiters.load() > 0) {
+            wake_seq.fetch_add(1, std::memory_order_release);
+            FutexWakeAll(wake_seq);
+        }
+    }
+
+    std::atomic<u32> state{};
+    std::atomic<u32> wake_seq{};
+    std::atomic<u32> num_waiters{};
 };
 
-} // namespace Libraries::Kernel
\ No newline at end of file
+} // namespace Libraries::Kernel
@@ -6,132 +6,71 @@
 #include <atomic>
 #include <chrono>
 
-#include "common/assert.h"
 #include "common/types.h"
-
-#ifdef _WIN64
-#include <windows.h>
-#elif defined(__APPLE__)
-#include <dispatch/dispatch.h>
-#else
-#include <semaphore>
-#endif
+#include "core/libraries/kernel/sync/futex.h"
 
 namespace Libraries::Kernel {
 
+/// Counting semaphore on top of a futex. Releasing a semaphore that is already at its maximum
+/// count has no effect.
 template <s64 max>
 class Semaphore {
 public:
-    Semaphore(s32 initialCount)
-#if !defined(_WIN64) && !defined(__APPLE__)
-        : sem{initialCount}
-#endif
-    {
-#ifdef _WIN64
-        sem = CreateSemaphore(nullptr, initialCount, max, nullptr);
-        ASSERT(sem);
-#elif defined(__APPLE__)
-        sem = dispatch_semaphore_create(initialCount);
-        ASSERT(sem);
-#endif
-    }
-
-    ~Semaphore() {
-#ifdef _WIN64
-        CloseHandle(sem);
-#elif defined(__APPLE__)
-        dispatch_release(sem);
-#endif
-    }
+    Semaphore(s32 initialCount) : count{static_cast<u32>(initialCount)} {}
 
     void release() {
-#ifdef _WIN64
-        ReleaseSemaphore(sem, 1, nullptr);
-#elif defined(__APPLE__)
-        dispatch_semaphore_signal(sem);
-#else
-        sem.release();
-#endif
-    }
-
-    void acquire() {
-#ifdef _WIN64
-        for (;;) {
-            u64 res = WaitForSingleObjectEx(sem, INFINITE, true);
-            if (res == WAIT_OBJECT_0) {
-                return;
-            }
-        }
-#elif defined(__APPLE__)
-        for (;;) {
-            const auto res = dispatch_semaphore_wait(sem, DISPATCH_TIME_FOREVER);
-            if (res == 0) {
+        u32 current = count.load(std::memory_order_relaxed);
+        do {
+            if (current >= static_cast<u64>(max)) {
                 return;
             }
+        } while (!count.compare_exchange_weak(current, current + 1, std::memory_order_release,
+                                              std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (num_waiters.load(std::memory_order_relaxed) > 0) {
+            FutexWakeOne(count);
         }
-#else
-        sem.acquire();
-#endif
     }
 
-    bool try_acquire() {
-#ifdef _WIN64
-        return WaitForSingleObjectEx(sem, 0, true) == WAIT_OBJECT_0;
-#elif defined(__APPLE__)
-        return dispatch_semaphore_wait(sem, DISPATCH_TIME_NOW) == 0;
-#else
-        return sem.try_acquire();
-#endif
+    void acquire() {
+        try_acquire_until(Deadline{});
     }
 
-    template <class Rep, class Period>
-    bool try_acquire_for(const std::chrono::duration<Rep, Period>& rel_time) {
-#ifdef _WIN64
-        auto rel_time_ms = std::chrono::ceil<std::chrono::milliseconds>(rel_time);
-        do {
-            const auto start_time = std::chrono::high_resolution_clock::now();
-            u64 timeout_ms = static_cast<u64>(rel_time_ms.count());
-            u64 res = WaitForSingleObjectEx(sem, timeout_ms, true);
-            if (res == WAIT_OBJECT_0) {
+    bool try_acquire() {
+        u32 current = count.load(std::memory_order_relaxed);
+        while (current > 0) {
+            if (count.compare_exchange_weak(current, current - 1, std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
                 return true;
-            } else if (res == WAIT_IO_COMPLETION) {
-                auto elapsed_time = std::chrono::high_resolution_clock::now() - start_time;
-                rel_time_ms -= std::chrono::duration_cast<std::chrono::milliseconds>(elapsed_time);
-            } else {
-                return false;
             }
-        } while (rel_time_ms.count() > 0);
-
+        }
         return false;
-#elif defined(__APPLE__)
-        const auto rel_time_ns = std::chrono::ceil<std::chrono::nanoseconds>(rel_time);
-        const auto timeout = dispatch_time(DISPATCH_TIME_NOW, rel_time_ns.count());
-        return dispatch_semaphore_wait(sem, timeout) == 0;
-#else
-        return sem.try_acquire_for(rel_time);
-#endif
     }
 
-    template <class Clock, class Duration>
-    bool try_acquire_until(const std::chrono::time_point<Clock, Duration>& abs_time) {
-        const auto current = Clock::now();
-        if (current >= abs_time) {
-            return try_acquire();
+    template <class Rep, class Period>
+    bool try_acquire_for(const std::chrono::duration<Rep, Period>& rel_time) {
+        return try_acquire() || try_acquire_until(Deadline::After(rel_time));
+    }
+
+    bool try_acquire_until(const Deadline& deadline) {
+        while (!try_acquire()) {
+            num_waiters.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const bool woken = FutexWait(count, 0, deadline);
+            num_waiters.fetch_sub(1, std::memory_order_relaxed);
+            if (!woken) {
+                return try_acquire();
+            }
         }
-        return try_acquire_for(abs_time - current);
+        return true;
     }
 
 private:
-#ifdef _WIN64
-    HANDLE sem;
-#elif defined(__APPLE__)
-    dispatch_semaphore_t sem;
-#else
-    std::counting_semaphore<max> sem;
-#endif
+    std::atomic<u32> count;
+    std::atomic<u32> num_waiters{};
 };
 
 using BinarySemaphore = Semaphore<1>;
 using CountingSemaphore = Semaphore<0x7FFFFFFF /*ORBIS_KERNEL_SEM_VALUE_MAX*/>;
 
-} // namespace Libraries::Kernel
\ No newline at end of file
+} // namespace Libraries::Kernel
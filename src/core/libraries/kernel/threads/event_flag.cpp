@@ -1,12 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
-#include <condition_variable>
 #include <mutex>
 #include <thread>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "core/libraries/kernel/sync/contention.h"
+#include "core/libraries/kernel/sync/futex.h"
+#include "core/libraries/kernel/sync/mutex.h"
 #include "core/libraries/kernel/orbis_error.h"
 #include "core/libraries/libs.h"
 
@@ -31,34 +33,34 @@ public:
 
     EventFlagInternal(const std::string& name, ThreadMode thread_mode, QueueMode queue_mode,
                       uint64_t bits)
-        : m_name(name), m_thread_mode(thread_mode), m_queue_mode(queue_mode), m_bits(bits) {};
+        : m_counters(TrackContention("Event flag", name)), m_name(name), m_thread_mode(thread_mode),
+          m_queue_mode(queue_mode), m_bits(bits) {};
 
     int Wait(u64 bits, WaitMode wait_mode, ClearMode clear_mode, u64* result, u32* ptr_micros) {
         std::unique_lock lock{m_mutex};
 
-        uint32_t micros = 0;
-        bool infinitely = true;
-        if (ptr_micros != nullptr) {
-            micros = *ptr_micros;
-            infinitely = false;
-        }
-
         if (m_thread_mode == ThreadMode::Single && m_waiting_threads > 0) {
             return ORBIS_KERNEL_ERROR_EPERM;
         }
 
-        auto const start = std::chrono::system_clock::now();
-        m_waiting_threads++;
+        const auto deadline = ptr_micros ? Deadline::AfterMicroseconds(*ptr_micros) : Deadline{};
         auto waitFunc = [this, wait_mode, bits] {
             return (m_status == Status::Canceled || m_status == Status::Deleted ||
                     (wait_mode == WaitMode::And && (m_bits & bits) == bits) ||
                     (wait_mode == WaitMode::Or && (m_bits & bits) != 0));
         };
 
-        if (infinitely) {
-            m_cond_var.wait(lock, waitFunc);
-        } else {
-            if (!m_cond_var.wait_for(lock, std::chrono::microseconds(micros), waitFunc)) {
+        const bool contended = !waitFunc();
+        const s64 wait_start = m_counters && contended ? Deadline::Now() : 0;
+        m_waiting_threads++;
+        while (!waitFunc()) {
+            // The sequence only changes under the lock, so a change after reading it here makes
+            // the wait return right away.
+            const u32 seq = m_wake_seq.load(std::memory_order_relaxed);
+            lock.unlock();
+            const bool woken = FutexWait(m_wake_seq, seq, deadline);
+            lock.lock();
+            if (!woken && !waitFunc()) {
                 if (result != nullptr) {
                     *result = m_bits;
                 }
@@ -72,15 +74,10 @@ public:
             *result = m_bits;
         }
 
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
-                           std::chrono::system_clock::now() - start)
-                           .count();
-        if (result != nullptr) {
-            *result = m_bits;
-        }
-
         if (ptr_micros != nullptr) {
-            *ptr_micros = (elapsed >= micros ? 0 : micros - elapsed);
+            *ptr_micros = static_cast<u32>(
+                std::chrono::duration_cast<std::chrono::microseconds>(deadline.Remaining())
+                    .count());
         }
 
         if (m_status == Status::Canceled) {
@@ -95,6 +92,9 @@ public:
             m_bits &= ~bits;
         }
 
+        if (m_counters) {
+            contended ? m_counters->RecordWait(wait_start) : m_counters->RecordAcquire();
+        }
         return ORBIS_OK;
     }
 
@@ -118,7 +118,7 @@ public:
         }
 
         m_bits |= bits;
-        m_cond_var.notify_all();
+        WakeWaiters();
     }
 
     void Clear(u64 bits) {
@@ -148,7 +148,7 @@ public:
         m_status = Status::Canceled;
         m_bits = setPattern;
 
-        m_cond_var.notify_all();
+        WakeWaiters();
 
         while (m_waiting_threads > 0) {
             m_mutex.unlock();
@@ -162,8 +162,14 @@ public:
 private:
     enum class Status { Set, Canceled, Deleted };
 
-    std::mutex m_mutex;
-    std::condition_variable m_cond_var;
+    void WakeWaiters() {
+        m_wake_seq.fetch_add(1, std::memory_order_relaxed);
+        FutexWakeAll(m_wake_seq);
+    }
+
+    TimedMutex m_mutex;
+    std::atomic<u32> m_wake_seq{};
+    std::shared_ptr<ContentionCounters> m_counters;
     Status m_status = Status::Set;
     int m_waiting_threads = 0;
     std::string m_name;
@@ -74,6 +74,10 @@ static int MutexInit(PthreadMutexT* mutex, const PthreadMutexAttr* mutex_attr, c
         pmutex->m_spinloops = MUTEX_ADAPTIVE_SPINS;
         // pmutex->m_yieldloops = _thr_yieldloops;
     }
+    // Host threads don't run by guest priority, so priority protocols can't be honored. Handing
+    // the mutex to waiters in arrival order at least keeps them from being starved.
+    pmutex->m_lock.SetFair(attr->m_protocol != PthreadMutexProt::None);
+    pmutex->counters = TrackContention("Mutex", pmutex->name);
 
     *mutex = pmutex;
     return 0;
@@ -197,14 +201,26 @@ int PthreadMutex::Lock(const OrbisKernelTimespec* abstime, u64 usec) {
      * the lock is likely to be released quickly and it is
      * faster than entering the kernel
      */
+    if (m_lock.try_lock()) [[likely]] {
+        m_owner = curthread;
+        if (counters) {
+            counters->RecordAcquire();
+        }
+        return 0;
+    }
+    const s64 wait_start = counters ? Deadline::Now() : 0;
+
     if (m_protocol == PthreadMutexProt::None) [[likely]] {
         int count = m_spinloops;
         while (count--) {
+            CPU_SPINWAIT;
             if (m_lock.try_lock()) {
                 m_owner = curthread;
+                if (counters) {
+                    counters->RecordWait(wait_start);
+                }
                 return 0;
             }
-            CPU_SPINWAIT;
         }
 
         count = m_yieldloops;
@@ -212,6 +228,9 @@ int PthreadMutex::Lock(const OrbisKernelTimespec* abstime, u64 usec) {
             std::this_thread::yield();
             if (m_lock.try_lock()) {
                 m_owner = curthread;
+                if (counters) {
+                    counters->RecordWait(wait_start);
+                }
                 return 0;
             }
         }
@@ -224,14 +243,16 @@ int PthreadMutex::Lock(const OrbisKernelTimespec* abstime, u64 usec) {
         [[unlikely]] {
         ret = POSIX_EINVAL;
     } else {
-        if (abstime == THR_RELTIME) {
-            ret = m_lock.try_lock_for(std::chrono::microseconds(usec)) ? 0 : POSIX_ETIMEDOUT;
-        } else {
-            ret = m_lock.try_lock_until(abstime->TimePoint()) ? 0 : POSIX_ETIMEDOUT;
-        }
+        const auto deadline = abstime == THR_RELTIME
+                                  ? Deadline::AfterMicroseconds(usec)
+                                  : Deadline::FromRealtime(abstime->TimePoint());
+        ret = m_lock.try_lock_until(deadline) ? 0 : POSIX_ETIMEDOUT;
     }
     if (ret == 0) {
         m_owner = curthread;
+        if (counters) {
+            counters->RecordWait(wait_start);
+        }
     }
     return ret;
 }
@@ -244,6 +265,9 @@ int PthreadMutex::TryLock() {
     const int ret = m_lock.try_lock() ? 0 : POSIX_EBUSY;
     if (ret == 0) {
         m_owner = curthread;
+        if (counters) {
+            counters->RecordAcquire();
+        }
     }
     return ret;
 }
@@ -12,6 +12,10 @@
 #include "core/libraries/libs.h"
 #include "core/memory.h"
 
+#ifdef _WIN64
+#include <windows.h>
+#endif
+
 namespace Libraries::Kernel {
 
 constexpr int PthreadInheritSched = 4;
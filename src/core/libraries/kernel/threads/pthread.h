@@ -10,6 +10,7 @@
 #include <shared_mutex>
 
 #include "common/enum.h"
+#include "core/libraries/kernel/sync/contention.h"
 #include "core/libraries/kernel/sync/mutex.h"
 #include "core/libraries/kernel/sync/semaphore.h"
 #include "core/libraries/kernel/time.h"
@@ -55,6 +56,7 @@ struct PthreadMutex {
     int m_yieldloops;
     PthreadMutexProt m_protocol;
     std::string name;
+    std::shared_ptr<ContentionCounters> counters;
 
     [[nodiscard]] PthreadMutexType Type() const noexcept {
         return static_cast<PthreadMutexType>(m_flags & PthreadMutexFlags::TypeMask);
@@ -188,8 +190,9 @@ struct PthreadRwlockAttr {
 using PthreadRwlockAttrT = PthreadRwlockAttr*;
 
 struct PthreadRwlock {
-    std::shared_timed_mutex lock;
+    SharedTimedMutex lock;
     Pthread* owner;
+    std::shared_ptr<ContentionCounters> counters;
 
     int Wrlock(const OrbisKernelTimespec* abstime);
     int Rdlock(const OrbisKernelTimespec* abstime);
@@ -331,9 +334,9 @@ struct Pthread {
             WakeAll();
         }
         if (abstime == THR_RELTIME) {
-            return wake_sema.try_acquire_for(std::chrono::microseconds(usec));
+            return wake_sema.try_acquire_until(Deadline::AfterMicroseconds(usec));
         } else if (abstime != nullptr) {
-            return wake_sema.try_acquire_until(abstime->TimePoint());
+            return wake_sema.try_acquire_until(Deadline::FromRealtime(abstime->TimePoint()));
         } else {
             wake_sema.acquire();
             return true;
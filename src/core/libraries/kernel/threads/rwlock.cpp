@@ -31,6 +31,9 @@ static int RwlockInit(PthreadRwlockT* rwlock, const PthreadRwlockAttrT* attr) {
     if (prwlock == nullptr) {
         return POSIX_ENOMEM;
     }
+    if (IsContentionTracked()) {
+        prwlock->counters = TrackContention("Rwlock", fmt::format("{}", fmt::ptr(prwlock)));
+    }
     *rwlock = prwlock;
     return 0;
 }
@@ -70,6 +73,9 @@ int PthreadRwlock::Rdlock(const OrbisKernelTimespec* abstime) {
      */
     if (lock.try_lock_shared()) {
         curthread->rdlock_count++;
+        if (counters) {
+            counters->RecordAcquire();
+        }
         return 0;
     }
     if (abstime && (abstime->tv_nsec >= 1000000000 || abstime->tv_nsec < 0)) [[unlikely]] {
@@ -77,8 +83,9 @@ int PthreadRwlock::Rdlock(const OrbisKernelTimespec* abstime) {
     }
 
     // Note: On interruption an attempt to relock the mutex is made.
+    const s64 wait_start = counters ? Deadline::Now() : 0;
     if (abstime != nullptr) {
-        if (!lock.try_lock_shared_until(abstime->TimePoint())) {
+        if (!lock.try_lock_shared_until(Deadline::FromRealtime(abstime->TimePoint()))) {
             return POSIX_ETIMEDOUT;
         }
     } else {
@@ -86,6 +93,9 @@ int PthreadRwlock::Rdlock(const OrbisKernelTimespec* abstime) {
     }
 
     curthread->rdlock_count++;
+    if (counters) {
+        counters->RecordWait(wait_start);
+    }
     return 0;
 }
 
@@ -98,6 +108,9 @@ int PthreadRwlock::Wrlock(const OrbisKernelTimespec* abstime) {
      */
     if (lock.try_lock()) {
         owner = curthread;
+        if (counters) {
+            counters->RecordAcquire();
+        }
         return 0;
     }
 
@@ -106,8 +119,9 @@ int PthreadRwlock::Wrlock(const OrbisKernelTimespec* abstime) {
     }
 
     // Note: On interruption an attempt to relock the mutex is made.
+    const s64 wait_start = counters ? Deadline::Now() : 0;
     if (abstime != nullptr) {
-        if (!lock.try_lock_until(abstime->TimePoint())) {
+        if (!lock.try_lock_until(Deadline::FromRealtime(abstime->TimePoint()))) {
             return POSIX_ETIMEDOUT;
         }
     } else {
@@ -115,6 +129,9 @@ int PthreadRwlock::Wrlock(const OrbisKernelTimespec* abstime) {
     }
 
     owner = curthread;
+    if (counters) {
+        counters->RecordWait(wait_start);
+    }
     return 0;
 }
 
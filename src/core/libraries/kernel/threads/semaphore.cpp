@@ -1,11 +1,11 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
-#include <condition_variable>
 #include <list>
 #include <mutex>
-#include <semaphore>
 
+#include "core/libraries/kernel/sync/contention.h"
+#include "core/libraries/kernel/sync/mutex.h"
 #include "core/libraries/kernel/sync/semaphore.h"
 
 #include "common/logging/log.h"
@@ -32,13 +32,16 @@ class OrbisSem {
 public:
     OrbisSem(s32 init_count, s32 max_count, std::string_view name, bool is_fifo)
         : name{name}, token_count{init_count}, max_count{max_count}, init_count{init_count},
-          is_fifo{is_fifo} {}
+          is_fifo{is_fifo}, counters{TrackContention("Semaphore", name)} {}
     ~OrbisSem() = default;
 
     s32 Wait(bool can_block, s32 need_count, u32* timeout) {
         std::unique_lock lk{mutex};
         if (token_count >= need_count) {
             token_count -= need_count;
+            if (counters) {
+                counters->RecordAcquire();
+            }
             return ORBIS_OK;
         }
         if (!can_block) {
@@ -54,9 +57,12 @@ public:
         const auto it = AddWaiter(&waiter);
 
         // Perform the wait.
+        const s64 wait_start = counters ? Deadline::Now() : 0;
         const s32 result = waiter.Wait(lk, timeout);
         if (result == ORBIS_KERNEL_ERROR_ETIMEDOUT) {
             wait_list.erase(it);
+        } else if (result == ORBIS_OK && counters) {
+            counters->RecordWait(wait_start);
         }
         return result;
     }
@@ -140,7 +146,7 @@ public:
             return ORBIS_KERNEL_ERROR_ETIMEDOUT;
         }
 
-        s32 Wait(std::unique_lock<std::mutex>& lk, u32* timeout) {
+        s32 Wait(std::unique_lock<TimedMutex>& lk, u32* timeout) {
             lk.unlock();
             if (!timeout) {
                 // Wait indefinitely until we are woken up.
@@ -148,14 +154,13 @@ public:
                 lk.lock();
             } else {
                 // Wait until timeout runs out, recording how much remaining time there was.
-                const auto start = std::chrono::high_resolution_clock::now();
-                sem.try_acquire_for(std::chrono::microseconds(*timeout));
-                const auto end = std::chrono::high_resolution_clock::now();
-                const auto time =
-                    std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+                const auto deadline = Deadline::AfterMicroseconds(*timeout);
+                sem.try_acquire_until(deadline);
                 lk.lock();
                 if (was_signaled) {
-                    *timeout -= time;
+                    *timeout = static_cast<u32>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(deadline.Remaining())
+                            .count());
                 } else {
                     *timeout = 0;
                 }
@@ -183,10 +188,11 @@ public:
     WaitList wait_list;
     std::string name;
     std::atomic<s32> token_count;
-    std::mutex mutex;
+    TimedMutex mutex;
     s32 max_count;
     s32 init_count;
     bool is_fifo;
+    std::shared_ptr<ContentionCounters> counters;
 };
 
 using OrbisKernelSema = Common::SlotId;
@@ -293,7 +299,7 @@ s32 PS4_SYSV_ABI posix_sem_timedwait(PthreadSem** sem, const OrbisKernelTimespec
         *__Error() = POSIX_EINVAL;
         return -1;
     }
-    if (!(*sem)->semaphore.try_acquire_until(t->TimePoint())) {
+    if (!(*sem)->semaphore.try_acquire_until(Deadline::FromRealtime(t->TimePoint()))) {
         *__Error() = POSIX_ETIMEDOUT;
         return -1;
     }
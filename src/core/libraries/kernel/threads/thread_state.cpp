@@ -3,6 +3,7 @@
 
 #include <boost/container/small_vector.hpp>
 #include "common/alignment.h"
+#include "common/assert.h"
 #include "common/scope_exit.h"
 #include "core/libraries/kernel/posix_error.h"
 #include "core/libraries/kernel/threads/pthread.h"
@@ -7,6 +7,7 @@
 #include <span>
 #include <string>
 #include <vector>
+#include <tsl/robin_map.h>
 #include "common/assert.h"
 #include "common/types.h"
 
@@ -74,6 +75,7 @@ public:
 
 private:
     std::vector<SymbolRecord> m_symbols;
+    tsl::robin_map<std::string, size_t> m_symbol_index;
 };
 
 } // namespace Core::Loader
@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <bit>
+
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/config.h"
@@ -55,7 +57,10 @@ void MemoryManager::SetupMemoryRegions(u64 flexible_size, bool use_extended_mem1
     // Insert an area that covers the direct memory physical address block.
     // Note that this should never be called after direct memory allocations have been made.
     dmem_map.clear();
-    dmem_map.emplace(0, DirectMemoryArea{0, total_direct_size});
+    for (auto& bucket : free_dmem_buckets) {
+        bucket.clear();
+    }
+    TrackFreeDmem(dmem_map.emplace(0, DirectMemoryArea{0, total_direct_size}).first);
 
     // Insert an area that covers the flexible memory physical address block.
     // Note that this should never be called after flexible memory allocations have been made.
@@ -148,26 +153,9 @@ PAddr MemoryManager::PoolExpand(PAddr search_start, PAddr search_end, u64 size,
     std::scoped_lock lk{mutex};
     alignment = alignment > 0 ? alignment : 64_KB;
 
-    auto dmem_area = FindDmemArea(search_start);
-    auto mapping_start = search_start > dmem_area->second.base
-                             ? Common::AlignUp(search_start, alignment)
-                             : Common::AlignUp(dmem_area->second.base, alignment);
-    auto mapping_end = mapping_start + size;
-
     // Find the first free, large enough dmem area in the range.
-    while (dmem_area->second.dma_type != DMAType::Free ||
-           dmem_area->second.GetEnd() < mapping_end) {
-        // The current dmem_area isn't suitable, move to the next one.
-        dmem_area++;
-        if (dmem_area == dmem_map.end()) {
-            break;
-        }
-
-        // Update local variables based on the new dmem_area
-        mapping_start = Common::AlignUp(dmem_area->second.base, alignment);
-        mapping_end = mapping_start + size;
-    }
-
+    PAddr mapping_start{};
+    const auto dmem_area = FindFreeDmemArea(search_start, size, alignment, mapping_start);
     if (dmem_area == dmem_map.end()) {
         // There are no suitable mappings in this range
         LOG_ERROR(Kernel_Vmm, "Unable to find free direct memory area: size = {:#x}", size);
@@ -178,6 +166,7 @@ PAddr MemoryManager::PoolExpand(PAddr search_start, PAddr search_end, u64 size,
     auto& area = CarveDmemArea(mapping_start, size)->second;
     area.dma_type = DMAType::Pooled;
     area.memory_type = 3;
+    TrackFreeDmem(FindDmemArea(mapping_start));
 
     // Track how much dmem was allocated for pools.
     pool_budget += size;
@@ -190,26 +179,9 @@ PAddr MemoryManager::Allocate(PAddr search_start, PAddr search_end, u64 size, u6
     std::scoped_lock lk{mutex};
     alignment = alignment > 0 ? alignment : 16_KB;
 
-    auto dmem_area = FindDmemArea(search_start);
-    auto mapping_start = search_start > dmem_area->second.base
-                             ? Common::AlignUp(search_start, alignment)
-                             : Common::AlignUp(dmem_area->second.base, alignment);
-    auto mapping_end = mapping_start + size;
-
     // Find the first free, large enough dmem area in the range.
-    while (dmem_area->second.dma_type != DMAType::Free ||
-           dmem_area->second.GetEnd() < mapping_end) {
-        // The current dmem_area isn't suitable, move to the next one.
-        dmem_area++;
-        if (dmem_area == dmem_map.end()) {
-            break;
-        }
-
-        // Update local variables based on the new dmem_area
-        mapping_start = Common::AlignUp(dmem_area->second.base, alignment);
-        mapping_end = mapping_start + size;
-    }
-
+    PAddr mapping_start{};
+    const auto dmem_area = FindFreeDmemArea(search_start, size, alignment, mapping_start);
     if (dmem_area == dmem_map.end()) {
         // There are no suitable mappings in this range
         LOG_ERROR(Kernel_Vmm, "Unable to find free direct memory area: size = {:#x}", size);
@@ -221,6 +193,7 @@ PAddr MemoryManager::Allocate(PAddr search_start, PAddr search_end, u64 size, u6
     area.memory_type = memory_type;
     area.dma_type = DMAType::Allocated;
     MergeAdjacent(dmem_map, dmem_area);
+    TrackFreeDmem(FindDmemArea(mapping_start));
     return mapping_start;
 }
 
@@ -267,7 +240,7 @@ void MemoryManager::Free(PAddr phys_addr, u64 size) {
         new_dmem_area.memory_type = 0;
 
         // Merge the new dmem_area with dmem_map
-        MergeAdjacent(dmem_map, dmem_handle);
+        TrackFreeDmem(MergeAdjacent(dmem_map, dmem_handle));
 
         // Get the next relevant dmem area.
         phys_addr_to_search = phys_addr + size_in_dma;
@@ -338,7 +311,7 @@ s32 MemoryManager::PoolCommit(VAddr virtual_addr, u64 size, MemoryProt prot, s32
     new_dmem_area.dma_type = DMAType::Committed;
     new_dmem_area.memory_type = mtype;
     new_vma.phys_base = new_dmem_area.base;
-    MergeAdjacent(dmem_map, new_dmem_handle);
+    TrackFreeDmem(MergeAdjacent(dmem_map, new_dmem_handle));
 
     // Perform the mapping
     void* out_addr = impl.Map(mapped_addr, size, alignment, new_vma.phys_base, false);
@@ -414,7 +387,7 @@ s32 MemoryManager::MapMemory(void** out_addr, VAddr virtual_addr, u64 size, Memo
             new_dmem_area.dma_type = DMAType::Mapped;
 
             // Merge the new dmem_area with dmem_map
-            MergeAdjacent(dmem_map, dmem_handle);
+            TrackFreeDmem(MergeAdjacent(dmem_map, dmem_handle));
 
             // Get the next relevant dmem area.
             phys_addr_to_search = phys_addr + size_in_dma;
@@ -642,7 +615,7 @@ s32 MemoryManager::PoolDecommit(VAddr virtual_addr, u64 size) {
         new_dmem_area.dma_type = DMAType::Pooled;
 
         // Coalesce with nearby direct memory areas.
-        MergeAdjacent(dmem_map, new_dmem_handle);
+        TrackFreeDmem(MergeAdjacent(dmem_map, new_dmem_handle));
     }
 
     // Mark region as pool reserved and attempt to coalesce it with neighbours.
@@ -711,7 +684,7 @@ u64 MemoryManager::UnmapBytesFromEntry(VAddr virtual_addr, VirtualMemoryArea vma
             phys_addr += dmem_area.size;
 
             // Check if we can coalesce any dmem areas.
-            MergeAdjacent(dmem_map, dmem_handle);
+            TrackFreeDmem(MergeAdjacent(dmem_map, dmem_handle));
             dmem_handle = FindDmemArea(phys_addr);
         }
     }
@@ -980,42 +953,59 @@ s32 MemoryManager::DirectQueryAvailable(PAddr search_start, PAddr search_end, u6
                                         PAddr* phys_addr_out, u64* size_out) {
     std::scoped_lock lk{mutex};
 
-    auto dmem_area = FindDmemArea(search_start);
     PAddr paddr{};
     u64 max_size{};
+    const auto check_area = [&](const DirectMemoryArea& area) {
+        auto aligned_base = alignment > 0 ? Common::AlignUp(area.base, alignment) : area.base;
+        const auto alignment_size = aligned_base - area.base;
+        auto remaining_size = area.size >= alignment_size ? area.size - alignment_size : 0;
 
-    while (dmem_area != dmem_map.end()) {
-        if (dmem_area->second.dma_type != DMAType::Free) {
-            dmem_area++;
-            continue;
-        }
-
-        auto aligned_base = alignment > 0 ? Common::AlignUp(dmem_area->second.base, alignment)
-                                          : dmem_area->second.base;
-        const auto alignment_size = aligned_base - dmem_area->second.base;
-        auto remaining_size =
-            dmem_area->second.size >= alignment_size ? dmem_area->second.size - alignment_size : 0;
-
-        if (dmem_area->second.base < search_start) {
+        if (area.base < search_start) {
             // We need to trim remaining_size to ignore addresses before search_start
-            remaining_size = remaining_size > (search_start - dmem_area->second.base)
-                                 ? remaining_size - (search_start - dmem_area->second.base)
+            remaining_size = remaining_size > (search_start - area.base)
+                                 ? remaining_size - (search_start - area.base)
                                  : 0;
             aligned_base = alignment > 0 ? Common::AlignUp(search_start, alignment) : search_start;
         }
 
-        if (dmem_area->second.GetEnd() > search_end) {
+        if (area.GetEnd() > search_end) {
             // We need to trim remaining_size to ignore addresses beyond search_end
-            remaining_size = remaining_size > (dmem_area->second.GetEnd() - search_end)
-                                 ? remaining_size - (dmem_area->second.GetEnd() - search_end)
+            remaining_size = remaining_size > (area.GetEnd() - search_end)
+                                 ? remaining_size - (area.GetEnd() - search_end)
                                  : 0;
         }
 
-        if (remaining_size > max_size) {
+        // Candidates are not visited in address order, so ties go to the lowest address.
+        if (remaining_size > max_size ||
+            (remaining_size != 0 && remaining_size == max_size && aligned_base < paddr)) {
             paddr = aligned_base;
             max_size = remaining_size;
         }
-        dmem_area++;
+    };
+
+    // The area containing search_start is the only candidate that may begin before it.
+    const auto first_area = FindDmemArea(search_start);
+    if (first_area->second.dma_type == DMAType::Free) {
+        check_area(first_area->second);
+    }
+
+    // No area has more space available than its size, so once the best candidate reaches the
+    // upper bound of a size bucket, that bucket and all smaller ones can be skipped.
+    for (size_t bucket_idx = free_dmem_buckets.size(); bucket_idx-- > 0;) {
+        if (bucket_idx + 1 < free_dmem_buckets.size() && max_size >= (2ULL << bucket_idx)) {
+            break;
+        }
+        auto& bucket = free_dmem_buckets[bucket_idx];
+        auto it = bucket.upper_bound(first_area->second.base);
+        while (it != bucket.end() && *it < search_end) {
+            const auto area = FindTrackedFreeDmem(*it, bucket_idx);
+            if (area == dmem_map.end()) {
+                it = bucket.erase(it);
+                continue;
+            }
+            check_area(area->second);
+            ++it;
+        }
     }
 
     *phys_addr_out = paddr;
@@ -1058,7 +1048,7 @@ s32 MemoryManager::SetDirectMemoryType(VAddr addr, u64 size, s32 memory_type) {
                 phys_addr += dmem_area.size;
 
                 // Check if we can coalesce any dmem areas now that the types are different.
-                MergeAdjacent(dmem_map, dmem_handle);
+                TrackFreeDmem(MergeAdjacent(dmem_map, dmem_handle));
                 dmem_handle = FindDmemArea(phys_addr);
             }
         }
@@ -1284,6 +1274,75 @@ MemoryManager::DMemHandle MemoryManager::CarveDmemArea(PAddr addr, u64 size) {
     return dmem_handle;
 }
 
+static size_t FreeDmemBucket(u64 size) {
+    return static_cast<size_t>(std::bit_width(size)) - 1;
+}
+
+MemoryManager::DMemHandle MemoryManager::FindFreeDmemArea(PAddr search_start, u64 size,
+                                                          u64 alignment, PAddr& mapping_start) {
+    // The area containing search_start is the only candidate that may begin before it.
+    const auto first_area = FindDmemArea(search_start);
+    if (first_area->second.dma_type == DMAType::Free) {
+        const PAddr start = std::max(search_start, first_area->second.base);
+        mapping_start = Common::AlignUp(start, alignment);
+        if (mapping_start + size <= first_area->second.GetEnd()) {
+            return first_area;
+        }
+    }
+
+    // Areas in buckets above the size class of the request are large enough unless alignment
+    // pushes their start too far, so most buckets are settled by their first entry past
+    // search_start. The bucket of the request itself may also hold areas that are too small, and
+    // those are skipped one by one. The lowest address found is the first fit, matching a linear
+    // walk of dmem_map.
+    auto best_area = dmem_map.end();
+    const size_t min_bucket = FreeDmemBucket(std::max<u64>(size, 1));
+    for (size_t bucket_idx = min_bucket; bucket_idx < free_dmem_buckets.size(); ++bucket_idx) {
+        auto& bucket = free_dmem_buckets[bucket_idx];
+        auto it = bucket.upper_bound(search_start);
+        while (it != bucket.end() &&
+               (best_area == dmem_map.end() || *it < best_area->second.base)) {
+            const auto area = FindTrackedFreeDmem(*it, bucket_idx);
+            if (area == dmem_map.end()) {
+                it = bucket.erase(it);
+                continue;
+            }
+            const PAddr start = Common::AlignUp(area->second.base, alignment);
+            if (start + size <= area->second.GetEnd()) {
+                best_area = area;
+                mapping_start = start;
+                break;
+            }
+            ++it;
+        }
+    }
+    return best_area;
+}
+
+MemoryManager::DMemHandle MemoryManager::FindTrackedFreeDmem(PAddr base, size_t bucket_idx) {
+    const auto area = dmem_map.find(base);
+    if (area == dmem_map.end() || area->second.dma_type != DMAType::Free ||
+        FreeDmemBucket(area->second.size) != bucket_idx) {
+        return dmem_map.end();
+    }
+    return area;
+}
+
+void MemoryManager::TrackFreeDmem(DMemHandle handle) {
+    const auto track = [this](DMemHandle area) {
+        if (area->second.dma_type == DMAType::Free) {
+            free_dmem_buckets[FreeDmemBucket(area->second.size)].insert(area->second.base);
+        }
+    };
+    if (handle != dmem_map.begin()) {
+        track(std::prev(handle));
+    }
+    track(handle);
+    if (const auto next = std::next(handle); next != dmem_map.end()) {
+        track(next);
+    }
+}
+
 MemoryManager::FMemHandle MemoryManager::CarveFmemArea(PAddr addr, u64 size) {
     auto fmem_handle = FindFmemArea(addr);
     ASSERT_MSG(addr <= fmem_handle->second.GetEnd(), "Physical address not in fmem_map");
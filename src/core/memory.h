@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <array>
 #include <map>
 #include <mutex>
+#include <set>
 #include <string>
 #include <string_view>
 #include "common/enum.h"
@@ -339,6 +341,13 @@ private:
 
     DMemHandle CarveDmemArea(PAddr addr, u64 size);
 
+    DMemHandle FindFreeDmemArea(PAddr search_start, u64 size, u64 alignment,
+                                PAddr& mapping_start);
+
+    DMemHandle FindTrackedFreeDmem(PAddr base, size_t bucket_idx);
+
+    void TrackFreeDmem(DMemHandle handle);
+
     FMemHandle CarveFmemArea(PAddr addr, u64 size);
 
     VMAHandle Split(VMAHandle vma_handle, u64 offset_in_vma);
@@ -354,6 +363,9 @@ private:
 private:
     AddressSpace impl;
     DMemMap dmem_map;
+    // Bases of free dmem areas, bucketed by the log2 of their size. Entries are checked against
+    // dmem_map when searched and dropped once the area is no longer free or changed size class.
+    std::array<std::set<PAddr>, 64> free_dmem_buckets;
     FMemMap fmem_map;
     VMAMap vma_map;
     std::mutex mutex;
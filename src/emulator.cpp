@@ -215,6 +215,9 @@ void Emulator::Run(std::filesystem::path file, std::vector<std::string> args,
     LOG_INFO(Config, "GPU shouldDumpShaders: {}", Config::dumpShaders());
     LOG_INFO(Config, "GPU vblankFrequency: {}", Config::vblankFreq());
     LOG_INFO(Config, "GPU shouldCopyGPUBuffers: {}", Config::copyGPUCmdBuffers());
+    LOG_INFO(Config, "GPU asyncComputeQueues: {}", Config::asyncComputeQueues());
+    LOG_INFO(Config, "GPU userfaultfd: {}", Config::userfaultfd());
+    LOG_INFO(Config, "GPU pipelineCompileMode: {}", Config::getPipelineCompileMode());
     LOG_INFO(Config, "Vulkan gpuId: {}", Config::getGpuId());
     LOG_INFO(Config, "Vulkan vkValidation: {}", Config::vkValidationEnabled());
     LOG_INFO(Config, "Vulkan vkValidationCore: {}", Config::vkValidationCoreEnabled());
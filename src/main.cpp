@@ -11,12 +11,16 @@
 #include <fmt/core.h>
 #include "common/config.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/memory_patcher.h"
 #include "common/path_util.h"
 #include "core/debugger.h"
 #include "core/file_sys/fs.h"
 #include "core/ipc/ipc.h"
+#include "core/libraries/ajm/ajm_capture.h"
 #include "emulator.h"
+#include "shader_recompiler/recompiler_corpus.h"
+#include "video_core/amdgpu/pm4_capture.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -68,6 +72,15 @@ int main(int argc, char* argv[]) {
                     "  --config-global               Run the emulator with the base config file "
                     "only, ignores game specific configs.\n"
                     "  --show-fps                    Enable FPS counter display at startup\n"
+                    "  --pm4-capture <file>          Record GPU command buffers to a file\n"
+                    "  --pm4-replay <file>           Replay recorded GPU command buffers "
+                    "without a GPU and exit\n"
+                    "  --ajm-capture <file>          Record audio decoder batches to a file\n"
+                    "  --ajm-replay <file>           Decode recorded audio batches on an "
+                    "increasing number of threads, print throughput and exit\n"
+                    "  --decode-log <file>           Print a binary log file as text and exit\n"
+                    "  --recompile-shaders <folder>  Recompile dumped shaders, print timings "
+                    "and exit\n"
                     "  -h, --help                    Display this help message\n";
              exit(0);
          }},
@@ -183,7 +196,67 @@ int main(int argc, char* argv[]) {
              }
              waitPid = std::stoi(argv[i]);
          }},
-        {"--show-fps", [&](int& i) { Config::setShowFpsCounter(true); }}};
+        {"--show-fps", [&](int& i) { Config::setShowFpsCounter(true); }},
+        {"--pm4-capture",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --pm4-capture\n";
+                 exit(1);
+             }
+             AmdGpu::StartPm4Capture(argv[i]);
+         }},
+        {"--pm4-replay",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --pm4-replay\n";
+                 exit(1);
+             }
+             Common::Log::Initialize();
+             Common::Log::Start();
+             const bool result = AmdGpu::ReplayPm4Capture(argv[i]);
+             Common::Log::Denitializer();
+             exit(result ? 0 : 1);
+         }},
+        {"--ajm-capture",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --ajm-capture\n";
+                 exit(1);
+             }
+             Libraries::Ajm::StartAjmCapture(argv[i]);
+         }},
+        {"--ajm-replay",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --ajm-replay\n";
+                 exit(1);
+             }
+             Common::Log::Initialize();
+             Common::Log::Start();
+             const bool result = Libraries::Ajm::ReplayAjmCapture(argv[i]);
+             Common::Log::Denitializer();
+             exit(result ? 0 : 1);
+         }},
+        {"--decode-log",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --decode-log\n";
+                 exit(1);
+             }
+             exit(Common::Log::DecodeBinaryLog(argv[i]) ? 0 : 1);
+         }},
+        {"--recompile-shaders",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --recompile-shaders\n";
+                 exit(1);
+             }
+             Common::Log::Initialize();
+             Common::Log::Start();
+             const bool result = Shader::RecompileShaderDumps(argv[i]);
+             Common::Log::Denitializer();
+             exit(result ? 0 : 1);
+         }}};
 
     if (argc == 1) {
         if (!SDL_ShowSimpleMessageBox(
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <span>
 #include <vector>
 #include <boost/container/static_vector.hpp>
@@ -120,6 +121,11 @@ struct Info : InfoPersistent {
     std::vector<u32> flattened_ud_buf;
     PersistentSrtInfo srt_info;
 
+    // Guest data read by an earlier translation of the same shader. Set when a dumped shader is
+    // translated again without the game running, so that nothing is read from guest memory.
+    std::span<const u32> recorded_flat_ud_buf;
+    const TessellationDataConstantBuffer* recorded_tess_constants{};
+
     AttributeFlags loads{};
     AttributeFlags stores{};
 
@@ -190,6 +196,12 @@ struct Info : InfoPersistent {
 
     void RefreshFlatBuf() {
         flattened_ud_buf.resize(srt_info.flattened_bufsize_dw);
+        if (!recorded_flat_ud_buf.empty()) {
+            std::memcpy(flattened_ud_buf.data(), recorded_flat_ud_buf.data(),
+                        std::min(recorded_flat_ud_buf.size_bytes(),
+                                 flattened_ud_buf.size() * sizeof(u32)));
+            return;
+        }
         ASSERT(user_data.size() <= NUM_USER_DATA_REGS);
         std::memcpy(flattened_ud_buf.data(), user_data.data(), user_data.size_bytes());
         if (srt_info.walker_func) {
@@ -199,6 +211,10 @@ struct Info : InfoPersistent {
 
     void ReadTessConstantBuffer(TessellationDataConstantBuffer& tess_constants) const {
         ASSERT(tess_consts_dword_offset >= 0); // We've already tracked the V# UD
+        if (recorded_tess_constants) {
+            tess_constants = *recorded_tess_constants;
+            return;
+        }
         auto buf = ReadUdReg<AmdGpu::Buffer>(static_cast<u32>(tess_consts_ptr_base),
                                              static_cast<u32>(tess_consts_dword_offset));
         VAddr tess_constants_addr = buf.base_address;
@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include "common/types.h"
+
+namespace Shader::IR {
+
+/// Cost and effect of one translation pass on a program.
+struct PassStats {
+    const char* name;
+    u64 time_ns;
+    u32 blocks_before;
+    u32 blocks_after;
+    u32 insts_before;
+    u32 insts_after;
+    u32 arena_allocs; ///< Allocations the pass made from the compilation arena
+};
+
+} // namespace Shader::IR
@@ -12,8 +12,8 @@ struct Profile;
 
 namespace Shader::Optimization {
 
-void SsaRewritePass(IR::BlockList& program);
-void IdentityRemovalPass(IR::BlockList& program);
+void SsaRewritePass(IR::BlockList& program, std::pmr::memory_resource* arena);
+void IdentityRemovalPass(IR::BlockList& program, std::pmr::memory_resource* arena);
 void DeadCodeEliminationPass(IR::Program& program);
 void ConstantPropagationPass(IR::BlockList& program);
 void FlattenExtendedUserdataPass(IR::Program& program);
@@ -3,22 +3,29 @@
 
 #pragma once
 
+#include <memory_resource>
 #include <string>
 #include "shader_recompiler/frontend/instruction.h"
 #include "shader_recompiler/info.h"
 #include "shader_recompiler/ir/abstract_syntax_list.h"
 #include "shader_recompiler/ir/basic_block.h"
+#include "shader_recompiler/ir/pass_stats.h"
 
 namespace Shader::IR {
 
 struct Program {
-    explicit Program(Info& info_) : info{info_} {}
+    explicit Program(Info& info_,
+                     std::pmr::memory_resource* arena_ = std::pmr::get_default_resource())
+        : info{info_}, arena{arena_} {}
 
     AbstractSyntaxList syntax_list;
     BlockList blocks;
     BlockList post_order_blocks;
     std::vector<Gcn::GcnInst> ins_list;
+    std::vector<PassStats> pass_stats;
     Info& info;
+    /// Backing memory for temporary containers of the passes, lives until the next compilation.
+    std::pmr::memory_resource* arena;
 };
 
 void DumpProgram(const Program& program, const Info& info, const std::string& type = "");
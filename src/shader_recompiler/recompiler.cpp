@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <optional>
 #include "shader_recompiler/frontend/control_flow_graph.h"
 #include "shader_recompiler/frontend/decode.h"
 #include "shader_recompiler/frontend/structured_control_flow.h"
@@ -41,7 +43,7 @@ IR::Program TranslateProgram(const std::span<const u32>& code, Pools& pools, Inf
     Gcn::GcnDecodeContext decoder;
 
     // Decode and save instructions
-    IR::Program program{info};
+    IR::Program program{info, &pools.arena};
     program.ins_list.reserve(code.size());
     while (!slice.atEnd()) {
         program.ins_list.emplace_back(decoder.decodeInstruction(slice));
@@ -50,42 +52,72 @@ IR::Program TranslateProgram(const std::span<const u32>& code, Pools& pools, Inf
     // Clear any previous pooled data.
     pools.ReleaseContents();
 
-    // Create control flow graph
+    // Records the cost of each pass and how it changed the program.
+    const auto run_pass = [&program, &pools](const char* name, auto&& pass) {
+        const auto num_insts = [&program] {
+            u32 count{};
+            for (const IR::Block* block : program.blocks) {
+                count += static_cast<u32>(block->size());
+            }
+            return count;
+        };
+        auto& stats = program.pass_stats.emplace_back(IR::PassStats{
+            .name = name,
+            .blocks_before = static_cast<u32>(program.blocks.size()),
+            .insts_before = num_insts(),
+        });
+        const u64 num_allocs = pools.arena.NumAllocations();
+        const auto start = std::chrono::steady_clock::now();
+        pass();
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        stats.time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        stats.blocks_after = static_cast<u32>(program.blocks.size());
+        stats.insts_after = num_insts();
+        stats.arena_allocs = static_cast<u32>(pools.arena.NumAllocations() - num_allocs);
+    };
+
+    // Create control flow graph, its blocks are referenced by later passes.
     Common::ObjectPool<Gcn::Block> gcn_block_pool{64};
-    Gcn::CFG cfg{gcn_block_pool, program.ins_list};
+    std::optional<Gcn::CFG> cfg;
 
     // Structurize control flow graph and create program.
-    program.syntax_list =
-        Shader::Gcn::BuildASL(pools.inst_pool, pools.block_pool, cfg, info, runtime_info, profile);
-    program.blocks = GenerateBlocks(program.syntax_list);
-    program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front());
+    run_pass("Structurize", [&] {
+        cfg.emplace(gcn_block_pool, program.ins_list);
+        program.syntax_list = Shader::Gcn::BuildASL(pools.inst_pool, pools.block_pool, *cfg, info,
+                                                    runtime_info, profile);
+        program.blocks = GenerateBlocks(program.syntax_list);
+        program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front());
+    });
 
     // Run optimization passes
+    using namespace Shader::Optimization;
     if (!profile.support_float64) {
-        Shader::Optimization::LowerFp64ToFp32(program);
+        run_pass("LowerFp64ToFp32", [&] { LowerFp64ToFp32(program); });
     }
-    Shader::Optimization::SsaRewritePass(program.post_order_blocks);
-    Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
-    Shader::Optimization::IdentityRemovalPass(program.blocks);
+    run_pass("SsaRewrite", [&] { SsaRewritePass(program.post_order_blocks, program.arena); });
+    run_pass("ConstantPropagation", [&] { ConstantPropagationPass(program.post_order_blocks); });
+    run_pass("IdentityRemoval", [&] { IdentityRemovalPass(program.blocks, program.arena); });
     if (info.l_stage == LogicalStage::TessellationControl) {
-        Shader::Optimization::TessellationPreprocess(program, runtime_info);
-        Shader::Optimization::HullShaderTransform(program, runtime_info);
+        run_pass("TessellationPreprocess", [&] { TessellationPreprocess(program, runtime_info); });
+        run_pass("HullShaderTransform", [&] { HullShaderTransform(program, runtime_info); });
     } else if (info.l_stage == LogicalStage::TessellationEval) {
-        Shader::Optimization::TessellationPreprocess(program, runtime_info);
-        Shader::Optimization::DomainShaderTransform(program, runtime_info);
+        run_pass("TessellationPreprocess", [&] { TessellationPreprocess(program, runtime_info); });
+        run_pass("DomainShaderTransform", [&] { DomainShaderTransform(program, runtime_info); });
     }
-    Shader::Optimization::RingAccessElimination(program, runtime_info);
-    Shader::Optimization::ReadLaneEliminationPass(program);
-    Shader::Optimization::FlattenExtendedUserdataPass(program);
-    Shader::Optimization::ResourceTrackingPass(program);
-    Shader::Optimization::LowerBufferFormatToRaw(program);
-    Shader::Optimization::SharedMemorySimplifyPass(program, profile);
-    Shader::Optimization::SharedMemoryToStoragePass(program, runtime_info, profile);
-    Shader::Optimization::SharedMemoryBarrierPass(program, runtime_info, profile);
-    Shader::Optimization::IdentityRemovalPass(program.blocks);
-    Shader::Optimization::DeadCodeEliminationPass(program);
-    Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
-    Shader::Optimization::CollectShaderInfoPass(program, profile);
+    run_pass("RingAccessElimination", [&] { RingAccessElimination(program, runtime_info); });
+    run_pass("ReadLaneElimination", [&] { ReadLaneEliminationPass(program); });
+    run_pass("FlattenExtendedUserdata", [&] { FlattenExtendedUserdataPass(program); });
+    run_pass("ResourceTracking", [&] { ResourceTrackingPass(program); });
+    run_pass("LowerBufferFormatToRaw", [&] { LowerBufferFormatToRaw(program); });
+    run_pass("SharedMemorySimplify", [&] { SharedMemorySimplifyPass(program, profile); });
+    run_pass("SharedMemoryToStorage",
+             [&] { SharedMemoryToStoragePass(program, runtime_info, profile); });
+    run_pass("SharedMemoryBarrier",
+             [&] { SharedMemoryBarrierPass(program, runtime_info, profile); });
+    run_pass("IdentityRemoval", [&] { IdentityRemovalPass(program.blocks, program.arena); });
+    run_pass("DeadCodeElimination", [&] { DeadCodeEliminationPass(program); });
+    run_pass("ConstantPropagation", [&] { ConstantPropagationPass(program.post_order_blocks); });
+    run_pass("CollectShaderInfo", [&] { CollectShaderInfoPass(program, profile); });
 
     Shader::IR::DumpProgram(program, info);
 
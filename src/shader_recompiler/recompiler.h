@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <memory_resource>
+#include <vector>
 #include "common/object_pool.h"
 #include "shader_recompiler/ir/basic_block.h"
 #include "shader_recompiler/ir/program.h"
@@ -12,18 +14,53 @@ namespace Shader {
 struct Profile;
 struct RuntimeInfo;
 
+/// Forwards to an upstream resource and counts the allocations made through it.
+class CountingResource final : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream_) : upstream{upstream_} {}
+
+    [[nodiscard]] u64 NumAllocations() const noexcept {
+        return num_allocations;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++num_allocations;
+        return upstream->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        upstream->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream;
+    u64 num_allocations{};
+};
+
 struct Pools {
     static constexpr u32 InstPoolSize = 8192;
     static constexpr u32 BlockPoolSize = 32;
+    static constexpr size_t ArenaSize = 512_KB;
 
     Common::ObjectPool<IR::Inst> inst_pool;
     Common::ObjectPool<IR::Block> block_pool;
+    /// Scratch memory of the optimization passes, discarded as a whole between compilations.
+    std::vector<u8> arena_buffer;
+    std::pmr::monotonic_buffer_resource arena_storage;
+    CountingResource arena;
 
-    explicit Pools() : inst_pool{InstPoolSize}, block_pool{BlockPoolSize} {}
+    explicit Pools()
+        : inst_pool{InstPoolSize}, block_pool{BlockPoolSize}, arena_buffer(ArenaSize),
+          arena_storage{arena_buffer.data(), arena_buffer.size()}, arena{&arena_storage} {}
 
     void ReleaseContents() {
         inst_pool.ReleaseContents();
         block_pool.ReleaseContents();
+        arena_storage.release();
     }
 };
 
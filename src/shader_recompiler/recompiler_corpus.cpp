@@ -0,0 +1,388 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/io_file.h"
+#include "common/serdes.h"
+#include "common/thread.h"
+#include "shader_recompiler/backend/spirv/emit_spirv.h"
+#include "shader_recompiler/frontend/decode.h"
+#include "shader_recompiler/frontend/fetch_shader.h"
+#include "shader_recompiler/profile.h"
+#include "shader_recompiler/recompiler.h"
+#include "shader_recompiler/recompiler_corpus.h"
+#include "shader_recompiler/runtime_info.h"
+
+namespace Shader {
+
+static constexpr u32 TranslationInputVersion = 2;
+static constexpr u32 SpirvMagic = 0x07230203;
+static constexpr u32 SpirvHeaderWords = 5;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using UserData = std::array<u32, ShaderParams::NumShaderUserData>;
+
+/// Guest memory a user data register points to, as far as the translation read it.
+struct UserDataTable {
+    u32 sgpr_base{};
+    std::vector<u32> data;
+};
+
+struct TranslationInput {
+    std::filesystem::path path;
+    Stage stage{};
+    LogicalStage l_stage{};
+    u64 pgm_hash{};
+    UserData user_data{};
+    RuntimeInfo runtime_info{};
+    Profile profile{};
+    u32 fetch_sgpr_base{};
+    std::vector<u32> fetch_code;
+    std::vector<u32> vs_copy;
+    std::vector<UserDataTable> tables;
+    std::vector<u32> flat_ud_buf;
+    std::optional<TessellationDataConstantBuffer> tess_constants;
+    std::vector<u32> code;
+};
+
+struct TranslationResult {
+    Clock::duration translate_time{};
+    Clock::duration emit_time{};
+    size_t num_blocks{};
+    size_t num_insts{};
+    size_t num_words{};
+    std::vector<IR::PassStats> pass_stats;
+    bool valid{};
+};
+
+struct PassTotals {
+    std::string_view name;
+    Clock::duration time{};
+    s64 insts_removed{};
+};
+
+std::vector<u32> CopyFetchShader(const Info& info, u32 sgpr_base) {
+    const u32* code = Gcn::GetFetchShaderCode(info, sgpr_base);
+    Gcn::GcnCodeSlice slice(code, code + std::numeric_limits<u32>::max());
+    Gcn::GcnDecodeContext decoder;
+    size_t size{};
+    while (!slice.atEnd()) {
+        const auto inst = decoder.decodeInstruction(slice);
+        size += inst.length;
+        if (inst.opcode == Gcn::Opcode::S_SETPC_B64) {
+            break;
+        }
+    }
+    return std::vector<u32>(code, code + size / sizeof(u32));
+}
+
+/// Copies the first num_dwords of the table user data register sgpr_base points to.
+void RecordTable(std::vector<UserDataTable>& tables, const Info& info, u32 sgpr_base,
+                 u32 num_dwords) {
+    if (sgpr_base + 1 >= ShaderParams::NumShaderUserData) {
+        // The sharp is held in user data itself, which is recorded anyway.
+        return;
+    }
+    auto it = std::ranges::find(tables, sgpr_base, &UserDataTable::sgpr_base);
+    if (it == tables.end()) {
+        it = tables.insert(it, UserDataTable{.sgpr_base = sgpr_base});
+    }
+    for (u32 dword = static_cast<u32>(it->data.size()); dword < num_dwords; ++dword) {
+        it->data.push_back(info.ReadUdReg<u32>(sgpr_base, dword));
+    }
+}
+
+std::vector<u8> ReadFile(const std::filesystem::path& path) {
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Read};
+    if (!file.IsOpen()) {
+        return {};
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.Read(data) != data.size()) {
+        return {};
+    }
+    return data;
+}
+
+std::optional<TranslationInput> LoadTranslationInput(const std::filesystem::path& path) {
+    auto data = ReadFile(path);
+    const auto code_path = std::filesystem::path{path}.replace_extension(".bin");
+    const auto code = ReadFile(code_path);
+    if (data.size() < sizeof(u32) || code.empty() || code.size() % sizeof(u32) != 0) {
+        fmt::print(stderr, "Unable to read shader {}\n", code_path.string());
+        return std::nullopt;
+    }
+
+    Serialization::Archive ar{std::move(data)};
+    Serialization::Reader reader{ar};
+
+    u32 version{};
+    reader.Read(version);
+    if (version != TranslationInputVersion) {
+        fmt::print(stderr, "Translation input {} has unsupported version {}\n", path.string(),
+                   version);
+        return std::nullopt;
+    }
+
+    TranslationInput input{.path = path};
+    reader.Read(input.stage);
+    reader.Read(input.l_stage);
+    reader.Read(input.pgm_hash);
+    reader.Read(input.user_data.data(), sizeof(input.user_data));
+    reader.Read(input.runtime_info);
+    reader.Read(input.profile);
+    reader.Read(input.fetch_sgpr_base);
+    reader.Read(input.fetch_code);
+    reader.Read(input.vs_copy);
+
+    size_t num_tables{};
+    reader.Read(num_tables);
+    input.tables.resize(num_tables);
+    for (auto& table : input.tables) {
+        reader.Read(table.sgpr_base);
+        reader.Read(table.data);
+    }
+    reader.Read(input.flat_ud_buf);
+    bool has_tess_constants{};
+    reader.Read(has_tess_constants);
+    if (has_tess_constants) {
+        reader.Read(input.tess_constants.emplace());
+    }
+
+    input.code.resize(code.size() / sizeof(u32));
+    std::memcpy(input.code.data(), code.data(), code.size());
+    return input;
+}
+
+/// Checks the module header and that the instruction stream is well formed.
+bool IsValidSpirv(std::span<const u32> spv) {
+    if (spv.size() < SpirvHeaderWords || spv[0] != SpirvMagic || spv[3] == 0) {
+        return false;
+    }
+    size_t pos = SpirvHeaderWords;
+    while (pos < spv.size()) {
+        const u32 word_count = spv[pos] >> 16;
+        if (word_count == 0 || pos + word_count > spv.size()) {
+            return false;
+        }
+        pos += word_count;
+    }
+    return true;
+}
+
+TranslationResult Recompile(const TranslationInput& input, Pools& pools) {
+    // Point the guest addresses in user data to the copies that were dumped with the shader.
+    auto user_data = input.user_data;
+    const auto redirect = [&user_data](u32 sgpr_base, const u32* data) {
+        std::memcpy(&user_data[sgpr_base], &data, sizeof(data));
+    };
+    if (!input.fetch_code.empty() && input.fetch_sgpr_base + 1 < user_data.size()) {
+        redirect(input.fetch_sgpr_base, input.fetch_code.data());
+    }
+    for (const auto& table : input.tables) {
+        redirect(table.sgpr_base, table.data.data());
+    }
+
+    const ShaderParams params{.user_data = user_data, .code = input.code, .hash = input.pgm_hash};
+    Info info{input.stage, input.l_stage, params};
+    info.recorded_flat_ud_buf = input.flat_ud_buf;
+    if (input.tess_constants) {
+        info.recorded_tess_constants = &*input.tess_constants;
+    }
+    auto runtime_info = input.runtime_info;
+    if (runtime_info.stage == Stage::Geometry) {
+        runtime_info.gs_info.vs_copy = input.vs_copy;
+    }
+
+    TranslationResult result{};
+    const auto start = Clock::now();
+    const auto program = TranslateProgram(input.code, pools, info, runtime_info, input.profile);
+    const auto translated = Clock::now();
+    Backend::Bindings binding{};
+    const auto spv = Backend::SPIRV::EmitSPIRV(input.profile, runtime_info, program, binding);
+    const auto emitted = Clock::now();
+
+    result.translate_time = translated - start;
+    result.emit_time = emitted - translated;
+    result.num_blocks = program.blocks.size();
+    for (const IR::Block* block : program.blocks) {
+        result.num_insts += block->size();
+    }
+    result.num_words = spv.size();
+    result.pass_stats = program.pass_stats;
+    result.valid = IsValidSpirv(spv);
+    if (program.info.flattened_ud_buf.size() != input.flat_ud_buf.size()) {
+        fmt::print(stderr, "{}: SRT layout differs from the dumped one, sharps may be wrong\n",
+                   input.path.stem().string());
+    }
+    return result;
+}
+
+double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // Anonymous namespace
+
+std::vector<u8> SerializeTranslationInput(const IR::Program& program,
+                                          const RuntimeInfo& runtime_info, const Profile& profile) {
+    const auto& info = program.info;
+
+    UserData user_data{};
+    std::memcpy(user_data.data(), info.user_data.data(),
+                std::min(info.user_data.size_bytes(), sizeof(user_data)));
+
+    u32 fetch_sgpr_base{};
+    std::vector<u32> fetch_code;
+    const auto it =
+        std::ranges::find(program.ins_list, Gcn::Opcode::S_SWAPPC_B64, &Gcn::GcnInst::opcode);
+    if (it != program.ins_list.end()) {
+        fetch_sgpr_base = it->src[0].code;
+        fetch_code = CopyFetchShader(info, fetch_sgpr_base);
+    }
+
+    // Guest memory read by the translation is recorded, as it is not there when recompiling.
+    // Vertex sharps are read through user data, and everything the SRT walker reads ends up in
+    // the flattened user data.
+    std::vector<UserDataTable> tables;
+    if (const auto fetch_data = Gcn::ParseFetchShader(info)) {
+        for (const auto& attrib : fetch_data->attributes) {
+            RecordTable(tables, info, attrib.sgpr_base,
+                        attrib.dword_offset + sizeof(AmdGpu::Buffer) / sizeof(u32));
+        }
+    }
+    std::optional<TessellationDataConstantBuffer> tess_constants;
+    if (info.tess_consts_dword_offset >= 0) {
+        info.ReadTessConstantBuffer(tess_constants.emplace());
+    }
+
+    // The copy shader is referenced from the runtime info and is stored separately.
+    std::vector<u32> vs_copy;
+    if (runtime_info.stage == Stage::Geometry) {
+        const auto& copy_code = runtime_info.gs_info.vs_copy;
+        vs_copy.assign(copy_code.begin(), copy_code.end());
+    }
+
+    Serialization::Archive ar;
+    Serialization::Writer input{ar};
+
+    input.Write(TranslationInputVersion);
+    input.Write(info.stage);
+    input.Write(info.l_stage);
+    input.Write(info.pgm_hash);
+    input.Write(user_data.data(), sizeof(user_data));
+    input.Write(runtime_info);
+    input.Write(profile);
+    input.Write(fetch_sgpr_base);
+    input.Write(fetch_code);
+    input.Write(vs_copy);
+    input.Write(tables.size());
+    for (const auto& table : tables) {
+        input.Write(table.sgpr_base);
+        input.Write(table.data);
+    }
+    input.Write(info.flattened_ud_buf);
+    input.Write(tess_constants.has_value());
+    if (tess_constants) {
+        input.Write(*tess_constants);
+    }
+
+    return ar.TakeOff();
+}
+
+bool RecompileShaderDumps(const std::filesystem::path& dir) {
+    std::error_code ec;
+    std::filesystem::directory_iterator dir_it{dir, ec};
+    if (ec) {
+        fmt::print(stderr, "Unable to open shader dump directory {}\n", dir.string());
+        return false;
+    }
+
+    bool success = true;
+    std::vector<TranslationInput> inputs;
+    for (const auto& entry : dir_it) {
+        if (entry.path().extension() != ".input") {
+            continue;
+        }
+        if (auto input = LoadTranslationInput(entry.path()); input) {
+            inputs.emplace_back(std::move(*input));
+        } else {
+            success = false;
+        }
+    }
+    std::ranges::sort(inputs, {}, &TranslationInput::path);
+
+    const size_t num_workers =
+        std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), inputs.size());
+    std::vector<TranslationResult> results(inputs.size());
+    std::atomic<size_t> next_input{};
+
+    const auto start = Clock::now();
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(num_workers);
+        for (size_t i = 0; i < num_workers; i++) {
+            workers.emplace_back([&] {
+                Common::SetCurrentThreadName("shadPS4:ShaderRecompiler");
+                Pools pools;
+                for (size_t idx = next_input++; idx < inputs.size(); idx = next_input++) {
+                    results[idx] = Recompile(inputs[idx], pools);
+                }
+            });
+        }
+    }
+    const auto elapsed = Clock::now() - start;
+
+    TranslationResult total{};
+    std::vector<PassTotals> pass_totals;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const auto& result = results[i];
+        fmt::print("{:<40} {:>4} blocks {:>7} insts {:>8} words {:>9.3f} ms translate "
+                   "{:>9.3f} ms emit{}\n",
+                   inputs[i].path.stem().string(), result.num_blocks, result.num_insts,
+                   result.num_words, ToMilliseconds(result.translate_time),
+                   ToMilliseconds(result.emit_time), result.valid ? "" : " INVALID");
+        total.translate_time += result.translate_time;
+        total.emit_time += result.emit_time;
+        total.num_insts += result.num_insts;
+        success &= result.valid;
+
+        for (const auto& stats : result.pass_stats) {
+            auto it = std::ranges::find(pass_totals, std::string_view{stats.name},
+                                        &PassTotals::name);
+            if (it == pass_totals.end()) {
+                it = pass_totals.insert(it, PassTotals{.name = stats.name});
+            }
+            it->time += std::chrono::nanoseconds{stats.time_ns};
+            it->insts_removed += s64(stats.insts_before) - s64(stats.insts_after);
+        }
+    }
+
+    for (const auto& pass : pass_totals) {
+        fmt::print("{:<40} {:>9.3f} ms {:>9} insts removed\n", pass.name,
+                   ToMilliseconds(pass.time), pass.insts_removed);
+    }
+
+    const double elapsed_ms = ToMilliseconds(elapsed);
+    fmt::print("{} shaders on {} threads in {:.3f} ms ({:.1f} shaders/s), {} IR insts, "
+               "{:.3f} ms translate, {:.3f} ms emit\n",
+               inputs.size(), num_workers, elapsed_ms,
+               elapsed_ms > 0.0 ? inputs.size() * 1000.0 / elapsed_ms : 0.0, total.num_insts,
+               ToMilliseconds(total.translate_time), ToMilliseconds(total.emit_time));
+    return success;
+}
+
+} // namespace Shader
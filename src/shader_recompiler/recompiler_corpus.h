@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+
+#include "common/types.h"
+
+namespace Shader {
+
+namespace IR {
+struct Program;
+}
+
+struct Profile;
+struct RuntimeInfo;
+
+/**
+ * Serializes what is needed to repeat the translation of a program without the emulator: user
+ * data, runtime info, profile, the fetch and copy shader code and the guest memory the
+ * translation read through user data. The runtime info must be the one passed to
+ * TranslateProgram, as some passes modify it.
+ */
+std::vector<u8> SerializeTranslationInput(const IR::Program& program,
+                                          const RuntimeInfo& runtime_info, const Profile& profile);
+
+/**
+ * Translates and emits every shader dump in the directory that has translation input next to
+ * it, spread over all cores. Prints timings and IR statistics of each shader to stdout.
+ * Returns false if a shader could not be loaded or produced an invalid module.
+ */
+bool RecompileShaderDumps(const std::filesystem::path& dir);
+
+} // namespace Shader
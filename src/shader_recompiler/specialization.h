@@ -5,6 +5,7 @@
 
 #include <bitset>
 
+#include "common/hash.h"
 #include "common/types.h"
 #include "shader_recompiler/backend/bindings.h"
 #include "shader_recompiler/frontend/fetch_shader.h"
@@ -89,6 +90,7 @@ struct StageSpecialization {
     boost::container::small_vector<FMaskSpecialization, 8> fmasks;
     boost::container::small_vector<SamplerSpecialization, 16> samplers;
     Backend::Bindings start{};
+    u64 digest{};
 
     StageSpecialization() = default;
     StageSpecialization(const Info& info_, RuntimeInfo runtime_info_, const Profile& profile_,
@@ -167,6 +169,70 @@ struct StageSpecialization {
                 runtime_info.vs_info.InitFromTessConstants(tess_constants);
             }
         }
+        digest = ComputeDigest();
+    }
+
+    /**
+     * Hashes the fields that operator== always compares, so that equal specializations have
+     * equal digests. Resource bindings are left out, as whether they are compared depends on
+     * the sharps bound by the stored permutation.
+     */
+    [[nodiscard]] u64 ComputeDigest() const {
+        u64 hash = static_cast<u64>(runtime_info.stage);
+        const auto combine = [&hash](u64 value) { hash = HashCombine(hash, value); };
+        const auto mapping = [](const AmdGpu::CompMapping& m) {
+            return u64(m.r) | (u64(m.g) << 8) | (u64(m.b) << 16) | (u64(m.a) << 24);
+        };
+        switch (runtime_info.stage) {
+        case Stage::Vertex: {
+            const auto& vs = runtime_info.vs_info;
+            combine(vs.num_outputs | (u64(vs.clip_disable) << 32));
+            combine(vs.step_rate_0 | (u64(vs.step_rate_1) << 32));
+            break;
+        }
+        case Stage::Fragment: {
+            const auto& fs = runtime_info.fs_info;
+            combine(fs.num_inputs | (u64(fs.mrtz_mask) << 32) |
+                    (u64(fs.dual_source_blending) << 40));
+            for (u32 i = 0; i < fs.num_inputs; i++) {
+                combine(fs.inputs[i].param_index);
+            }
+            for (const auto& cb : fs.color_buffers) {
+                combine(u64(cb.num_format) | (u64(cb.export_format) << 8) |
+                        (mapping(cb.swizzle) << 16));
+            }
+            break;
+        }
+        case Stage::Compute: {
+            const auto& cs = runtime_info.cs_info;
+            combine(cs.workgroup_size[0] | (u64(cs.workgroup_size[1]) << 32));
+            combine(cs.workgroup_size[2]);
+            break;
+        }
+        case Stage::Geometry:
+            combine(runtime_info.gs_info.output_vertices);
+            combine(runtime_info.gs_info.vs_copy_hash);
+            break;
+        default:
+            break;
+        }
+        if (fetch_shader_data) {
+            for (const auto& attrib : fetch_shader_data->attributes) {
+                combine(u64(attrib.semantic) | (u64(attrib.dest_vgpr) << 8) |
+                        (u64(attrib.num_elements) << 16) | (u64(attrib.sgpr_base) << 24) |
+                        (u64(attrib.dword_offset) << 32) | (u64(attrib.instance_data) << 40));
+            }
+            combine(u64(u8(fetch_shader_data->vertex_offset_sgpr)) |
+                    (u64(u8(fetch_shader_data->instance_offset_sgpr)) << 8));
+        }
+        for (const auto& attrib : vs_attribs) {
+            combine(attrib.divisor | (u64(attrib.num_class) << 32) |
+                    (mapping(attrib.dst_select) << 40));
+        }
+        for (const auto& fmask : fmasks) {
+            combine(fmask.width | (u64(fmask.height) << 32));
+        }
+        return hash;
     }
 
     void ForEachSharp(auto& spec_list, auto& desc_list, auto&& func) {
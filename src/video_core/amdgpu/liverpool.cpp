@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <chrono>
 #include <boost/preprocessor/stringize.hpp>
 
 #include "common/assert.h"
@@ -14,6 +16,7 @@
 #include "core/memory.h"
 #include "core/platform.h"
 #include "video_core/amdgpu/liverpool.h"
+#include "video_core/amdgpu/pm4_capture.h"
 #include "video_core/amdgpu/pm4_cmds.h"
 #include "video_core/renderdoc.h"
 #include "video_core/renderer_vulkan/vk_rasterizer.h"
@@ -40,6 +43,17 @@ static const char* acb_task_name[] = NAME_ARRAY(ACB_TASK, MAX_NAMES);
 #define YIELD_GFX() YIELD(dcb_task_name)
 #define YIELD_ASC(id) YIELD(acb_task_name[id])
 
+#define STALL_GFX()                                                                                \
+    do {                                                                                           \
+        ++mapped_queues[GfxQueueId].num_stalls;                                                    \
+        YIELD_GFX();                                                                               \
+    } while (0)
+#define STALL_ASC(id)                                                                              \
+    do {                                                                                           \
+        ++mapped_queues[id + 1].num_stalls;                                                        \
+        YIELD_ASC(id);                                                                             \
+    } while (0)
+
 #define RESUME(task, name)                                                                         \
     FIBER_EXIT;                                                                                    \
     task.handle.resume();                                                                          \
@@ -65,14 +79,39 @@ static std::span<const u32> NextPacket(std::span<const u32> span, size_t offset)
     return span.subspan(offset);
 }
 
+static void WriteFenceMemory(void* address, u64 data, u32 num_bytes) {
+    // There is no guest memory manager when a capture is replayed, and creating one would
+    // reserve the address space over the pages the replayer mapped.
+    if (IsPm4Replaying() || !Core::Memory::Instance()->TryWriteBacking(address, &data, num_bytes)) {
+        memcpy(address, &data, num_bytes);
+    }
+}
+
 Liverpool::Liverpool() {
     num_counter_pairs = Libraries::Kernel::sceKernelIsNeoMode() ? 16 : 8;
+    async_compute = Config::asyncComputeQueues();
     process_thread = std::jthread{std::bind_front(&Liverpool::Process, this)};
 }
 
 Liverpool::~Liverpool() {
+    // ASC workers may be waiting on the GPU thread to record their work, stop them first.
+    for (auto& queue : mapped_queues) {
+        if (queue.worker.joinable()) {
+            queue.worker.request_stop();
+            queue.worker.join();
+        }
+    }
     process_thread.request_stop();
     process_thread.join();
+
+    for (u32 qid = 0; qid < NumTotalQueues; ++qid) {
+        const auto stats = GetQueueStats(qid);
+        if (stats.num_submits == 0) {
+            continue;
+        }
+        LOG_INFO(Render, "Queue {}: {} submits, busy {} ms, {} stalls", qid, stats.num_submits,
+                 stats.busy_ns / 1'000'000, stats.num_stalls);
+    }
 }
 
 void Liverpool::ProcessCommands() {
@@ -110,7 +149,9 @@ void Liverpool::Process(std::stop_token stoken) {
         while (num_submits || num_commands) {
             ProcessCommands();
 
-            curr_qid = (curr_qid + 1) % num_mapped_queues;
+            // With async compute the ASC queues are run by their own workers, only GFX is left.
+            const u32 num_queues = async_compute ? 1u : num_mapped_queues;
+            curr_qid = (curr_qid + 1) % num_queues;
 
             auto& queue = mapped_queues[curr_qid];
 
@@ -122,13 +163,18 @@ void Liverpool::Process(std::stop_token stoken) {
                 }
                 task = queue.submits.front();
             }
+            const auto start = std::chrono::steady_clock::now();
             task.resume();
+            queue.busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
 
             if (task.done()) {
                 task.destroy();
 
                 std::scoped_lock lock{queue.m_access};
                 queue.submits.pop();
+                ++queue.num_processed;
 
                 --num_submits;
                 std::scoped_lock lock2{submit_mutex};
@@ -145,7 +191,71 @@ void Liverpool::Process(std::stop_token stoken) {
             submit_done = false;
         }
 
-        Platform::IrqC::Instance()->Signal(Platform::InterruptId::GpuIdle);
+        if (num_async_submits == 0) {
+            Platform::IrqC::Instance()->Signal(Platform::InterruptId::GpuIdle);
+        }
+    }
+}
+
+void Liverpool::ProcessAscQueue(u32 qid, std::stop_token stoken) {
+    const auto thread_name = fmt::format("shadPS4:GpuAscQueue{}", qid - 1);
+    Common::SetCurrentThreadName(thread_name.c_str());
+
+    // Host writes to the memory a stalled queue waits on are not signaled, so they are polled
+    // for with an interval that grows for as long as the stall lasts.
+    static constexpr auto MinStallTimeout = std::chrono::microseconds{50};
+    static constexpr auto MaxStallTimeout = std::chrono::microseconds{2000};
+    std::chrono::microseconds stall_timeout = MinStallTimeout;
+
+    auto& queue = mapped_queues[qid];
+    while (!stoken.stop_requested()) {
+        Task::Handle task{};
+        {
+            std::unique_lock lock{queue.m_access};
+            Common::CondvarWait(queue.submit_cv, lock, stoken,
+                                [&queue] { return !queue.submits.empty(); });
+            if (stoken.stop_requested()) {
+                break;
+            }
+            task = queue.submits.front();
+        }
+
+        const u64 write_epoch = queue_write_epoch.load(std::memory_order_acquire);
+        const auto start = std::chrono::steady_clock::now();
+        task.resume();
+        queue.busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+        if (!task.done()) {
+            // The queue is waiting on memory written by another queue or the host. Sleep until
+            // another queue writes memory, or the poll interval for host writes expires.
+            std::unique_lock lock{queue_write_mutex};
+            const bool written = queue_write_cv.wait_for(lock, stall_timeout, [&] {
+                return queue_write_epoch.load(std::memory_order_acquire) != write_epoch;
+            });
+            stall_timeout =
+                written ? MinStallTimeout : std::min(stall_timeout * 2, MaxStallTimeout);
+            continue;
+        }
+        stall_timeout = MinStallTimeout;
+
+        task.destroy();
+        {
+            std::scoped_lock lock{queue.m_access};
+            queue.submits.pop();
+        }
+        ++queue.num_processed;
+
+        bool is_idle{};
+        {
+            std::scoped_lock lk{submit_mutex};
+            is_idle = --num_async_submits == 0 && num_submits == 0;
+            submit_cv.notify_all();
+        }
+        if (is_idle) {
+            Platform::IrqC::Instance()->Signal(Platform::InterruptId::GpuIdle);
+        }
     }
 }
 
@@ -621,12 +731,8 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::EventWriteEos: {
                 const auto* event_eos = reinterpret_cast<const PM4CmdEventWriteEos*>(header);
-                event_eos->SignalFence([](void* address, u64 data, u32 num_bytes) {
-                    auto* memory = Core::Memory::Instance();
-                    if (!memory->TryWriteBacking(address, &data, num_bytes)) {
-                        memcpy(address, &data, num_bytes);
-                    }
-                });
+                event_eos->SignalFence(WriteFenceMemory);
+                NotifyQueueWrite();
                 if (event_eos->command == PM4CmdEventWriteEos::Command::GdsStore) {
                     ASSERT(event_eos->size == 1);
                     if (rasterizer) {
@@ -639,14 +745,10 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::EventWriteEop: {
                 const auto* event_eop = reinterpret_cast<const PM4CmdEventWriteEop*>(header);
-                event_eop->SignalFence(
-                    [](void* address, u64 data, u32 num_bytes) {
-                        auto* memory = Core::Memory::Instance();
-                        if (!memory->TryWriteBacking(address, &data, num_bytes)) {
-                            memcpy(address, &data, num_bytes);
-                        }
-                    },
-                    [] { Platform::IrqC::Instance()->Signal(Platform::InterruptId::GfxEop); });
+                event_eop->SignalFence(WriteFenceMemory, [] {
+                    Platform::IrqC::Instance()->Signal(Platform::InterruptId::GfxEop);
+                });
+                NotifyQueueWrite();
                 break;
             }
             case PM4ItOpcode::DmaData: {
@@ -695,6 +797,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 } else {
                     UNREACHABLE();
                 }
+                NotifyQueueWrite();
                 break;
             }
             case PM4ItOpcode::CopyData: {
@@ -711,9 +814,10 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 const auto* mem_semaphore = reinterpret_cast<const PM4CmdMemSemaphore*>(header);
                 if (mem_semaphore->IsSignaling()) {
                     mem_semaphore->Signal();
+                    NotifyQueueWrite();
                 } else {
                     while (!mem_semaphore->Signaled()) {
-                        YIELD_GFX();
+                        STALL_GFX();
                     }
                     mem_semaphore->Decrement();
                 }
@@ -729,7 +833,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 }
                 const PM4CmdRewind* rewind = reinterpret_cast<const PM4CmdRewind*>(header);
                 while (!rewind->Valid()) {
-                    YIELD_GFX();
+                    STALL_GFX();
                 }
                 break;
             }
@@ -741,13 +845,13 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 // there are no other submits to yield to we can sleep the thread
                 // instead and allow other tasks to run.
                 const u64* wait_addr = wait_reg_mem->Address<u64*>();
-                if (vo_port->IsVoLabel(wait_addr) &&
+                if (vo_port && vo_port->IsVoLabel(wait_addr) && num_async_submits == 0 &&
                     num_submits == mapped_queues[GfxQueueId].submits.size()) {
                     vo_port->WaitVoLabel([&] { return wait_reg_mem->Test(regs.reg_array); });
                     break;
                 }
                 while (!wait_reg_mem->Test(regs.reg_array)) {
-                    YIELD_GFX();
+                    STALL_GFX();
                 }
                 break;
             }
@@ -832,7 +936,9 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
 
     auto base_addr = reinterpret_cast<VAddr>(acb.data());
     while (!acb.empty()) {
-        ProcessCommands();
+        if (!async_compute) {
+            ProcessCommands();
+        }
 
         auto* header = reinterpret_cast<const PM4Header*>(acb.data());
         u32 next_dw_off = header->type3.NumWords() + 1;
@@ -897,34 +1003,39 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
             if (dma_data->dst_addr_lo == 0x3022C || !rasterizer) {
                 break;
             }
-            if (dma_data->src_sel == DmaDataSrc::Data && dma_data->dst_sel == DmaDataDst::Gds) {
-                rasterizer->FillBuffer(dma_data->dst_addr_lo, dma_data->NumBytes(), dma_data->data,
-                                       true);
-            } else if ((dma_data->src_sel == DmaDataSrc::Memory ||
-                        dma_data->src_sel == DmaDataSrc::MemoryUsingL2) &&
-                       dma_data->dst_sel == DmaDataDst::Gds) {
-                rasterizer->CopyBuffer(dma_data->dst_addr_lo, dma_data->SrcAddress<VAddr>(),
-                                       dma_data->NumBytes(), true, false);
-            } else if (dma_data->src_sel == DmaDataSrc::Data &&
-                       (dma_data->dst_sel == DmaDataDst::Memory ||
-                        dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                rasterizer->FillBuffer(dma_data->DstAddress<VAddr>(), dma_data->NumBytes(),
-                                       dma_data->data, false);
-            } else if (dma_data->src_sel == DmaDataSrc::Gds &&
-                       (dma_data->dst_sel == DmaDataDst::Memory ||
-                        dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                rasterizer->CopyBuffer(dma_data->DstAddress<VAddr>(), dma_data->src_addr_lo,
-                                       dma_data->NumBytes(), false, true);
-            } else if ((dma_data->src_sel == DmaDataSrc::Memory ||
-                        dma_data->src_sel == DmaDataSrc::MemoryUsingL2) &&
-                       (dma_data->dst_sel == DmaDataDst::Memory ||
-                        dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
-                rasterizer->CopyBuffer(dma_data->DstAddress<VAddr>(), dma_data->SrcAddress<VAddr>(),
-                                       dma_data->NumBytes(), false, false);
-            } else {
-                UNREACHABLE_MSG("WriteData src_sel = {}, dst_sel = {}",
-                                u32(dma_data->src_sel.Value()), u32(dma_data->dst_sel.Value()));
-            }
+            SubmitAscCommand(vqid, [&] {
+                if (dma_data->src_sel == DmaDataSrc::Data &&
+                    dma_data->dst_sel == DmaDataDst::Gds) {
+                    rasterizer->FillBuffer(dma_data->dst_addr_lo, dma_data->NumBytes(),
+                                           dma_data->data, true);
+                } else if ((dma_data->src_sel == DmaDataSrc::Memory ||
+                            dma_data->src_sel == DmaDataSrc::MemoryUsingL2) &&
+                           dma_data->dst_sel == DmaDataDst::Gds) {
+                    rasterizer->CopyBuffer(dma_data->dst_addr_lo, dma_data->SrcAddress<VAddr>(),
+                                           dma_data->NumBytes(), true, false);
+                } else if (dma_data->src_sel == DmaDataSrc::Data &&
+                           (dma_data->dst_sel == DmaDataDst::Memory ||
+                            dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
+                    rasterizer->FillBuffer(dma_data->DstAddress<VAddr>(), dma_data->NumBytes(),
+                                           dma_data->data, false);
+                } else if (dma_data->src_sel == DmaDataSrc::Gds &&
+                           (dma_data->dst_sel == DmaDataDst::Memory ||
+                            dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
+                    rasterizer->CopyBuffer(dma_data->DstAddress<VAddr>(), dma_data->src_addr_lo,
+                                           dma_data->NumBytes(), false, true);
+                } else if ((dma_data->src_sel == DmaDataSrc::Memory ||
+                            dma_data->src_sel == DmaDataSrc::MemoryUsingL2) &&
+                           (dma_data->dst_sel == DmaDataDst::Memory ||
+                            dma_data->dst_sel == DmaDataDst::MemoryUsingL2)) {
+                    rasterizer->CopyBuffer(dma_data->DstAddress<VAddr>(),
+                                           dma_data->SrcAddress<VAddr>(), dma_data->NumBytes(),
+                                           false, false);
+                } else {
+                    UNREACHABLE_MSG("WriteData src_sel = {}, dst_sel = {}",
+                                    u32(dma_data->src_sel.Value()),
+                                    u32(dma_data->dst_sel.Value()));
+                }
+            });
             break;
         }
         case PM4ItOpcode::AcquireMem: {
@@ -936,7 +1047,7 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
             }
             const PM4CmdRewind* rewind = reinterpret_cast<const PM4CmdRewind*>(header);
             while (!rewind->Valid()) {
-                YIELD_ASC(vqid);
+                STALL_ASC(vqid);
             }
             break;
         }
@@ -951,8 +1062,11 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
                              (set_data->reg_offset - 0x200);
                 std::memcpy(addr, header + 2, set_size);
             } else {
-                std::memcpy(&regs.reg_array[Regs::ShRegWordOffset + set_data->reg_offset],
-                            header + 2, set_size);
+                // Persistent registers are shared with the graphics queue.
+                SubmitAscCommand(vqid, [&] {
+                    std::memcpy(&regs.reg_array[Regs::ShRegWordOffset + set_data->reg_offset],
+                                header + 2, set_size);
+                });
             }
             break;
         }
@@ -964,41 +1078,45 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
         }
         case PM4ItOpcode::DispatchDirect: {
             const auto* dispatch_direct = reinterpret_cast<const PM4CmdDispatchDirect*>(header);
-            auto& cs_program = GetCsRegs();
+            auto& cs_program = mapped_queues[vqid + 1].cs_state;
             cs_program.dim_x = dispatch_direct->dim_x;
             cs_program.dim_y = dispatch_direct->dim_y;
             cs_program.dim_z = dispatch_direct->dim_z;
             cs_program.dispatch_initiator = dispatch_direct->dispatch_initiator;
-            if (DebugState.DumpingCurrentReg()) {
-                DebugState.PushRegsDumpCompute(base_addr, reinterpret_cast<uintptr_t>(header),
-                                               cs_program);
-            }
-            if (rasterizer && (cs_program.dispatch_initiator & 1)) {
-                const auto cmd_address = reinterpret_cast<const void*>(header);
-                rasterizer->ScopeMarkerBegin(
-                    fmt::format("asc[{}]:{}:DispatchDirect", vqid, cmd_address));
-                rasterizer->DispatchDirect();
-                rasterizer->ScopeMarkerEnd();
-            }
+            SubmitAscCommand(vqid, [&] {
+                if (DebugState.DumpingCurrentReg()) {
+                    DebugState.PushRegsDumpCompute(base_addr, reinterpret_cast<uintptr_t>(header),
+                                                   cs_program);
+                }
+                if (rasterizer && (cs_program.dispatch_initiator & 1)) {
+                    const auto cmd_address = reinterpret_cast<const void*>(header);
+                    rasterizer->ScopeMarkerBegin(
+                        fmt::format("asc[{}]:{}:DispatchDirect", vqid, cmd_address));
+                    rasterizer->DispatchDirect();
+                    rasterizer->ScopeMarkerEnd();
+                }
+            });
             break;
         }
         case PM4ItOpcode::DispatchIndirect: {
             const auto* dispatch_indirect =
                 reinterpret_cast<const PM4CmdDispatchIndirectMec*>(header);
-            auto& cs_program = GetCsRegs();
+            const auto& cs_program = mapped_queues[vqid + 1].cs_state;
             const auto ib_address = dispatch_indirect->Address<VAddr>();
             const auto size = sizeof(PM4CmdDispatchIndirect::GroupDimensions);
-            if (DebugState.DumpingCurrentReg()) {
-                DebugState.PushRegsDumpCompute(base_addr, reinterpret_cast<uintptr_t>(header),
-                                               cs_program);
-            }
-            if (rasterizer && (cs_program.dispatch_initiator & 1)) {
-                const auto cmd_address = reinterpret_cast<const void*>(header);
-                rasterizer->ScopeMarkerBegin(
-                    fmt::format("asc[{}]:{}:DispatchIndirect", vqid, cmd_address));
-                rasterizer->DispatchIndirect(ib_address, 0, size);
-                rasterizer->ScopeMarkerEnd();
-            }
+            SubmitAscCommand(vqid, [&] {
+                if (DebugState.DumpingCurrentReg()) {
+                    DebugState.PushRegsDumpCompute(base_addr, reinterpret_cast<uintptr_t>(header),
+                                                   cs_program);
+                }
+                if (rasterizer && (cs_program.dispatch_initiator & 1)) {
+                    const auto cmd_address = reinterpret_cast<const void*>(header);
+                    rasterizer->ScopeMarkerBegin(
+                        fmt::format("asc[{}]:{}:DispatchIndirect", vqid, cmd_address));
+                    rasterizer->DispatchIndirect(ib_address, 0, size);
+                    rasterizer->ScopeMarkerEnd();
+                }
+            });
             break;
         }
         case PM4ItOpcode::WriteData: {
@@ -1010,15 +1128,17 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
             } else {
                 UNREACHABLE();
             }
+            NotifyQueueWrite();
             break;
         }
         case PM4ItOpcode::MemSemaphore: {
             const auto* mem_semaphore = reinterpret_cast<const PM4CmdMemSemaphore*>(header);
             if (mem_semaphore->IsSignaling()) {
                 mem_semaphore->Signal();
+                NotifyQueueWrite();
             } else {
                 while (!mem_semaphore->Signaled()) {
-                    YIELD_ASC(vqid);
+                    STALL_ASC(vqid);
                 }
                 mem_semaphore->Decrement();
             }
@@ -1028,15 +1148,19 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
             const auto* wait_reg_mem = reinterpret_cast<const PM4CmdWaitRegMem*>(header);
             ASSERT(wait_reg_mem->engine.Value() == PM4CmdWaitRegMem::Engine::Me);
             while (!wait_reg_mem->Test(regs.reg_array)) {
-                YIELD_ASC(vqid);
+                STALL_ASC(vqid);
             }
+            // Pairs with the release fence of the signaling queue when queues run on workers.
+            std::atomic_thread_fence(std::memory_order_acquire);
             break;
         }
         case PM4ItOpcode::ReleaseMem: {
             const auto* release_mem = reinterpret_cast<const PM4CmdReleaseMem*>(header);
+            std::atomic_thread_fence(std::memory_order_release);
             release_mem->SignalFence([pipe_id = queue.pipe_id] {
                 Platform::IrqC::Instance()->Signal(static_cast<Platform::InterruptId>(pipe_id));
             });
+            NotifyQueueWrite();
             break;
         }
         case PM4ItOpcode::EventWrite: {
@@ -1059,6 +1183,18 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, u32 vqid) {
     FIBER_EXIT;
 }
 
+void Liverpool::NotifyQueueWrite() {
+    if (!async_compute) {
+        // All queues are processed on the same thread, there is no one to wake.
+        return;
+    }
+    {
+        std::scoped_lock lock{queue_write_mutex};
+        queue_write_epoch.fetch_add(1, std::memory_order_release);
+    }
+    queue_write_cv.notify_all();
+}
+
 Liverpool::CmdBuffer Liverpool::CopyCmdBuffers(std::span<const u32> dcb, std::span<const u32> ccb) {
     auto& queue = mapped_queues[GfxQueueId];
     ASSERT_MSG(queue.dcb_buffer.capacity() >= queue.dcb_buffer_offset + dcb.size(),
@@ -1095,6 +1231,10 @@ Liverpool::CmdBuffer Liverpool::CopyCmdBuffers(std::span<const u32> dcb, std::sp
 void Liverpool::SubmitGfx(std::span<const u32> dcb, std::span<const u32> ccb) {
     auto& queue = mapped_queues[GfxQueueId];
 
+    if (IsPm4Capturing()) {
+        CapturePm4Gfx(dcb, ccb);
+    }
+
     if (Config::copyGPUCmdBuffers()) {
         std::tie(dcb, ccb) = CopyCmdBuffers(dcb, ccb);
     }
@@ -1115,7 +1255,26 @@ void Liverpool::SubmitAsc(u32 gnm_vqid, std::span<const u32> acb) {
     auto& queue = mapped_queues[gnm_vqid];
 
     const auto vqid = gnm_vqid - 1;
+    if (IsPm4Capturing()) {
+        CapturePm4Asc(gnm_vqid, asc_queues[{vqid}].pipe_id, acb);
+    }
+
     const auto& task = ProcessCompute(acb, vqid);
+    if (async_compute) {
+        {
+            std::scoped_lock lk{submit_mutex};
+            ++num_async_submits;
+        }
+        std::scoped_lock lock{queue.m_access};
+        if (!queue.worker.joinable()) {
+            queue.worker =
+                std::jthread{std::bind_front(&Liverpool::ProcessAscQueue, this, gnm_vqid)};
+        }
+        queue.submits.emplace(task.handle);
+        queue.submit_cv.notify_one();
+        return;
+    }
+
     {
         std::scoped_lock lock{queue.m_access};
         queue.submits.emplace(task.handle);
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
 #include <coroutine>
 #include <exception>
@@ -10,6 +11,7 @@
 #include <semaphore>
 #include <span>
 #include <thread>
+#include <utility>
 #include <vector>
 #include <queue>
 
@@ -80,11 +82,22 @@ public:
 
     void WaitGpuIdle() noexcept {
         std::unique_lock lk{submit_mutex};
-        submit_cv.wait(lk, [this] { return num_submits == 0; });
+        submit_cv.wait(lk, [this] { return num_submits == 0 && num_async_submits == 0; });
     }
 
     bool IsGpuIdle() const {
-        return num_submits == 0;
+        return num_submits == 0 && num_async_submits == 0;
+    }
+
+    struct QueueStats {
+        u64 busy_ns;     ///< Time spent processing packets of the queue
+        u64 num_stalls;  ///< Number of times the queue yielded on an unsignaled wait packet
+        u64 num_submits; ///< Number of completed submissions
+    };
+
+    QueueStats GetQueueStats(u32 qid) const {
+        const auto& queue = mapped_queues[qid];
+        return {queue.busy_ns, queue.num_stalls, queue.num_processed};
     }
 
     void SetVoPort(Libraries::VideoOut::VideoOutPort* port) {
@@ -183,8 +196,22 @@ private:
     template <bool is_indirect = false>
     Task ProcessCompute(std::span<const u32> acb, u32 vqid);
 
+    /// Runs rasterizer work of an ASC queue on the GPU thread with its compute state bound.
+    template <typename Func>
+    void SubmitAscCommand(u32 vqid, Func&& func) {
+        SendCommand<true>([this, vqid, &func] {
+            const s32 prev_qid = std::exchange(curr_qid, static_cast<s32>(vqid + 1));
+            func();
+            curr_qid = prev_qid;
+        });
+    }
+
     void ProcessCommands();
     void Process(std::stop_token stoken);
+    void ProcessAscQueue(u32 qid, std::stop_token stoken);
+
+    /// Wakes async compute workers stalled on memory another queue may have just written.
+    void NotifyQueueWrite();
 
     struct GpuQueue {
         std::mutex m_access{};
@@ -194,6 +221,11 @@ private:
         std::vector<u32> ccb_buffer;
         std::queue<Task::Handle> submits{};
         ComputeProgram cs_state{};
+        std::jthread worker{};
+        std::condition_variable_any submit_cv;
+        std::atomic<u64> busy_ns{};
+        std::atomic<u64> num_stalls{};
+        std::atomic<u64> num_processed{};
     };
     std::array<GpuQueue, NumTotalQueues> mapped_queues{};
     u32 num_mapped_queues{1u}; // GFX is always available
@@ -224,13 +256,18 @@ private:
     Libraries::VideoOut::VideoOutPort* vo_port{};
     std::jthread process_thread{};
     std::atomic<u32> num_submits{};
+    std::atomic<u32> num_async_submits{};
     std::atomic<u32> num_commands{};
     std::atomic<bool> submit_done{};
     std::mutex submit_mutex;
     std::condition_variable_any submit_cv;
+    std::mutex queue_write_mutex;
+    std::condition_variable queue_write_cv;
+    std::atomic<u64> queue_write_epoch{};
     std::queue<Common::UniqueFunction<void>> command_queue{};
     std::thread::id gpu_id;
     s32 curr_qid{-1};
+    bool async_compute{};
 };
 
 } // namespace AmdGpu
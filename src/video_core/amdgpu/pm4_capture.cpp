@@ -0,0 +1,441 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/io_file.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "video_core/amdgpu/liverpool.h"
+#include "video_core/amdgpu/pm4_capture.h"
+#include "video_core/amdgpu/pm4_cmds.h"
+
+namespace AmdGpu {
+
+namespace {
+
+using namespace Common::FS;
+
+constexpr u32 CaptureMagic = 0x43344D50; // PM4C
+constexpr u32 CaptureVersion = 1;
+constexpr u32 MaxIndirectDepth = 4;
+constexpr u64 ReplayPageSize = 64_KB;
+
+enum class RecordType : u32 {
+    Memory = 0,
+    Gfx = 1,
+    Asc = 2,
+};
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+};
+
+/// Every record is followed by its payload. Memory records carry the bytes of a guest range,
+/// submissions carry the dcb and ccb (or acb) dwords back to back.
+struct RecordHeader {
+    RecordType type;
+    u32 queue;   ///< Gnm virtual queue id of Asc records
+    u32 size0;   ///< Byte size of Memory records, dcb or acb dword count of submissions
+    u32 size1;   ///< ccb dword count of Gfx records, pipe id of Asc records
+    u64 address; ///< Guest address of Memory records
+};
+static_assert(sizeof(RecordHeader) == 24);
+
+u64 PayloadSize(const RecordHeader& record) {
+    switch (record.type) {
+    case RecordType::Memory:
+        return record.size0;
+    case RecordType::Gfx:
+        return (u64(record.size0) + record.size1) * sizeof(u32);
+    case RecordType::Asc:
+        return u64(record.size0) * sizeof(u32);
+    default:
+        return std::numeric_limits<u64>::max();
+    }
+}
+
+/// Returns a value for the polled dword that passes the wait, keeping the unmasked bits.
+u32 SatisfyWait(const PM4CmdWaitRegMem& wait, u32 value) {
+    u32 target = wait.ref;
+    switch (wait.function.Value()) {
+    case PM4CmdWaitRegMem::Function::LessThan:
+        target = wait.ref - 1;
+        break;
+    case PM4CmdWaitRegMem::Function::NotEqual:
+        target = ~wait.ref;
+        break;
+    case PM4CmdWaitRegMem::Function::GreaterThan:
+        target = wait.ref + 1;
+        break;
+    default:
+        break;
+    }
+    return (value & ~wait.mask) | (target & wait.mask);
+}
+
+class Recorder {
+public:
+    explicit Recorder(const std::filesystem::path& path) : file{path, FileAccessMode::Write} {
+        file.WriteObject(FileHeader{CaptureMagic, CaptureVersion});
+    }
+
+    bool IsOpen() const {
+        return file.IsOpen();
+    }
+
+    void RecordGfx(std::span<const u32> dcb, std::span<const u32> ccb) {
+        std::scoped_lock lk{mutex};
+        Walk(dcb, 0);
+        Walk(ccb, 0);
+        FlushRanges();
+        file.WriteObject(RecordHeader{RecordType::Gfx, 0, static_cast<u32>(dcb.size()),
+                                      static_cast<u32>(ccb.size()), 0});
+        file.WriteSpan(dcb);
+        file.WriteSpan(ccb);
+    }
+
+    void RecordAsc(u32 gnm_vqid, u32 pipe_id, std::span<const u32> acb) {
+        std::scoped_lock lk{mutex};
+        Walk(acb, 0);
+        FlushRanges();
+        file.WriteObject(
+            RecordHeader{RecordType::Asc, gnm_vqid, static_cast<u32>(acb.size()), pipe_id, 0});
+        file.WriteSpan(acb);
+    }
+
+private:
+    struct GuestRange {
+        VAddr address;
+        std::vector<u8> data;
+    };
+
+    GuestRange* AddRange(const void* address, size_t size) {
+        if (!address || size == 0) {
+            return nullptr;
+        }
+        const auto* bytes = static_cast<const u8*>(address);
+        return &ranges.emplace_back(reinterpret_cast<VAddr>(address),
+                                    std::vector<u8>(bytes, bytes + size));
+    }
+
+    /// Collects the guest memory a command buffer reads or writes. Waits are recorded with a
+    /// value that satisfies them, so a replay does not depend on work done by the host.
+    void Walk(std::span<const u32> cmds, u32 depth) {
+        while (!cmds.empty()) {
+            const auto* header = reinterpret_cast<const PM4Header*>(cmds.data());
+            if (header->type == 2) {
+                cmds = cmds.subspan(1);
+                continue;
+            }
+            const u32 num_words = header->type3.NumWords() + 1;
+            if (header->type != 3 || num_words > cmds.size()) {
+                // Either not parseable or split across the ring boundary.
+                return;
+            }
+
+            const PM4ItOpcode opcode = header->type3.opcode;
+            switch (opcode) {
+            case PM4ItOpcode::IndirectBuffer:
+            case PM4ItOpcode::IndirectBufferConst: {
+                const auto* indirect_buffer = reinterpret_cast<const PM4CmdIndirectBuffer*>(header);
+                const std::span<const u32> ib{indirect_buffer->Address<const u32>(),
+                                              indirect_buffer->ib_size};
+                AddRange(ib.data(), ib.size_bytes());
+                if (depth < MaxIndirectDepth) {
+                    Walk(ib, depth + 1);
+                }
+                break;
+            }
+            case PM4ItOpcode::WaitRegMem: {
+                const auto* wait_reg_mem = reinterpret_cast<const PM4CmdWaitRegMem*>(header);
+                if (wait_reg_mem->mem_space.Value() != PM4CmdWaitRegMem::MemSpace::Memory) {
+                    break;
+                }
+                auto* range = AddRange(wait_reg_mem->Address(), sizeof(u32));
+                if (range && !wait_reg_mem->Test({})) {
+                    u32 value;
+                    std::memcpy(&value, range->data.data(), sizeof(value));
+                    value = SatisfyWait(*wait_reg_mem, value);
+                    std::memcpy(range->data.data(), &value, sizeof(value));
+                }
+                break;
+            }
+            case PM4ItOpcode::MemSemaphore: {
+                const auto* mem_semaphore = reinterpret_cast<const PM4CmdMemSemaphore*>(header);
+                auto* range = AddRange(mem_semaphore->Address<u64*>(), sizeof(u64));
+                if (range && !mem_semaphore->IsSignaling() && !mem_semaphore->Signaled()) {
+                    const u64 value = 1;
+                    std::memcpy(range->data.data(), &value, sizeof(value));
+                }
+                break;
+            }
+            case PM4ItOpcode::CondExec: {
+                const auto* cond_exec = reinterpret_cast<const PM4CmdCondExec*>(header);
+                AddRange(cond_exec->Address(), sizeof(bool));
+                break;
+            }
+            case PM4ItOpcode::WriteData: {
+                const auto* write_data = reinterpret_cast<const PM4CmdWriteData*>(header);
+                AddRange(write_data->Address<u8*>(), write_data->Size());
+                break;
+            }
+            case PM4ItOpcode::DumpConstRam: {
+                const auto* dump_const = reinterpret_cast<const PM4DumpConstRam*>(header);
+                AddRange(dump_const->Address<u8*>(), dump_const->Size());
+                break;
+            }
+            case PM4ItOpcode::ReleaseMem: {
+                const auto* release_mem = reinterpret_cast<const PM4CmdReleaseMem*>(header);
+                AddRange(release_mem->Address<u8>(), sizeof(u64));
+                break;
+            }
+            case PM4ItOpcode::EventWriteEop: {
+                const auto* event_eop = reinterpret_cast<const PM4CmdEventWriteEop*>(header);
+                AddRange(event_eop->Address<u8>(), sizeof(u64));
+                break;
+            }
+            case PM4ItOpcode::EventWriteEos: {
+                const auto* event_eos = reinterpret_cast<const PM4CmdEventWriteEos*>(header);
+                AddRange(event_eos->Address<u8*>(), sizeof(u32));
+                break;
+            }
+            case PM4ItOpcode::EventWrite: {
+                const auto* event = reinterpret_cast<const PM4CmdEventWrite*>(header);
+                if (event->event_index.Value() == EventIndex::ZpassDone &&
+                    event->event_type.Value() == EventType::PixelPipeStatDump) {
+                    // Occlusion results of up to 16 counter pairs.
+                    AddRange(event->Address<u8*>(), 16 * 2 * sizeof(u64));
+                }
+                break;
+            }
+            default:
+                break;
+            }
+            cmds = cmds.subspan(num_words);
+        }
+    }
+
+    void FlushRanges() {
+        for (const auto& range : ranges) {
+            file.WriteObject(RecordHeader{RecordType::Memory, 0,
+                                          static_cast<u32>(range.data.size()), 0, range.address});
+            file.WriteSpan(std::span<const u8>{range.data});
+        }
+        ranges.clear();
+    }
+
+    IOFile file;
+    std::mutex mutex;
+    std::vector<GuestRange> ranges;
+};
+
+/// Maps guest ranges of a capture at their original addresses in the replaying process.
+class GuestMapper {
+public:
+    ~GuestMapper() {
+        for (const VAddr page : pages) {
+#ifdef _WIN32
+            VirtualFree(reinterpret_cast<void*>(page), 0, MEM_RELEASE);
+#else
+            munmap(reinterpret_cast<void*>(page), ReplayPageSize);
+#endif
+        }
+    }
+
+    bool Map(VAddr address, u64 size) {
+        const VAddr start = Common::AlignDown(address, ReplayPageSize);
+        const VAddr end = Common::AlignUp(address + size, ReplayPageSize);
+        for (VAddr page = start; page < end; page += ReplayPageSize) {
+            if (pages.contains(page)) {
+                continue;
+            }
+            if (!MapPage(page)) {
+                LOG_ERROR(Render, "Unable to map guest page {:#x} for replay", page);
+                return false;
+            }
+            pages.insert(page);
+        }
+        return true;
+    }
+
+private:
+    static bool MapPage(VAddr page) {
+        void* hint = reinterpret_cast<void*>(page);
+#ifdef _WIN32
+        return VirtualAlloc(hint, ReplayPageSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE) ==
+               hint;
+#else
+        void* ptr = mmap(hint, ReplayPageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1, 0);
+        if (ptr == MAP_FAILED) {
+            return false;
+        }
+        if (ptr != hint) {
+            munmap(ptr, ReplayPageSize);
+            return false;
+        }
+        return true;
+#endif
+    }
+
+    std::unordered_set<VAddr> pages;
+};
+
+std::filesystem::path capture_path;
+std::unique_ptr<Recorder> recorder;
+std::once_flag recorder_init;
+std::atomic<bool> is_capturing{};
+std::atomic<bool> is_replaying{};
+
+/// The recorder is created on the first submission, after logging has been set up.
+Recorder* GetRecorder() {
+    std::call_once(recorder_init, [] {
+        recorder = std::make_unique<Recorder>(capture_path);
+        if (!recorder->IsOpen()) {
+            LOG_ERROR(Render, "Unable to create PM4 capture file {}",
+                      PathToUTF8String(capture_path));
+            recorder.reset();
+            is_capturing = false;
+            return;
+        }
+        LOG_INFO(Render, "Recording GPU submissions to {}", PathToUTF8String(capture_path));
+    });
+    return recorder.get();
+}
+
+} // Anonymous namespace
+
+void StartPm4Capture(const std::filesystem::path& path) {
+    capture_path = path;
+    is_capturing = true;
+}
+
+bool IsPm4Capturing() {
+    return is_capturing;
+}
+
+bool IsPm4Replaying() {
+    return is_replaying;
+}
+
+void CapturePm4Gfx(std::span<const u32> dcb, std::span<const u32> ccb) {
+    if (auto* rec = GetRecorder()) {
+        rec->RecordGfx(dcb, ccb);
+    }
+}
+
+void CapturePm4Asc(u32 gnm_vqid, u32 pipe_id, std::span<const u32> acb) {
+    if (auto* rec = GetRecorder()) {
+        rec->RecordAsc(gnm_vqid, pipe_id, acb);
+    }
+}
+
+bool ReplayPm4Capture(const std::filesystem::path& path) {
+    const IOFile file{path, FileAccessMode::Read};
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render, "Unable to open PM4 capture {}", PathToUTF8String(path));
+        return false;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.Read(data) != data.size() || data.size() < sizeof(FileHeader)) {
+        LOG_ERROR(Render, "Unable to read PM4 capture {}", PathToUTF8String(path));
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != CaptureMagic || header.version != CaptureVersion) {
+        LOG_ERROR(Render, "Unsupported PM4 capture {}", PathToUTF8String(path));
+        return false;
+    }
+
+    is_replaying = true;
+    auto liverpool = std::make_unique<Liverpool>();
+    liverpool->ReserveCopyBufferSpace();
+
+    GuestMapper mapper;
+    std::unordered_map<u32, u32> vqid_map;
+    std::array<u32, Liverpool::NumComputeRings> read_ptrs{};
+    std::vector<u32> cmds;
+    u64 num_submits{};
+    u64 num_dwords{};
+    std::chrono::nanoseconds parse_time{};
+    bool result = true;
+
+    size_t offset = sizeof(FileHeader);
+    while (offset + sizeof(RecordHeader) <= data.size()) {
+        RecordHeader record;
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        offset += sizeof(record);
+        const u64 payload_size = PayloadSize(record);
+        if (payload_size > data.size() - offset) {
+            LOG_WARNING(Render, "PM4 capture is truncated at offset {:#x}", offset);
+            break;
+        }
+        const u8* payload = data.data() + offset;
+        offset += payload_size;
+
+        if (record.type == RecordType::Memory) {
+            if (!mapper.Map(record.address, payload_size)) {
+                result = false;
+                break;
+            }
+            std::memcpy(reinterpret_cast<void*>(record.address), payload, payload_size);
+            continue;
+        }
+
+        // Submissions are processed one at a time, so each sees the memory recorded with it.
+        cmds.resize(payload_size / sizeof(u32));
+        std::memcpy(cmds.data(), payload, payload_size);
+        const auto start = std::chrono::steady_clock::now();
+        if (record.type == RecordType::Gfx) {
+            const std::span<const u32> dcb{cmds.data(), record.size0};
+            const std::span<const u32> ccb{cmds.data() + record.size0, record.size1};
+            liverpool->SubmitGfx(dcb, ccb);
+            liverpool->SubmitDone();
+        } else {
+            auto [it, is_new] = vqid_map.try_emplace(record.queue);
+            if (is_new) {
+                ASSERT_MSG(vqid_map.size() <= read_ptrs.size(), "Too many compute queues");
+                const auto vqid = liverpool->asc_queues.insert(
+                    VAddr(0), &read_ptrs[vqid_map.size() - 1],
+                    std::numeric_limits<u32>::max(), record.size1);
+                it->second = vqid.index + 1;
+            }
+            liverpool->SubmitAsc(it->second, cmds);
+        }
+        liverpool->WaitGpuIdle();
+        parse_time += std::chrono::steady_clock::now() - start;
+        ++num_submits;
+        num_dwords += cmds.size();
+    }
+
+    liverpool.reset();
+    is_replaying = false;
+
+    const auto parse_ms = std::chrono::duration<double, std::milli>(parse_time).count();
+    LOG_INFO(Render, "Replayed {} submits ({} dwords) in {:.3f} ms, {:.1f} Mdwords/s",
+             num_submits, num_dwords, parse_ms,
+             parse_ms > 0.0 ? num_dwords / parse_ms / 1000.0 : 0.0);
+    return result;
+}
+
+} // namespace AmdGpu
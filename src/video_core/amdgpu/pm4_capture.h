@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "common/types.h"
+
+namespace AmdGpu {
+
+/// Starts recording every command buffer submitted to the GPU into the given file.
+void StartPm4Capture(const std::filesystem::path& path);
+
+/// Returns true while submissions are being recorded.
+bool IsPm4Capturing();
+
+/// Returns true while a capture is being replayed.
+bool IsPm4Replaying();
+
+/// Records a graphics submission along with the guest memory its packets reference.
+void CapturePm4Gfx(std::span<const u32> dcb, std::span<const u32> ccb);
+
+/// Records a compute ring submission along with the guest memory its packets reference.
+void CapturePm4Asc(u32 gnm_vqid, u32 pipe_id, std::span<const u32> acb);
+
+/// Feeds a capture through the PM4 parser without a rasterizer and logs the decode throughput.
+bool ReplayPm4Capture(const std::filesystem::path& path);
+
+} // namespace AmdGpu
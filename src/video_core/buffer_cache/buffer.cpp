@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <bit>
+
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "video_core/buffer_cache/buffer.h"
@@ -23,6 +25,8 @@ std::string_view BufferTypeName(MemoryUsage type) {
         return "Stream";
     case MemoryUsage::DeviceLocal:
         return "DeviceLocal";
+    case MemoryUsage::Imported:
+        return "Imported";
     default:
         return "Invalid";
     }
@@ -63,7 +67,10 @@ UniqueBuffer::UniqueBuffer(vk::Device device_, VmaAllocator allocator_)
     : device{device_}, allocator{allocator_} {}
 
 UniqueBuffer::~UniqueBuffer() {
-    if (buffer) {
+    if (imported_memory) {
+        device.destroyBuffer(buffer);
+        device.freeMemory(imported_memory);
+    } else if (buffer) {
         vmaDestroyBuffer(allocator, buffer, allocation);
     }
 }
@@ -100,6 +107,53 @@ void UniqueBuffer::Create(const vk::BufferCreateInfo& buffer_ci, MemoryUsage usa
     }
 }
 
+bool UniqueBuffer::Import(const vk::BufferCreateInfo& buffer_ci, void* host_pointer) {
+    static constexpr auto HandleType = vk::ExternalMemoryHandleTypeFlagBits::eHostAllocationEXT;
+    const auto [props_result, host_props] =
+        device.getMemoryHostPointerPropertiesEXT(HandleType, host_pointer);
+    if (props_result != vk::Result::eSuccess) {
+        return false;
+    }
+
+    const vk::ExternalMemoryBufferCreateInfo external_ci = {
+        .handleTypes = HandleType,
+    };
+    vk::BufferCreateInfo import_ci = buffer_ci;
+    import_ci.pNext = &external_ci;
+    const auto [buffer_result, new_buffer] = device.createBuffer(import_ci);
+    if (buffer_result != vk::Result::eSuccess) {
+        return false;
+    }
+
+    const auto requirements = device.getBufferMemoryRequirements(new_buffer);
+    const u32 type_bits = host_props.memoryTypeBits & requirements.memoryTypeBits;
+    if (type_bits == 0) {
+        device.destroyBuffer(new_buffer);
+        return false;
+    }
+    const vk::ImportMemoryHostPointerInfoEXT import_info = {
+        .handleType = HandleType,
+        .pHostPointer = host_pointer,
+    };
+    const auto [alloc_result, memory] = device.allocateMemory(vk::MemoryAllocateInfo{
+        .pNext = &import_info,
+        .allocationSize = buffer_ci.size,
+        .memoryTypeIndex = static_cast<u32>(std::countr_zero(type_bits)),
+    });
+    if (alloc_result != vk::Result::eSuccess) {
+        device.destroyBuffer(new_buffer);
+        return false;
+    }
+    if (device.bindBufferMemory(new_buffer, memory, 0) != vk::Result::eSuccess) {
+        device.destroyBuffer(new_buffer);
+        device.freeMemory(memory);
+        return false;
+    }
+    buffer = new_buffer;
+    imported_memory = memory;
+    return true;
+}
+
 Buffer::Buffer(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_, MemoryUsage usage_,
                VAddr cpu_addr_, vk::BufferUsageFlags flags, u64 size_bytes_)
     : cpu_addr{cpu_addr_}, size_bytes{size_bytes_}, instance{&instance_}, scheduler{&scheduler_},
@@ -109,6 +163,15 @@ Buffer::Buffer(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
         .size = size_bytes,
         .usage = flags,
     };
+    if (usage == MemoryUsage::Imported) {
+        // Guest memory is mapped at its guest address in the host address space.
+        if (buffer.Import(buffer_ci, std::bit_cast<void*>(cpu_addr))) {
+            Vulkan::SetObjectName(instance->GetDevice(), Handle(), "ImportedBuffer {:#x}:{:#x}",
+                                  cpu_addr, size_bytes);
+            is_coherent = true;
+        }
+        return;
+    }
     VmaAllocationInfo alloc_info{};
     buffer.Create(buffer_ci, usage, &alloc_info);
 
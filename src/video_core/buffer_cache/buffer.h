@@ -29,6 +29,7 @@ enum class MemoryUsage {
     Upload,      ///< Requires a host visible memory type optimized for CPU to GPU uploads
     Download,    ///< Requires a host visible memory type optimized for GPU to CPU readbacks
     Stream,      ///< Requests device local host visible buffer, falling back host memory.
+    Imported,    ///< Imports the guest memory at the buffer address for the GPU to read in place
 };
 
 constexpr vk::BufferUsageFlags ReadFlags =
@@ -49,17 +50,22 @@ struct UniqueBuffer {
     UniqueBuffer(UniqueBuffer&& other)
         : allocator{std::exchange(other.allocator, VK_NULL_HANDLE)},
           allocation{std::exchange(other.allocation, VK_NULL_HANDLE)},
-          buffer{std::exchange(other.buffer, VK_NULL_HANDLE)} {}
+          buffer{std::exchange(other.buffer, VK_NULL_HANDLE)},
+          imported_memory{std::exchange(other.imported_memory, VK_NULL_HANDLE)} {}
     UniqueBuffer& operator=(UniqueBuffer&& other) {
         buffer = std::exchange(other.buffer, VK_NULL_HANDLE);
         allocator = std::exchange(other.allocator, VK_NULL_HANDLE);
         allocation = std::exchange(other.allocation, VK_NULL_HANDLE);
+        imported_memory = std::exchange(other.imported_memory, VK_NULL_HANDLE);
         return *this;
     }
 
     void Create(const vk::BufferCreateInfo& image_ci, MemoryUsage usage,
                 VmaAllocationInfo* out_alloc_info);
 
+    /// Creates the buffer over existing host memory. Returns false if the driver refused it.
+    bool Import(const vk::BufferCreateInfo& buffer_ci, void* host_pointer);
+
     operator vk::Buffer() const {
         return buffer;
     }
@@ -68,6 +74,7 @@ struct UniqueBuffer {
     VmaAllocator allocator;
     VmaAllocation allocation;
     vk::Buffer buffer{};
+    vk::DeviceMemory imported_memory{};
     vk::DeviceAddress bda_addr = 0;
 };
 
@@ -4,7 +4,6 @@
 #include <algorithm>
 #include "common/alignment.h"
 #include "common/debug.h"
-#include "common/scope_exit.h"
 #include "core/memory.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/buffer_cache/buffer_cache.h"
@@ -21,12 +20,15 @@ static constexpr size_t StagingBufferSize = 512_MB;
 static constexpr size_t DownloadBufferSize = 32_MB;
 static constexpr size_t UboStreamBufferSize = 64_MB;
 static constexpr size_t DeviceBufferSize = 128_MB;
+static constexpr size_t MinImportSize = 256_KB;
+static constexpr size_t MaxImportedBuffers = 256;
 
 BufferCache::BufferCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                          AmdGpu::Liverpool* liverpool_, TextureCache& texture_cache_,
-                         PageManager& tracker)
+                         PageManager& tracker, GarbageCollector& garbage_collector_)
     : instance{instance_}, scheduler{scheduler_}, liverpool{liverpool_},
       memory{Core::Memory::Instance()}, texture_cache{texture_cache_},
+      garbage_collector{garbage_collector_},
       fault_manager{instance, scheduler, *this, CACHING_PAGEBITS, CACHING_NUMPAGES},
       staging_buffer{instance, scheduler, MemoryUsage::Upload, StagingBufferSize},
       stream_buffer{instance, scheduler, MemoryUsage::Stream, UboStreamBufferSize},
@@ -49,26 +51,6 @@ BufferCache::BufferCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& s
     ASSERT(null_id.index == 0);
     const vk::Buffer& null_buffer = slot_buffers[null_id].buffer;
     Vulkan::SetObjectName(instance.GetDevice(), null_buffer, "Null Buffer");
-
-    // Set up garbage collection parameters
-    if (!instance.CanReportMemoryUsage()) {
-        trigger_gc_memory = DEFAULT_TRIGGER_GC_MEMORY;
-        critical_gc_memory = DEFAULT_CRITICAL_GC_MEMORY;
-        return;
-    }
-
-    const s64 device_local_memory = static_cast<s64>(instance.GetTotalMemoryBudget());
-    const s64 min_spacing_expected = device_local_memory - 1_GB;
-    const s64 min_spacing_critical = device_local_memory - 512_MB;
-    const s64 mem_threshold = std::min<s64>(device_local_memory, TARGET_GC_THRESHOLD);
-    const s64 min_vacancy_expected = (6 * mem_threshold) / 10;
-    const s64 min_vacancy_critical = (2 * mem_threshold) / 10;
-    trigger_gc_memory = static_cast<u64>(
-        std::max<u64>(std::min(device_local_memory - min_vacancy_expected, min_spacing_expected),
-                      DEFAULT_TRIGGER_GC_MEMORY));
-    critical_gc_memory = static_cast<u64>(
-        std::max<u64>(std::min(device_local_memory - min_vacancy_critical, min_spacing_critical),
-                      DEFAULT_CRITICAL_GC_MEMORY));
 }
 
 BufferCache::~BufferCache() = default;
@@ -81,6 +63,25 @@ void BufferCache::InvalidateMemory(VAddr device_addr, u64 size) {
         device_addr, size, [this, device_addr, size] { ReadMemory(device_addr, size, true); });
 }
 
+void BufferCache::UnmapMemory(VAddr device_addr, u64 size) {
+    liverpool->SendCommand<true>([this, device_addr, size] {
+        const VAddr device_addr_end = device_addr + size;
+        const auto overlaps = [&](const auto& item) {
+            const auto& [base, buffer] = item;
+            const u64 buffer_size = buffer ? buffer->SizeBytes() : 1;
+            return base < device_addr_end && device_addr < base + buffer_size;
+        };
+        if (std::ranges::none_of(imported_buffers, overlaps)) {
+            return;
+        }
+        // The GPU may still be reading the memory that is about to go away.
+        scheduler.Finish();
+        for (auto it = imported_buffers.begin(); it != imported_buffers.end();) {
+            it = overlaps(*it) ? imported_buffers.erase(it) : std::next(it);
+        }
+    });
+}
+
 void BufferCache::ReadMemory(VAddr device_addr, u64 size, bool is_write) {
     liverpool->SendCommand<true>([this, device_addr, size, is_write] {
         Buffer& buffer = slot_buffers[FindBuffer(device_addr, size)];
@@ -123,10 +124,12 @@ void BufferCache::DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 si
     scheduler.EndRendering();
     const auto cmdbuf = scheduler.CommandBuffer();
     cmdbuf.copyBuffer(buffer.buffer, download_buffer.Handle(), copies);
-    const auto write_data = [&]() {
+    // The async path runs this after the buffer may have been deleted, so only values are kept.
+    auto write_data = [this, copies = std::move(copies), download, offset,
+                       buffer_addr = buffer.CpuAddr(), device_addr, size, is_write]() {
         auto* memory = Core::Memory::Instance();
         for (const auto& copy : copies) {
-            const VAddr copy_device_addr = buffer.CpuAddr() + copy.srcOffset;
+            const VAddr copy_device_addr = buffer_addr + copy.srcOffset;
             const u64 dst_offset = copy.dstOffset - offset;
             memory->TryWriteBacking(std::bit_cast<u8*>(copy_device_addr), download + dst_offset,
                                     copy.size);
@@ -137,7 +140,7 @@ void BufferCache::DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 si
         }
     };
     if constexpr (async) {
-        scheduler.DeferOperation(write_data);
+        scheduler.DeferOperation(std::move(write_data));
     } else {
         scheduler.Finish();
         write_data();
@@ -217,12 +220,13 @@ void BufferCache::BindVertexBuffers(const Vulkan::GraphicsPipeline& pipeline) {
         instance.IsNullDescriptorSupported() ? VK_NULL_HANDLE : GetBuffer(NULL_BUFFER_ID).Handle();
     for (const auto& buffer : guest_buffers) {
         if (buffer.GetSize() > 0) {
-            const auto host_buffer_info =
-                std::ranges::find_if(ranges_merged, [&](const BufferRange& range) {
-                    return buffer.base_address >= range.base_address &&
-                           buffer.base_address < range.end_address;
-                });
-            ASSERT(host_buffer_info != ranges_merged.cend());
+            // Merged ranges are sorted and disjoint, the last one starting at or before the
+            // buffer contains it.
+            auto host_buffer_info = std::ranges::upper_bound(
+                ranges_merged, buffer.base_address, {}, &BufferRange::base_address);
+            ASSERT(host_buffer_info != ranges_merged.cbegin());
+            --host_buffer_info;
+            ASSERT(buffer.base_address < host_buffer_info->end_address);
             host_buffers.emplace_back(host_buffer_info->vk_buffer);
             host_offsets.push_back(host_buffer_info->offset + buffer.base_address -
                                    host_buffer_info->base_address);
@@ -261,6 +265,16 @@ void BufferCache::BindIndexBuffer(u32 index_offset) {
     cmdbuf.bindIndexBuffer(vk_buffer->Handle(), offset, index_type);
 }
 
+void BufferCache::BeginUploadBatch() {
+    ASSERT(pending_uploads.empty());
+    batch_uploads = true;
+}
+
+void BufferCache::EndUploadBatch() {
+    batch_uploads = false;
+    FlushPendingUploads();
+}
+
 void BufferCache::FillBuffer(VAddr address, u32 num_bytes, u32 value, bool is_gds) {
     ASSERT_MSG(address % 4 == 0, "GDS offset must be dword aligned");
     if (!is_gds) {
@@ -403,13 +417,53 @@ std::pair<Buffer*, u32> BufferCache::ObtainBufferForImage(VAddr gpu_addr, u32 si
     if (IsRegionGpuModified(gpu_addr, size)) {
         return ObtainBuffer(gpu_addr, size, false, false);
     }
+    // Let the GPU read large images straight from guest memory to skip the staging copy.
+    if (size >= MinImportSize && instance.IsExternalMemoryHostSupported()) {
+        if (Buffer* buffer = ImportHostMemory(gpu_addr, size)) {
+            return {buffer, buffer->Offset(gpu_addr)};
+        }
+    }
     // In all other cases, just do a CPU copy to the staging buffer.
-    const auto [data, offset] = staging_buffer.Map(size, 16);
+    const auto [data, offset] = MapStaging(size, 16);
     memory->CopySparseMemory(gpu_addr, data, size);
     staging_buffer.Commit();
     return {&staging_buffer, offset};
 }
 
+Buffer* BufferCache::ImportHostMemory(VAddr device_addr, u64 size) {
+    const u64 alignment = std::max<u64>(instance.GetMinImportedHostPointerAlignment(), 1);
+    const VAddr base = Common::AlignDown(device_addr, alignment);
+    const VAddr end = Common::AlignUp(device_addr + size, alignment);
+    const auto it = imported_buffers.find(base);
+    if (it != imported_buffers.end()) {
+        // A failed import of this range is not retried until the memory is remapped.
+        if (!it->second || it->second->IsInBounds(device_addr, size)) {
+            return it->second.get();
+        }
+    }
+    if (imported_buffers.size() >= MaxImportedBuffers) {
+        for (auto imported_it = imported_buffers.begin(); imported_it != imported_buffers.end();
+             ++imported_it) {
+            scheduler.DeferOperation([buffer = std::move(imported_it.value())] {});
+        }
+        imported_buffers.clear();
+    }
+    auto buffer = std::make_unique<Buffer>(instance, scheduler, MemoryUsage::Imported, base,
+                                           vk::BufferUsageFlagBits::eTransferSrc |
+                                               vk::BufferUsageFlagBits::eStorageBuffer,
+                                           end - base);
+    if (!buffer->Handle()) {
+        LOG_DEBUG(Render_Vulkan, "Unable to import guest memory {:#x}:{:#x}", base, end - base);
+        buffer.reset();
+    }
+    auto& entry = imported_buffers[base];
+    if (entry) {
+        scheduler.DeferOperation([old_buffer = std::move(entry)] {});
+    }
+    entry = std::move(buffer);
+    return entry.get();
+}
+
 bool BufferCache::IsRegionRegistered(VAddr addr, size_t size) {
     // Check if we are missing some edge case here
     return buffer_ranges.Intersects(addr, size);
@@ -578,6 +632,10 @@ BufferId BufferCache::CreateBuffer(VAddr device_addr, u32 wanted_size) {
         slot_buffers.insert(instance, scheduler, MemoryUsage::DeviceLocal, overlap.begin,
                             AllFlags | vk::BufferUsageFlagBits::eShaderDeviceAddress, size);
     auto& new_buffer = slot_buffers[new_buffer_id];
+    if (!overlap.ids.empty()) {
+        // Overlapped buffers must receive their pending uploads before being copied over.
+        FlushPendingUploads();
+    }
     for (const BufferId overlap_id : overlap.ids) {
         JoinOverlap(new_buffer_id, overlap_id, !overlap.has_stream_leap);
     }
@@ -614,8 +672,11 @@ void BufferCache::ChangeRegister(BufferId buffer_id) {
         }
     }
     if constexpr (insert) {
-        total_used_memory += Common::AlignUp(size, CACHING_PAGESIZE);
-        buffer.SetLRUId(lru_cache.Insert(buffer_id, gc_tick));
+        buffer.SetLRUId(garbage_collector.Track({
+            .type = GarbageCollector::Object::Type::Buffer,
+            .id = buffer_id,
+            .size = Common::AlignUp(size, CACHING_PAGESIZE),
+        }));
         boost::container::small_vector<vk::DeviceAddress, 128> bda_addrs;
         bda_addrs.reserve(size_pages);
         for (u64 i = 0; i < size_pages; ++i) {
@@ -626,8 +687,7 @@ void BufferCache::ChangeRegister(BufferId buffer_id) {
                         bda_addrs.data(), bda_addrs.size() * sizeof(vk::DeviceAddress));
         buffer_ranges.Add(buffer.CpuAddr(), buffer.SizeBytes(), buffer_id);
     } else {
-        total_used_memory -= Common::AlignUp(size, CACHING_PAGESIZE);
-        lru_cache.Free(buffer.LRUId());
+        garbage_collector.Untrack(buffer.LRUId(), Common::AlignUp(size, CACHING_PAGESIZE));
         const u64 offset = bda_pagetable_buffer.Offset(page_begin * sizeof(vk::DeviceAddress));
         bda_pagetable_buffer.Fill(offset, size_pages * sizeof(vk::DeviceAddress), 0);
         buffer_ranges.Subtract(buffer.CpuAddr(), buffer.SizeBytes());
@@ -636,68 +696,117 @@ void BufferCache::ChangeRegister(BufferId buffer_id) {
 
 bool BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size, bool is_written,
                                     bool is_texel_buffer) {
-    boost::container::small_vector<vk::BufferCopy, 4> copies;
+    // Every use of a cached buffer passes through here, including the buffers reachable through
+    // the BDA page table, so it counts as a use even when nothing has to be uploaded.
+    TouchBuffer(buffer);
+    PendingUpload upload{
+        .dst_buffer = buffer.Handle(),
+        .dst_size = buffer.SizeBytes(),
+    };
     size_t total_size_bytes = 0;
     VAddr buffer_start = buffer.CpuAddr();
-    vk::Buffer src_buffer = VK_NULL_HANDLE;
     memory_tracker->ForEachUploadRange(
         device_addr, size, is_written,
         [&](u64 device_addr_out, u64 range_size) {
-            copies.emplace_back(total_size_bytes, device_addr_out - buffer_start, range_size);
+            upload.copies.emplace_back(total_size_bytes, device_addr_out - buffer_start,
+                                       range_size);
             total_size_bytes += range_size;
         },
-        [&] { src_buffer = UploadCopies(buffer, copies, total_size_bytes); });
+        [&] { UploadCopies(buffer, upload, total_size_bytes); });
+
+    if (upload.src_buffer) {
+        // Texel buffers may be overwritten from images right after, so upload them in order.
+        if (batch_uploads && !is_texel_buffer) {
+            if (pending_uploads_tick != scheduler.CurrentTick()) {
+                FlushPendingUploads();
+                pending_uploads_tick = scheduler.CurrentTick();
+            }
+            pending_uploads.emplace_back(std::move(upload));
+        } else {
+            RecordUploads({&upload, 1});
+        }
+    }
+    if (is_texel_buffer && !is_written) {
+        return SynchronizeBufferFromImage(buffer, device_addr, size);
+    }
+    return false;
+}
 
-    if (src_buffer) {
-        scheduler.EndRendering();
-        const auto cmdbuf = scheduler.CommandBuffer();
-        const vk::BufferMemoryBarrier2 pre_barrier = {
+void BufferCache::RecordUploads(std::span<PendingUpload> uploads) {
+    boost::container::small_vector<vk::BufferMemoryBarrier2, 8> pre_barriers;
+    boost::container::small_vector<vk::BufferMemoryBarrier2, 8> post_barriers;
+    for (const auto& upload : uploads) {
+        pre_barriers.push_back(vk::BufferMemoryBarrier2{
             .srcStageMask = vk::PipelineStageFlagBits2::eAllCommands,
             .srcAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite |
                              vk::AccessFlagBits2::eTransferRead |
                              vk::AccessFlagBits2::eTransferWrite,
             .dstStageMask = vk::PipelineStageFlagBits2::eTransfer,
             .dstAccessMask = vk::AccessFlagBits2::eTransferWrite,
-            .buffer = buffer.Handle(),
+            .buffer = upload.dst_buffer,
             .offset = 0,
-            .size = buffer.SizeBytes(),
-        };
-        const vk::BufferMemoryBarrier2 post_barrier = {
+            .size = upload.dst_size,
+        });
+        post_barriers.push_back(vk::BufferMemoryBarrier2{
             .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
             .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
             .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
             .dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
-            .buffer = buffer.Handle(),
+            .buffer = upload.dst_buffer,
             .offset = 0,
-            .size = buffer.SizeBytes(),
-        };
-        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-            .bufferMemoryBarrierCount = 1,
-            .pBufferMemoryBarriers = &pre_barrier,
-        });
-        cmdbuf.copyBuffer(src_buffer, buffer.buffer, copies);
-        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
-            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-            .bufferMemoryBarrierCount = 1,
-            .pBufferMemoryBarriers = &post_barrier,
+            .size = upload.dst_size,
         });
-        TouchBuffer(buffer);
     }
-    if (is_texel_buffer && !is_written) {
-        return SynchronizeBufferFromImage(buffer, device_addr, size);
+    scheduler.EndRendering();
+    const auto cmdbuf = scheduler.CommandBuffer();
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+        .bufferMemoryBarrierCount = static_cast<u32>(pre_barriers.size()),
+        .pBufferMemoryBarriers = pre_barriers.data(),
+    });
+    for (auto& upload : uploads) {
+        cmdbuf.copyBuffer(upload.src_buffer, upload.dst_buffer, upload.copies);
+        if (upload.temp_buffer) {
+            scheduler.DeferOperation(
+                [buffer = std::move(upload.temp_buffer)]() mutable { buffer.reset(); });
+        }
     }
-    return false;
+    cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+        .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+        .bufferMemoryBarrierCount = static_cast<u32>(post_barriers.size()),
+        .pBufferMemoryBarriers = post_barriers.data(),
+    });
 }
 
-vk::Buffer BufferCache::UploadCopies(Buffer& buffer, std::span<vk::BufferCopy> copies,
-                                     size_t total_size_bytes) {
-    if (copies.empty()) {
-        return VK_NULL_HANDLE;
+void BufferCache::FlushPendingUploads() {
+    if (pending_uploads.empty()) {
+        return;
     }
-    const auto [staging, offset] = staging_buffer.Map(total_size_bytes);
+    RecordUploads(pending_uploads);
+    pending_uploads.clear();
+}
+
+std::pair<u8*, u64> BufferCache::MapStaging(u64 size, u64 alignment) {
+    // Pending uploads still read from staging memory that is only guarded until the tick it was
+    // written in, so they are recorded before a wait can submit that tick or after it passed.
+    if (!pending_uploads.empty()) {
+        if (pending_uploads_tick == scheduler.CurrentTick()) {
+            if (const auto mapped = staging_buffer.Map(size, alignment, false); mapped.first) {
+                return mapped;
+            }
+        }
+        FlushPendingUploads();
+    }
+    return staging_buffer.Map(size, alignment);
+}
+
+void BufferCache::UploadCopies(Buffer& buffer, PendingUpload& upload, size_t total_size_bytes) {
+    if (upload.copies.empty()) {
+        return;
+    }
+    const auto [staging, offset] = MapStaging(total_size_bytes);
     if (staging) {
-        for (auto& copy : copies) {
+        for (auto& copy : upload.copies) {
             u8* const src_pointer = staging + copy.srcOffset;
             const VAddr device_addr = buffer.CpuAddr() + copy.dstOffset;
             memory->CopySparseMemory(device_addr, src_pointer, copy.size);
@@ -705,21 +814,20 @@ vk::Buffer BufferCache::UploadCopies(Buffer& buffer, std::span<vk::BufferCopy> c
             copy.srcOffset += offset;
         }
         staging_buffer.Commit();
-        return staging_buffer.Handle();
+        upload.src_buffer = staging_buffer.Handle();
     } else {
-        // For large one time transfers use a temporary host buffer.
-        auto temp_buffer =
+        // For large one time transfers use a temporary host buffer. It is released once the
+        // copy has been recorded.
+        upload.temp_buffer =
             std::make_unique<Buffer>(instance, scheduler, MemoryUsage::Upload, 0,
                                      vk::BufferUsageFlagBits::eTransferSrc, total_size_bytes);
-        const vk::Buffer src_buffer = temp_buffer->Handle();
-        u8* const staging = temp_buffer->mapped_data.data();
-        for (const auto& copy : copies) {
+        u8* const staging = upload.temp_buffer->mapped_data.data();
+        for (const auto& copy : upload.copies) {
             u8* const src_pointer = staging + copy.srcOffset;
             const VAddr device_addr = buffer.CpuAddr() + copy.dstOffset;
             memory->CopySparseMemory(device_addr, src_pointer, copy.size);
         }
-        scheduler.DeferOperation([buffer = std::move(temp_buffer)]() mutable { buffer.reset(); });
-        return src_buffer;
+        upload.src_buffer = upload.temp_buffer->Handle();
     }
 }
 
@@ -785,7 +893,7 @@ void BufferCache::WriteDataBuffer(Buffer& buffer, VAddr address, const void* val
     };
     vk::Buffer src_buffer = staging_buffer.Handle();
     if (num_bytes < StagingBufferSize) {
-        const auto [staging, offset] = staging_buffer.Map(num_bytes);
+        const auto [staging, offset] = MapStaging(num_bytes);
         std::memcpy(staging, value, num_bytes);
         copy.srcOffset = offset;
         staging_buffer.Commit();
@@ -833,33 +941,35 @@ void BufferCache::WriteDataBuffer(Buffer& buffer, VAddr address, const void* val
     });
 }
 
-void BufferCache::RunGarbageCollector() {
-    SCOPE_EXIT {
-        ++gc_tick;
-    };
-    if (instance.CanReportMemoryUsage()) {
-        total_used_memory = instance.GetDeviceMemoryUsage();
+EvictionCost BufferCache::GetEvictionCost(BufferId buffer_id, bool allow_download) {
+    const Buffer& buffer = slot_buffers[buffer_id];
+    if (buffer.is_deleted) {
+        return EvictionCost::Never;
     }
-    if (total_used_memory < trigger_gc_memory) {
+    if (IsRegionGpuModified(buffer.CpuAddr(), buffer.SizeBytes())) {
+        return allow_download ? EvictionCost::Download : EvictionCost::Never;
+    }
+    return EvictionCost::Upload;
+}
+
+void BufferCache::EvictBuffer(BufferId buffer_id) {
+    Buffer& buffer = slot_buffers[buffer_id];
+    if (buffer.is_deleted) {
         return;
     }
-    const bool aggressive = total_used_memory >= critical_gc_memory;
-    const u64 ticks_to_destroy = std::min<u64>(aggressive ? 80 : 160, gc_tick);
-    int max_deletions = aggressive ? 64 : 32;
-    const auto clean_up = [&](BufferId buffer_id) {
-        if (max_deletions == 0) {
-            return;
-        }
-        --max_deletions;
-        Buffer& buffer = slot_buffers[buffer_id];
-        // InvalidateMemory(buffer.CpuAddr(), buffer.SizeBytes());
-        DownloadBufferMemory<true>(buffer, buffer.CpuAddr(), buffer.SizeBytes(), true);
-        DeleteBuffer(buffer_id);
-    };
+    const VAddr device_addr = buffer.CpuAddr();
+    const u64 size = buffer.SizeBytes();
+    if (IsRegionGpuModified(device_addr, size)) {
+        DownloadBufferMemory<true>(buffer, device_addr, size, true);
+    } else {
+        // Make sure a buffer created over this range later uploads it again.
+        memory_tracker->MarkRegionAsCpuModified(device_addr, size);
+    }
+    DeleteBuffer(buffer_id);
 }
 
 void BufferCache::TouchBuffer(const Buffer& buffer) {
-    lru_cache.Touch(buffer.LRUId(), gc_tick);
+    garbage_collector.Touch(buffer.LRUId());
 }
 
 void BufferCache::DeleteBuffer(BufferId buffer_id) {
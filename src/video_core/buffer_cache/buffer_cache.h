@@ -3,13 +3,15 @@
 
 #pragma once
 
+#include <memory>
 #include <boost/container/small_vector.hpp>
-#include "common/lru_cache.h"
+#include <tsl/robin_map.h>
 #include "common/slot_vector.h"
 #include "common/types.h"
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/buffer_cache/fault_manager.h"
 #include "video_core/buffer_cache/range_set.h"
+#include "video_core/garbage_collector.h"
 #include "video_core/multi_level_page_table.h"
 
 namespace AmdGpu {
@@ -42,11 +44,6 @@ public:
     static constexpr u64 CACHING_NUMPAGES = u64{1} << (40 - CACHING_PAGEBITS);
     static constexpr u64 BDA_PAGETABLE_SIZE = CACHING_NUMPAGES * sizeof(vk::DeviceAddress);
 
-    // Default values for garbage collection
-    static constexpr s64 DEFAULT_TRIGGER_GC_MEMORY = 1_GB;
-    static constexpr s64 DEFAULT_CRITICAL_GC_MEMORY = 2_GB;
-    static constexpr s64 TARGET_GC_THRESHOLD = 8_GB;
-
     struct PageData {
         BufferId buffer_id{};
     };
@@ -59,6 +56,14 @@ public:
     };
     using PageTable = MultiLevelPageTable<Traits>;
 
+    struct PendingUpload {
+        vk::Buffer src_buffer;
+        vk::Buffer dst_buffer;
+        u64 dst_size;
+        boost::container::small_vector<vk::BufferCopy, 4> copies;
+        std::unique_ptr<Buffer> temp_buffer; ///< Source of large transfers, freed once recorded
+    };
+
     struct OverlapResult {
         boost::container::small_vector<BufferId, 16> ids;
         VAddr begin;
@@ -69,7 +74,7 @@ public:
 public:
     explicit BufferCache(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
                          AmdGpu::Liverpool* liverpool, TextureCache& texture_cache,
-                         PageManager& tracker);
+                         PageManager& tracker, GarbageCollector& garbage_collector);
     ~BufferCache();
 
     /// Returns a pointer to GDS device local buffer.
@@ -111,12 +116,21 @@ public:
     /// Flushes any GPU modified buffer in the logical page range back to CPU memory.
     void ReadMemory(VAddr device_addr, u64 size, bool is_write = false);
 
+    /// Releases imported guest memory in the logical page range before it is unmapped.
+    void UnmapMemory(VAddr device_addr, u64 size);
+
     /// Binds host vertex buffers for the current draw.
     void BindVertexBuffers(const Vulkan::GraphicsPipeline& pipeline);
 
     /// Bind host index buffer for the current draw.
     void BindIndexBuffer(u32 index_offset);
 
+    /// Defers uploads of obtained read-only buffers until EndUploadBatch is called.
+    void BeginUploadBatch();
+
+    /// Records the uploads deferred since BeginUploadBatch behind a single pair of barriers.
+    void EndUploadBatch();
+
     /// Writes a value to GPU buffer. (uses command buffer to temporarily store the data)
     void FillBuffer(VAddr address, u32 num_bytes, u32 value, bool is_gds);
 
@@ -152,8 +166,11 @@ public:
     /// Synchronizes all buffers neede for DMA.
     void SynchronizeDmaBuffers();
 
-    /// Runs the garbage collector.
-    void RunGarbageCollector();
+    /// Returns the cost of evicting the buffer, allowing write back of GPU modified contents.
+    [[nodiscard]] EvictionCost GetEvictionCost(BufferId buffer_id, bool allow_download);
+
+    /// Writes back and deletes a buffer chosen by the garbage collector.
+    void EvictBuffer(BufferId buffer_id);
 
 private:
     template <typename Func>
@@ -188,8 +205,15 @@ private:
     bool SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size, bool is_written,
                            bool is_texel_buffer);
 
-    vk::Buffer UploadCopies(Buffer& buffer, std::span<vk::BufferCopy> copies,
-                            size_t total_size_bytes);
+    void UploadCopies(Buffer& buffer, PendingUpload& upload, size_t total_size_bytes);
+
+    void RecordUploads(std::span<PendingUpload> uploads);
+
+    void FlushPendingUploads();
+
+    std::pair<u8*, u64> MapStaging(u64 size, u64 alignment = 0);
+
+    Buffer* ImportHostMemory(VAddr device_addr, u64 size);
 
     bool SynchronizeBufferFromImage(Buffer& buffer, VAddr device_addr, u32 size);
 
@@ -204,6 +228,7 @@ private:
     AmdGpu::Liverpool* liverpool;
     Core::MemoryManager* memory;
     TextureCache& texture_cache;
+    GarbageCollector& garbage_collector;
     FaultManager fault_manager;
     std::unique_ptr<MemoryTracker> memory_tracker;
     StreamBuffer staging_buffer;
@@ -213,14 +238,13 @@ private:
     Buffer gds_buffer;
     Buffer bda_pagetable_buffer;
     Common::SlotVector<Buffer> slot_buffers;
-    u64 total_used_memory = 0;
-    u64 trigger_gc_memory = 0;
-    u64 critical_gc_memory = 0;
-    u64 gc_tick = 0;
-    Common::LeastRecentlyUsedCache<BufferId, u64> lru_cache;
     RangeSet gpu_modified_ranges;
     SplitRangeMap<BufferId> buffer_ranges;
     PageTable page_table;
+    tsl::robin_map<VAddr, std::unique_ptr<Buffer>> imported_buffers;
+    boost::container::small_vector<PendingUpload, 8> pending_uploads;
+    u64 pending_uploads_tick{};
+    bool batch_uploads{};
 };
 
 } // namespace VideoCore
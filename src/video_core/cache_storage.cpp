@@ -11,14 +11,26 @@
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
 
-#include <miniz.h>
+#include <tsl/robin_map.h>
+#include <xxhash.h>
+#include <zlib.h>
 
 #include <condition_variable>
+#include <cstring>
 #include <functional>
 #include <future>
 #include <mutex>
 #include <queue>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace {
 
 std::mutex submit_mutex{};
@@ -27,8 +39,231 @@ std::condition_variable_any request_cv{};
 std::queue<std::packaged_task<void()>> req_queue{};
 std::mutex m_request{};
 
-mz_zip_archive zip_ar{};
-bool ar_is_read_only{true};
+/*
+ * Archived caches are a single append-only file:
+ *   ArchiveHeader, then any number of { BlobHeader, name, payload } records.
+ * The index is rebuilt from the record headers on open, later records with the same name take
+ * precedence. A record that is cut short (e.g the emulator was killed mid-write) ends the scan
+ * and is truncated away before anything new is appended.
+ */
+constexpr u32 ArchiveMagic = 0x43505053; // 'SPPC'
+constexpr u32 ArchiveVersion = 1u;
+constexpr u32 BlobMagic = 0x424f4c42; // 'BLOB'
+constexpr size_t MinCompressSize = 4_KB;
+
+struct ArchiveHeader {
+    u32 magic;
+    u32 version;
+};
+
+enum BlobFlags : u32 {
+    None = 0,
+    Compressed = 1u << 0,
+};
+
+struct BlobHeader {
+    u32 magic;
+    u32 flags;
+    u32 name_size;
+    u32 reserved;
+    u64 stored_size;
+    u64 data_size;
+    u64 checksum;
+};
+static_assert(sizeof(BlobHeader) == 40);
+
+struct BlobEntry {
+    std::string name;
+    const u8* payload;
+    u64 stored_size;
+    u64 data_size;
+    u64 checksum;
+    u32 flags;
+};
+
+class MappedFile {
+public:
+    bool Map(const std::filesystem::path& path) {
+#ifdef _WIN32
+        file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER file_size{};
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            Unmap();
+            return false;
+        }
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            Unmap();
+            return false;
+        }
+        data = static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        size = static_cast<size_t>(file_size.QuadPart);
+#else
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st{};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            close(fd);
+            return false;
+        }
+        void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (ptr == MAP_FAILED) {
+            return false;
+        }
+        data = static_cast<const u8*>(ptr);
+        size = static_cast<size_t>(st.st_size);
+#endif
+        if (!data) {
+            Unmap();
+            return false;
+        }
+        return true;
+    }
+
+    void Unmap() {
+#ifdef _WIN32
+        if (data) {
+            UnmapViewOfFile(data);
+        }
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data) {
+            munmap(const_cast<u8*>(data), size);
+        }
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    const u8* data{};
+    size_t size{};
+
+private:
+#ifdef _WIN32
+    HANDLE file{INVALID_HANDLE_VALUE};
+    HANDLE mapping{};
+#endif
+};
+
+MappedFile archive_map{};
+std::vector<BlobEntry> archive_blobs{};                // in the order they were first written
+tsl::robin_map<std::string, size_t> archive_index{}; // name -> position in archive_blobs
+Common::FS::IOFile archive_file{};
+
+/// Builds the blob index from the mapped archive. Returns the size of the valid prefix.
+size_t IndexArchive() {
+    archive_blobs.clear();
+    archive_index.clear();
+    const u8* const base = archive_map.data;
+    const size_t size = archive_map.size;
+
+    ArchiveHeader header{};
+    if (size < sizeof(header)) {
+        return 0;
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (header.magic != ArchiveMagic || header.version != ArchiveVersion) {
+        return 0;
+    }
+
+    size_t offset = sizeof(header);
+    while (offset + sizeof(BlobHeader) <= size) {
+        BlobHeader blob{};
+        std::memcpy(&blob, base + offset, sizeof(blob));
+        const size_t name_offset = offset + sizeof(blob);
+        if (blob.magic != BlobMagic || blob.name_size > size - name_offset ||
+            blob.stored_size > size - name_offset - blob.name_size) {
+            break;
+        }
+        BlobEntry entry{
+            .name = {reinterpret_cast<const char*>(base + name_offset), blob.name_size},
+            .payload = base + name_offset + blob.name_size,
+            .stored_size = blob.stored_size,
+            .data_size = blob.data_size,
+            .checksum = blob.checksum,
+            .flags = blob.flags,
+        };
+        const auto [it, is_new] = archive_index.try_emplace(entry.name, archive_blobs.size());
+        if (is_new) {
+            archive_blobs.emplace_back(std::move(entry));
+        } else {
+            archive_blobs[it->second] = std::move(entry);
+        }
+        offset = name_offset + blob.name_size + blob.stored_size;
+    }
+    return offset;
+}
+
+bool ReadBlob(const BlobEntry& entry, u8* out, size_t out_size) {
+    if (XXH3_64bits(entry.payload, entry.stored_size) != entry.checksum) {
+        LOG_ERROR(Render, "Cache blob {} is corrupted", entry.name);
+        return false;
+    }
+    if (!(entry.flags & BlobFlags::Compressed)) {
+        std::memcpy(out, entry.payload, std::min<size_t>(out_size, entry.stored_size));
+        return true;
+    }
+    uLongf dest_size = static_cast<uLongf>(out_size);
+    if (uncompress(out, &dest_size, entry.payload, static_cast<uLong>(entry.stored_size)) !=
+            Z_OK ||
+        dest_size != entry.data_size) {
+        LOG_ERROR(Render, "Failed to decompress cache blob {}", entry.name);
+        return false;
+    }
+    return true;
+}
+
+void AppendBlob(const std::string& name, const void* data, size_t size) {
+    const u8* payload = static_cast<const u8*>(data);
+    size_t stored_size = size;
+    u32 flags = BlobFlags::None;
+
+    std::vector<u8> compressed{};
+    if (size >= MinCompressSize) {
+        uLongf compressed_size = compressBound(static_cast<uLong>(size));
+        compressed.resize(compressed_size);
+        if (compress2(compressed.data(), &compressed_size, payload, static_cast<uLong>(size),
+                      Z_BEST_SPEED) == Z_OK &&
+            compressed_size < size - size / 8) {
+            payload = compressed.data();
+            stored_size = compressed_size;
+            flags |= BlobFlags::Compressed;
+        }
+    }
+
+    const BlobHeader header{
+        .magic = BlobMagic,
+        .flags = flags,
+        .name_size = static_cast<u32>(name.size()),
+        .reserved = 0,
+        .stored_size = stored_size,
+        .data_size = size,
+        .checksum = XXH3_64bits(payload, stored_size),
+    };
+
+    // Emit the record with a single write so a torn tail is at most one record long.
+    std::vector<u8> record(sizeof(header) + name.size() + stored_size);
+    std::memcpy(record.data(), &header, sizeof(header));
+    std::memcpy(record.data() + sizeof(header), name.data(), name.size());
+    std::memcpy(record.data() + sizeof(header) + name.size(), payload, stored_size);
+    if (archive_file.WriteSpan<u8>(record) != record.size()) {
+        LOG_ERROR(Render, "Failed to append {} to the cache archive", name);
+    }
+}
 
 } // namespace
 
@@ -96,19 +331,39 @@ void DataBase::Open() {
 
     using namespace Common::FS;
     if (Config::isPipelineCacheArchived()) {
-        mz_zip_zero_struct(&zip_ar);
-
         cache_path = GetUserPath(PathType::CacheDir) /
-                     std::filesystem::path{game_info.GameSerial()}.replace_extension(".zip");
+                     std::filesystem::path{game_info.GameSerial()}.replace_extension(".cache");
 
-        if (!mz_zip_reader_init_file(&zip_ar, cache_path.string().c_str(),
-                                     MZ_ZIP_FLAG_READ_ALLOW_WRITING) ||
-            !mz_zip_validate_archive(&zip_ar, 0)) {
+        size_t valid_size = 0;
+        if (archive_map.Map(cache_path)) {
+            valid_size = IndexArchive();
+        }
+        if (valid_size != 0 && valid_size < archive_map.size) {
+            LOG_WARNING(Render, "Dropping {} bytes of incomplete records from {}",
+                        archive_map.size - valid_size, cache_path.string());
+            // The index points into the mapping, and a mapped file cannot be truncated on
+            // Windows, so drop both and index the truncated file again.
+            archive_map.Unmap();
+            const bool truncated =
+                IOFile{cache_path, FileAccessMode::ReadWrite}.SetSize(valid_size);
+            if (!truncated) {
+                LOG_ERROR(Render, "Failed to truncate {}, rebuilding it", cache_path.string());
+            }
+            valid_size = truncated && archive_map.Map(cache_path) ? IndexArchive() : 0;
+        }
+        if (valid_size == 0) {
             LOG_INFO(Render, "Cache archive {} is not found or archive is corrupted",
-                     cache_path.string().c_str());
-            mz_zip_reader_end(&zip_ar);
-            mz_zip_writer_init_file(&zip_ar, cache_path.string().c_str(), 0);
+                     cache_path.string());
+            archive_map.Unmap();
+            archive_blobs.clear();
+            archive_index.clear();
+            archive_file.Open(cache_path, FileAccessMode::Create);
+            archive_file.WriteObject(ArchiveHeader{ArchiveMagic, ArchiveVersion});
+        } else {
+            archive_file.Open(cache_path, FileAccessMode::Append);
         }
+        LOG_INFO(Render, "Opened cache archive {} with {} blobs", cache_path.string(),
+                 archive_blobs.size());
     } else {
         cache_path = GetUserPath(PathType::CacheDir) / game_info.GameSerial();
         if (!std::filesystem::exists(cache_path)) {
@@ -129,10 +384,13 @@ void DataBase::Close() {
     io_worker.join();
 
     if (Config::isPipelineCacheArchived()) {
-        mz_zip_writer_finalize_archive(&zip_ar);
-        mz_zip_writer_end(&zip_ar);
+        archive_blobs.clear();
+        archive_index.clear();
+        archive_map.Unmap();
+        archive_file.Close();
     }
 
+    opened = false;
     LOG_INFO(Render, "Cache dumped");
 }
 
@@ -143,12 +401,7 @@ bool WriteVector(const BlobType type, std::filesystem::path&& path_, std::vector
             auto path{path_};
             path.replace_extension(GetBlobFileExtension(type));
             if (Config::isPipelineCacheArchived()) {
-                ASSERT_MSG(!ar_is_read_only,
-                           "The archive is read-only. Did you forget to call `FinishPreload`?");
-                if (!mz_zip_writer_add_mem(&zip_ar, path.string().c_str(), v.data(),
-                                           v.size() * sizeof(T), MZ_BEST_COMPRESSION)) {
-                    LOG_ERROR(Render, "Failed to add {} to the archive", path.string().c_str());
-                }
+                AppendBlob(path.string(), v.data(), v.size() * sizeof(T));
             } else {
                 using namespace Common::FS;
                 const auto file = IOFile{path, FileAccessMode::Create};
@@ -170,16 +423,17 @@ void LoadVector(BlobType type, std::filesystem::path& path, std::vector<T>& v) {
     using namespace Common::FS;
     path.replace_extension(GetBlobFileExtension(type));
     if (Config::isPipelineCacheArchived()) {
-        int index{-1};
-        index = mz_zip_reader_locate_file(&zip_ar, path.string().c_str(), nullptr, 0);
-        if (index < 0) {
-            LOG_WARNING(Render, "File {} is not found in the archive", path.string().c_str());
+        const auto name = path.string();
+        const auto it = archive_index.find(name);
+        if (it == archive_index.end()) {
+            LOG_WARNING(Render, "File {} is not found in the archive", name);
             return;
         }
-        mz_zip_archive_file_stat stat{};
-        mz_zip_reader_file_stat(&zip_ar, index, &stat);
-        v.resize(stat.m_uncomp_size / sizeof(T));
-        mz_zip_reader_extract_to_mem(&zip_ar, index, v.data(), stat.m_uncomp_size, 0);
+        const auto& entry = archive_blobs[it->second];
+        v.resize(entry.data_size / sizeof(T));
+        if (!ReadBlob(entry, reinterpret_cast<u8*>(v.data()), v.size() * sizeof(T))) {
+            v.clear();
+        }
     } else {
         const auto file = IOFile{path, FileAccessMode::Read};
         v.resize(file.GetSize() / sizeof(T));
@@ -226,17 +480,12 @@ void DataBase::Load(BlobType type, const std::string& name, std::vector<u32>& da
 void DataBase::ForEachBlob(BlobType type, const std::function<void(std::vector<u8>&& data)>& func) {
     const auto& ext = GetBlobFileExtension(type);
     if (Config::isPipelineCacheArchived()) {
-        const auto num_files = mz_zip_reader_get_num_files(&zip_ar);
-        for (int index = 0; index < num_files; ++index) {
-            std::array<char, MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE> file_name{};
-            file_name.fill(0);
-            mz_zip_reader_get_filename(&zip_ar, index, file_name.data(), file_name.size());
-            if (std::string{file_name.data()}.ends_with(ext)) {
-                mz_zip_archive_file_stat stat{};
-                mz_zip_reader_file_stat(&zip_ar, index, &stat);
-                std::vector<u8> data(stat.m_uncomp_size);
-                mz_zip_reader_extract_to_mem(&zip_ar, index, data.data(), data.size(), 0);
-                func(std::move(data));
+        for (const auto& entry : archive_blobs) {
+            if (entry.name.ends_with(ext)) {
+                std::vector<u8> data(entry.data_size);
+                if (ReadBlob(entry, data.data(), data.size())) {
+                    func(std::move(data));
+                }
             }
         }
     } else {
@@ -256,8 +505,10 @@ void DataBase::ForEachBlob(BlobType type, const std::function<void(std::vector<u
 
 void DataBase::FinishPreload() {
     if (Config::isPipelineCacheArchived()) {
-        mz_zip_writer_init_from_reader(&zip_ar, cache_path.string().c_str());
-        ar_is_read_only = false;
+        // Blobs are only looked up during warm-up, release the mapping once it is done.
+        archive_blobs.clear();
+        archive_index.clear();
+        archive_map.Unmap();
     }
 }
 
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+
+#include "common/scope_exit.h"
+#include "video_core/buffer_cache/buffer_cache.h"
+#include "video_core/garbage_collector.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/texture_cache/texture_cache.h"
+
+namespace VideoCore {
+
+using Clock = std::chrono::steady_clock;
+
+/// Time a single collection may spend evicting, scaled up when memory is critically low.
+static constexpr auto TimeBudget = std::chrono::microseconds{500};
+static constexpr auto CriticalTimeBudget = std::chrono::milliseconds{2};
+
+/// Number of the oldest objects weighed against each other in one collection.
+static constexpr size_t MaxCandidates = 256;
+
+GarbageCollector::GarbageCollector(const Vulkan::Instance& instance_, TextureCache& texture_cache_,
+                                   BufferCache& buffer_cache_)
+    : instance{instance_}, texture_cache{texture_cache_}, buffer_cache{buffer_cache_} {
+    candidates.reserve(MaxCandidates);
+
+    if (!instance.CanReportMemoryUsage()) {
+        trigger_gc_memory = DEFAULT_TRIGGER_GC_MEMORY;
+        pressure_gc_memory = DEFAULT_PRESSURE_GC_MEMORY;
+        critical_gc_memory = DEFAULT_CRITICAL_GC_MEMORY;
+        return;
+    }
+
+    const s64 device_local_memory = static_cast<s64>(instance.GetTotalMemoryBudget());
+    const s64 min_spacing_expected = device_local_memory - 1_GB;
+    const s64 min_spacing_critical = device_local_memory - 512_MB;
+    const s64 mem_threshold = std::min<s64>(device_local_memory, TARGET_GC_THRESHOLD);
+    const s64 min_vacancy_expected = (6 * mem_threshold) / 10;
+    const s64 min_vacancy_critical = (2 * mem_threshold) / 10;
+    pressure_gc_memory = static_cast<u64>(
+        std::max<u64>(std::min(device_local_memory - min_vacancy_expected, min_spacing_expected),
+                      DEFAULT_PRESSURE_GC_MEMORY));
+    critical_gc_memory = static_cast<u64>(
+        std::max<u64>(std::min(device_local_memory - min_vacancy_critical, min_spacing_critical),
+                      DEFAULT_CRITICAL_GC_MEMORY));
+    trigger_gc_memory = static_cast<u64>((device_local_memory - mem_threshold) / 2);
+}
+
+GarbageCollector::~GarbageCollector() = default;
+
+u64 GarbageCollector::Track(Object object) {
+    std::scoped_lock lock{mutex};
+    total_used_memory += object.size;
+    return lru_cache.Insert(object, gc_tick);
+}
+
+void GarbageCollector::Untrack(u64 lru_id, u64 size) {
+    std::scoped_lock lock{mutex};
+    lru_cache.Free(lru_id);
+    total_used_memory -= size;
+}
+
+void GarbageCollector::Touch(u64 lru_id) {
+    std::scoped_lock lock{mutex};
+    lru_cache.Touch(lru_id, gc_tick);
+}
+
+void GarbageCollector::Run() {
+    bool pressured{};
+    bool critical{};
+    {
+        std::scoped_lock lock{mutex};
+        SCOPE_EXIT {
+            ++gc_tick;
+        };
+        if (instance.CanReportMemoryUsage()) {
+            total_used_memory = instance.GetDeviceMemoryUsage();
+        }
+        if (total_used_memory < trigger_gc_memory) {
+            return;
+        }
+        pressured = total_used_memory >= pressure_gc_memory;
+        critical = total_used_memory >= critical_gc_memory;
+
+        // The closer we are to running out of memory, the more recently used objects may go.
+        const u64 ticks_to_destroy = std::min<u64>(critical ? 16 : pressured ? 80 : 160, gc_tick);
+        candidates.clear();
+        lru_cache.ForEachItemBelow(gc_tick - ticks_to_destroy, [&](const Object& object) {
+            candidates.push_back({object, 0});
+            return candidates.size() >= MaxCandidates;
+        });
+    }
+
+    // Objects are queried without holding the lock, as the caches take their own locks first
+    // and call back into the collector when freeing.
+    for (auto& candidate : candidates) {
+        const auto& object = candidate.object;
+        const EvictionCost cost =
+            object.type == Object::Type::Image
+                ? texture_cache.GetEvictionCost(object.id, pressured)
+                : buffer_cache.GetEvictionCost(object.id, pressured);
+        if (cost != EvictionCost::Never) {
+            candidate.score = std::max<u64>(object.size / static_cast<u32>(cost), 1);
+        }
+    }
+    std::erase_if(candidates, [](const Candidate& candidate) { return candidate.score == 0; });
+    std::ranges::sort(candidates, std::greater{}, &Candidate::score);
+
+    const auto deadline = Clock::now() + (critical ? CriticalTimeBudget : TimeBudget);
+    const u64 target_memory = critical ? pressure_gc_memory : trigger_gc_memory;
+    size_t max_deletions = critical ? 64 : pressured ? 32 : 16;
+    for (const auto& candidate : candidates) {
+        if (max_deletions-- == 0) {
+            break;
+        }
+        {
+            std::scoped_lock lock{mutex};
+            if (total_used_memory < target_memory) {
+                break;
+            }
+        }
+        const auto& object = candidate.object;
+        if (object.type == Object::Type::Image) {
+            texture_cache.EvictImage(object.id);
+        } else {
+            buffer_cache.EvictBuffer(object.id);
+        }
+        if (Clock::now() >= deadline) {
+            break;
+        }
+    }
+}
+
+} // namespace VideoCore
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/lru_cache.h"
+#include "common/slot_vector.h"
+#include "common/types.h"
+
+namespace Vulkan {
+class Instance;
+}
+
+namespace VideoCore {
+
+class BufferCache;
+class TextureCache;
+
+/// Relative cost of recreating an evicted object the next time it is used.
+enum class EvictionCost : u32 {
+    Never = 0,    ///< Object cannot be evicted right now
+    Upload = 2,   ///< Contents are uploaded again from guest memory
+    Detile = 4,   ///< Contents are uploaded and detiled again
+    Download = 8, ///< Contents must be written back to guest memory before eviction
+};
+
+/**
+ * Keeps the device memory used by the texture and buffer caches within budget. Objects of both
+ * caches share a single least recently used list, so the oldest objects are considered first
+ * regardless of their kind. Among those, objects that free the most memory for the least work
+ * to recreate are evicted first. Collection runs once per submission with a time budget, so a
+ * large backlog is worked through over several frames instead of causing a hitch.
+ */
+class GarbageCollector {
+    static constexpr s64 DEFAULT_TRIGGER_GC_MEMORY = 1_GB;
+    static constexpr s64 DEFAULT_PRESSURE_GC_MEMORY = 2_GB;
+    static constexpr s64 DEFAULT_CRITICAL_GC_MEMORY = 3_GB;
+    static constexpr s64 TARGET_GC_THRESHOLD = 8_GB;
+
+public:
+    struct Object {
+        enum class Type : u32 {
+            Image,
+            Buffer,
+        };
+        Type type;
+        Common::SlotId id;
+        u64 size;
+    };
+
+    explicit GarbageCollector(const Vulkan::Instance& instance, TextureCache& texture_cache,
+                              BufferCache& buffer_cache);
+    ~GarbageCollector();
+
+    /// Starts tracking an object and accounts its size. Returns the id to refer to it with.
+    [[nodiscard]] u64 Track(Object object);
+
+    /// Stops tracking an object that was freed.
+    void Untrack(u64 lru_id, u64 size);
+
+    /// Marks an object as used by the current submission.
+    void Touch(u64 lru_id);
+
+    /// Evicts old objects until memory usage is within budget or the time budget runs out.
+    void Run();
+
+private:
+    struct Candidate {
+        Object object;
+        u64 score;
+    };
+
+    const Vulkan::Instance& instance;
+    TextureCache& texture_cache;
+    BufferCache& buffer_cache;
+    std::mutex mutex;
+    Common::LeastRecentlyUsedCache<Object, u64> lru_cache;
+    std::vector<Candidate> candidates;
+    u64 total_used_memory = 0;
+    u64 trigger_gc_memory = 0;
+    u64 pressure_gc_memory = 0;
+    u64 critical_gc_memory = 0;
+    u64 gc_tick = 0;
+};
+
+} // namespace VideoCore
@@ -1,8 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <bit>
 #include <boost/container/small_vector.hpp>
 #include "common/assert.h"
+#include "common/config.h"
 #include "common/debug.h"
 #include "common/div_ceil.h"
 #include "common/range_lock.h"
@@ -16,12 +18,17 @@
 #include <sys/mman.h>
 #include "common/adaptive_mutex.h"
 #ifdef ENABLE_USERFAULTFD
+#include <algorithm>
 #include <thread>
 #include <fcntl.h>
 #include <linux/userfaultfd.h>
 #include <poll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include "common/error.h"
+#include "common/thread.h"
 #endif
 #else
 #include <windows.h>
@@ -87,142 +94,320 @@ struct PageManager::Impl {
     static constexpr size_t ADDRESS_BITS = 40;
     static constexpr size_t NUM_ADDRESS_PAGES = 1ULL << (40 - PAGE_BITS);
     static constexpr size_t NUM_ADDRESS_LOCKS = NUM_ADDRESS_PAGES / PAGES_PER_LOCK;
+    static constexpr size_t PAGES_PER_WORD = 64;
+    static constexpr size_t NUM_ADDRESS_WORDS = NUM_ADDRESS_PAGES / PAGES_PER_WORD;
     inline static Vulkan::Rasterizer* rasterizer;
-#ifdef ENABLE_USERFAULTFD
+
     Impl(Vulkan::Rasterizer* rasterizer_) {
         rasterizer = rasterizer_;
-        uffd = syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
-        ASSERT_MSG(uffd != -1, "{}", Common::GetLastErrorMsg());
+#ifdef ENABLE_USERFAULTFD
+        if (Config::userfaultfd()) {
+            use_uffd = InitUserfaultfd();
+        }
+#endif
+        LOG_INFO(Render, "Tracking GPU memory writes using {}",
+                 use_uffd ? "userfaultfd" : "access violation signals");
 
-        // Request uffdio features from kernel.
-        uffdio_api api;
-        api.api = UFFD_API;
-        api.features = UFFD_FEATURE_THREAD_ID;
-        const int ret = ioctl(uffd, UFFDIO_API, &api);
-        ASSERT(ret == 0 && api.api == UFFD_API);
+        // Should be called first. Read watches, and write watches when userfaultfd is not
+        // available, are resolved by the signal handler.
+        constexpr auto priority = std::numeric_limits<u32>::min();
+        Core::Signals::Instance()->RegisterAccessViolationHandler(GuestFaultSignalHandler,
+                                                                  priority);
+    }
 
-        // Create uffd handler thread
-        ufd_thread = std::jthread([&](std::stop_token token) { UffdHandler(token); });
+    ~Impl() {
+#ifdef ENABLE_USERFAULTFD
+        if (use_uffd) {
+            uffd_thread.request_stop();
+            const u64 value = 1;
+            const ssize_t ret = write(stop_fd, &value, sizeof(value));
+            ASSERT_MSG(ret == sizeof(value), "Failed to signal userfaultfd handler");
+            uffd_thread.join();
+            close(stop_fd);
+            close(uffd);
+        }
+#endif
     }
 
     void OnMap(VAddr address, size_t size) {
-        uffdio_register reg;
-        reg.range.start = address;
-        reg.range.len = size;
-        reg.mode = UFFDIO_REGISTER_MODE_WP;
-        const int ret = ioctl(uffd, UFFDIO_REGISTER, &reg);
-        ASSERT_MSG(ret != -1, "Uffdio register failed");
+#ifdef ENABLE_USERFAULTFD
+        if (use_uffd) {
+            // Register the whole mapping once, individual pages are write protected on demand.
+            uffdio_register reg;
+            reg.range.start = address;
+            reg.range.len = size;
+            reg.mode = UFFDIO_REGISTER_MODE_WP;
+            const int ret = ioctl(uffd, UFFDIO_REGISTER, &reg);
+            ASSERT_MSG(ret != -1, "Uffdio register failed with error: {}",
+                       Common::GetLastErrorMsg());
+        }
+#endif
     }
 
     void OnUnmap(VAddr address, size_t size) {
-        uffdio_range range;
-        range.start = address;
-        range.len = size;
-        const int ret = ioctl(uffd, UFFDIO_UNREGISTER, &range);
-        ASSERT_MSG(ret != -1, "Uffdio unregister failed");
+#ifdef ENABLE_USERFAULTFD
+        if (use_uffd) {
+            uffdio_range range;
+            range.start = address;
+            range.len = size;
+            const int ret = ioctl(uffd, UFFDIO_UNREGISTER, &range);
+            ASSERT_MSG(ret != -1, "Uffdio unregister failed with error: {}",
+                       Common::GetLastErrorMsg());
+        }
+#endif
     }
 
+    template <bool is_read>
     void Protect(VAddr address, size_t size, Core::MemoryPermission perms) {
-        bool allow_write = True(perms & Core::MemoryPermission::Write);
+        RENDERER_TRACE;
+#ifdef ENABLE_USERFAULTFD
+        if (use_uffd) {
+            if constexpr (!is_read) {
+                // Write watches only change the userfaultfd write protection.
+                WriteProtect(address, size, False(perms & Core::MemoryPermission::Write));
+                return;
+            }
+            // Read watches still need page protection, but must not affect writes which are
+            // tracked by userfaultfd.
+            perms = True(perms & Core::MemoryPermission::Read) ? Core::MemoryPermission::ReadWrite
+                                                               : Core::MemoryPermission::None;
+        }
+#endif
+        auto* memory = Core::Memory::Instance();
+        auto& impl = memory->GetAddressSpace();
+        ASSERT_MSG(perms != Core::MemoryPermission::Write,
+                   "Attempted to protect region as write-only which is not a valid permission");
+        impl.Protect(address, size, perms);
+    }
+
+    static bool GuestFaultSignalHandler(void* context, void* fault_address) {
+        const auto addr = reinterpret_cast<VAddr>(fault_address);
+        if (Common::IsWriteError(context)) {
+            return rasterizer->InvalidateMemory(addr, 8);
+        } else {
+            return rasterizer->ReadMemory(addr, 8);
+        }
+        return false;
+    }
+
+#ifdef ENABLE_USERFAULTFD
+    bool InitUserfaultfd() {
+        uffd = syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+        if (uffd == -1) {
+            LOG_WARNING(Render, "Unable to create userfaultfd: {}", Common::GetLastErrorMsg());
+            return false;
+        }
+
+        // Request uffdio features from kernel. Dmem is backed by shared memory, which can only
+        // be write protected on kernels that support it.
+        uffdio_api api;
+        api.api = UFFD_API;
+        api.features = UFFD_FEATURE_WP_HUGETLBFS_SHMEM;
+        if (ioctl(uffd, UFFDIO_API, &api) != 0 || api.api != UFFD_API) {
+            LOG_WARNING(Render, "Kernel does not support userfaultfd write protection of "
+                                "shared memory");
+            close(uffd);
+            uffd = -1;
+            return false;
+        }
+
+        stop_fd = eventfd(0, EFD_CLOEXEC);
+        ASSERT_MSG(stop_fd != -1, "{}", Common::GetLastErrorMsg());
+
+        // Create uffd handler thread
+        uffd_thread = std::jthread([this](std::stop_token token) { UffdHandler(token); });
+        return true;
+    }
+
+    void WriteProtect(VAddr address, size_t size, bool protect) {
         uffdio_writeprotect wp;
         wp.range.start = address;
         wp.range.len = size;
-        wp.mode = allow_write ? 0 : UFFDIO_WRITEPROTECT_MODE_WP;
+        wp.mode = protect ? UFFDIO_WRITEPROTECT_MODE_WP : 0;
         const int ret = ioctl(uffd, UFFDIO_WRITEPROTECT, &wp);
         ASSERT_MSG(ret != -1, "Uffdio writeprotect failed with error: {}",
                    Common::GetLastErrorMsg());
     }
 
     void UffdHandler(std::stop_token token) {
+        Common::SetCurrentThreadName("shadPS4:UffdHandler");
+
+        static constexpr size_t MaxMessages = 64;
+        std::array<uffd_msg, MaxMessages> msgs;
+        std::array<pollfd, 2> pollfds{{{.fd = uffd, .events = POLLIN},
+                                       {.fd = stop_fd, .events = POLLIN}}};
         while (!token.stop_requested()) {
-            pollfd pollfd;
-            pollfd.fd = uffd;
-            pollfd.events = POLLIN;
-
-            // Block until the descriptor is ready for data reads.
-            const int pollres = poll(&pollfd, 1, -1);
-            switch (pollres) {
-            case -1:
-                perror("Poll userfaultfd");
-                continue;
-                break;
-            case 0:
+            // Block until the descriptor is ready for data reads or we are asked to stop.
+            const int pollres = poll(pollfds.data(), pollfds.size(), -1);
+            if (pollres == -1) {
+                ASSERT_MSG(errno == EINTR, "Poll userfaultfd failed with error: {}",
+                           Common::GetLastErrorMsg());
                 continue;
-            case 1:
-                break;
-            default:
-                UNREACHABLE_MSG("Unexpected number of descriptors {} out of poll", pollres);
             }
 
             // We don't want an error condition to have occured.
-            ASSERT_MSG(!(pollfd.revents & POLLERR), "POLLERR on userfaultfd");
+            ASSERT_MSG(!(pollfds[0].revents & POLLERR), "POLLERR on userfaultfd");
 
             // We waited until there is data to read, we don't care about anything else.
-            if (!(pollfd.revents & POLLIN)) {
+            if (!(pollfds[0].revents & POLLIN)) {
                 continue;
             }
 
-            // Read message from kernel.
-            uffd_msg msg;
-            const int readret = read(uffd, &msg, sizeof(msg));
-            ASSERT_MSG(readret != -1 || errno == EAGAIN, "Unexpected result of uffd read");
-            if (errno == EAGAIN) {
+            // Drain all pending faults at once.
+            const ssize_t readret = read(uffd, msgs.data(), sizeof(msgs));
+            if (readret == -1) {
+                ASSERT_MSG(errno == EAGAIN, "Unexpected result of uffd read: {}",
+                           Common::GetLastErrorMsg());
                 continue;
             }
-            ASSERT_MSG(readret == sizeof(msg), "Unexpected short read, exiting");
-            ASSERT(msg.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP);
+            ASSERT_MSG(readret % sizeof(uffd_msg) == 0, "Unexpected short uffd read");
+
+            const size_t num_msgs = readret / sizeof(uffd_msg);
+            for (size_t i = 0; i < num_msgs; ++i) {
+                const uffd_msg& msg = msgs[i];
+                ASSERT(msg.event == UFFD_EVENT_PAGEFAULT);
+                ASSERT(msg.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP);
+
+                // Several threads may fault on the same page, invalidate it only once.
+                const VAddr page_addr = Common::AlignDown(msg.arg.pagefault.address, PAGE_SIZE);
+                const auto it = std::find_if(msgs.begin(), msgs.begin() + i, [&](const auto& m) {
+                    return Common::AlignDown(m.arg.pagefault.address, PAGE_SIZE) == page_addr;
+                });
+                if (it != msgs.begin() + i) {
+                    continue;
+                }
 
-            // Notify rasterizer about the fault.
-            const VAddr addr = msg.arg.pagefault.address;
-            rasterizer->InvalidateMemory(addr, 1);
+                // Notify rasterizer about the fault, which removes the write protection and
+                // wakes the faulting threads. If the memory is not tracked anymore, unprotect it
+                // here so the faulting threads do not wait forever.
+                if (!rasterizer->InvalidateMemory(page_addr, 1)) {
+                    WriteProtect(page_addr, PAGE_SIZE, false);
+                }
+            }
         }
     }
 
-    std::jthread ufd_thread;
-    int uffd;
-#else
-    Impl(Vulkan::Rasterizer* rasterizer_) {
-        rasterizer = rasterizer_;
+    std::jthread uffd_thread;
+    int uffd{-1};
+    int stop_fd{-1};
+#endif
 
-        // Should be called first.
-        constexpr auto priority = std::numeric_limits<u32>::min();
-        Core::Signals::Instance()->RegisterAccessViolationHandler(GuestFaultSignalHandler,
-                                                                  priority);
+    Core::MemoryPermission PermsAt(u64 page) const noexcept {
+        const u64 word = page / PAGES_PER_WORD;
+        const u64 bit = 1ULL << (page % PAGES_PER_WORD);
+        const auto read_perm = (read_watched[word] & bit) ? Core::MemoryPermission::None
+                                                           : Core::MemoryPermission::Read;
+        const auto write_perm = (write_watched[word] & bit) ? Core::MemoryPermission::None
+                                                             : Core::MemoryPermission::Write;
+        return read_perm | write_perm;
     }
 
-    void OnMap(VAddr address, size_t size) {
-        // No-op
-    }
+    /**
+     * Applies a watcher delta to the pages in [page, page_end) selected by update_mask, which
+     * returns the pages to update for a given bitmap word. The watch bitmaps are then scanned
+     * a word at a time to find the runs of equal protection, and a single Protect call is issued
+     * for the span of pages inside each run whose protection actually changed.
+     */
+    template <bool track, bool is_read, typename UpdateMask>
+    void UpdateWatchedPages(u64 page, u64 page_end, UpdateMask&& update_mask) {
+        if (page >= page_end) {
+            return;
+        }
 
-    void OnUnmap(VAddr address, size_t size) {
-        // No-op
-    }
+        auto& watched = is_read ? read_watched : write_watched;
+        auto perms = Core::MemoryPermission::None;
+        u64 range_begin = 0;
+        u64 range_end = 0;
 
-    void Protect(VAddr address, size_t size, Core::MemoryPermission perms) {
-        RENDERER_TRACE;
-        auto* memory = Core::Memory::Instance();
-        auto& impl = memory->GetAddressSpace();
-        ASSERT_MSG(perms != Core::MemoryPermission::Write,
-                   "Attempted to protect region as write-only which is not a valid permission");
-        impl.Protect(address, size, perms);
-    }
+        const auto release_pending = [&] {
+            if (range_end > range_begin) {
+                RENDERER_TRACE;
+                // Perform pending (un)protect action
+                Protect<is_read>(range_begin << PAGE_BITS, (range_end - range_begin) << PAGE_BITS,
+                                 perms);
+                range_begin = 0;
+                range_end = 0;
+            }
+        };
 
-    static bool GuestFaultSignalHandler(void* context, void* fault_address) {
-        const auto addr = reinterpret_cast<VAddr>(fault_address);
-        if (Common::IsWriteError(context)) {
-            return rasterizer->InvalidateMemory(addr, 8);
-        } else {
-            return rasterizer->ReadMemory(addr, 8);
+        const u64 first_word = page / PAGES_PER_WORD;
+        const u64 last_word = (page_end - 1) / PAGES_PER_WORD;
+        for (u64 word = first_word; word <= last_word; ++word) {
+            const u64 word_page = word * PAGES_PER_WORD;
+            u64 span = ~0ULL;
+            if (word == first_word) {
+                span &= ~0ULL << (page % PAGES_PER_WORD);
+            }
+            if (word == last_word && page_end % PAGES_PER_WORD != 0) {
+                span &= ~0ULL >> (PAGES_PER_WORD - page_end % PAGES_PER_WORD);
+            }
+
+            // Apply the change to the page states, collecting the pages that must be
+            // (un)protected, and mirror them in the watch bitmap.
+            u64 changed = 0;
+            for (u64 pending = update_mask(word) & span; pending != 0; pending &= pending - 1) {
+                const int bit = std::countr_zero(pending);
+                PageState& state = cached_pages[word_page + bit];
+                const u8 new_count = state.AddDelta<track ? 1 : -1, is_read>();
+                if (new_count == (track ? 1 : 0)) {
+                    changed |= 1ULL << bit;
+                }
+            }
+            if constexpr (track) {
+                watched[word] |= changed;
+            } else {
+                watched[word] &= ~changed;
+            }
+
+            // Mark the pages whose protection differs from the previous page. The first page of
+            // the range always starts a new run.
+            const u64 write_bits = write_watched[word];
+            const u64 read_bits = read_watched[word];
+            u64 boundaries;
+            if (word == first_word) {
+                boundaries = ((write_bits ^ (write_bits << 1)) | (read_bits ^ (read_bits << 1)) |
+                              (1ULL << (page % PAGES_PER_WORD))) &
+                             span;
+            } else {
+                const u64 write_carry = write_watched[word - 1] >> (PAGES_PER_WORD - 1);
+                const u64 read_carry = read_watched[word - 1] >> (PAGES_PER_WORD - 1);
+                boundaries = ((write_bits ^ ((write_bits << 1) | write_carry)) |
+                              (read_bits ^ ((read_bits << 1) | read_carry))) &
+                             span;
+            }
+
+            // Walk the runs of equal protection in this word
+            while (true) {
+                const u64 next = boundaries != 0 ? std::countr_zero(boundaries) : PAGES_PER_WORD;
+                const u64 below = next == PAGES_PER_WORD ? ~0ULL : (1ULL << next) - 1;
+                if (const u64 run = changed & below; run != 0) {
+                    if (range_end == range_begin) {
+                        // Start a new range
+                        range_begin = word_page + std::countr_zero(run);
+                    }
+                    // Extend the current range over pages with the same protection
+                    range_end = word_page + PAGES_PER_WORD - std::countl_zero(run);
+                    changed &= ~below;
+                }
+                if (next == PAGES_PER_WORD) {
+                    break;
+                }
+                // The protection changed, add pending (un)protect action
+                release_pending();
+                perms = PermsAt(word_page + next);
+                boundaries &= boundaries - 1;
+            }
         }
-        return false;
+
+        // Add pending (un)protect action
+        release_pending();
     }
-#endif
 
     template <bool track, bool is_read>
     void UpdatePageWatchers(VAddr addr, u64 size) {
         RENDERER_TRACE;
 
-        size_t page = addr >> PAGE_BITS;
+        const u64 page = addr >> PAGE_BITS;
         const u64 page_end = Common::DivCeil(addr + size, PAGE_SIZE);
 
         // Acquire locks for the range of pages
@@ -230,22 +415,6 @@ struct PageManager::Impl {
         const auto lock_end = locks.begin() + Common::DivCeil(page_end, PAGES_PER_LOCK);
         Common::RangeLockGuard lk(lock_start, lock_end);
 
-        auto perms = cached_pages[page].Perms();
-        u64 range_begin = 0;
-        u64 range_bytes = 0;
-        u64 potential_range_bytes = 0;
-
-        const auto release_pending = [&] {
-            if (range_bytes > 0) {
-                RENDERER_TRACE;
-                // Perform pending (un)protect action
-                Protect(range_begin << PAGE_BITS, range_bytes, perms);
-                range_bytes = 0;
-                potential_range_bytes = 0;
-            }
-        };
-
-        // Iterate requested pages
         const u64 aligned_addr = page << PAGE_BITS;
         const u64 aligned_end = page_end << PAGE_BITS;
         if (!rasterizer->IsMapped(aligned_addr, aligned_end - aligned_addr)) {
@@ -254,114 +423,37 @@ struct PageManager::Impl {
                         aligned_addr, aligned_end);
         }
 
-        for (; page != page_end; ++page) {
-            PageState& state = cached_pages[page];
-
-            // Apply the change to the page state
-            const u8 new_count = state.AddDelta<track ? 1 : -1, is_read>();
-
-            if (auto new_perms = state.Perms(); new_perms != perms) [[unlikely]] {
-                // If the protection changed add pending (un)protect action
-                release_pending();
-                perms = new_perms;
-            } else if (range_bytes != 0) {
-                // If the protection did not change, extend the potential range
-                potential_range_bytes += PAGE_SIZE;
-            }
-
-            // Only start a new range if the page must be (un)protected
-            if ((new_count == 0 && !track) || (new_count == 1 && track)) {
-                if (range_bytes == 0) {
-                    // Start a new potential range
-                    range_begin = page;
-                    potential_range_bytes = PAGE_SIZE;
-                }
-                // Extend current range up to potential range
-                range_bytes = potential_range_bytes;
-            }
-        }
-
-        // Add pending (un)protect action
-        release_pending();
+        UpdateWatchedPages<track, is_read>(page, page_end, [](u64) { return ~0ULL; });
     }
 
     template <bool track, bool is_read>
     void UpdatePageWatchersForRegion(VAddr base_addr, RegionBits& mask) {
         RENDERER_TRACE;
-        auto start_range = mask.FirstRange();
-        auto end_range = mask.LastRange();
-
-        if (start_range.second == end_range.second) {
-            // if all pages are contiguous, use the regular UpdatePageWatchers
-            const VAddr start_addr = base_addr + (start_range.first << PAGE_BITS);
-            const u64 size = (start_range.second - start_range.first) << PAGE_BITS;
-            return UpdatePageWatchers<track, is_read>(start_addr, size);
-        }
+        const auto start_range = mask.FirstRange();
+        const auto end_range = mask.LastRange();
 
-        size_t base_page = (base_addr >> PAGE_BITS);
+        const u64 base_page = base_addr >> PAGE_BITS;
         ASSERT(base_page % PAGES_PER_LOCK == 0);
         std::scoped_lock lk(locks[base_page / PAGES_PER_LOCK]);
-        auto perms = cached_pages[base_page + start_range.first].Perms();
-        u64 range_begin = 0;
-        u64 range_bytes = 0;
-        u64 potential_range_bytes = 0;
-
-        const auto release_pending = [&] {
-            if (range_bytes > 0) {
-                RENDERER_TRACE;
-                // Perform pending (un)protect action
-                Protect((range_begin << PAGE_BITS), range_bytes, perms);
-                range_bytes = 0;
-                potential_range_bytes = 0;
-            }
-        };
-
-        // Iterate pages
-        for (size_t page = start_range.first; page < end_range.second; ++page) {
-            PageState& state = cached_pages[base_page + page];
-            const bool update = mask.Get(page);
-
-            // Apply the change to the page state
-            const u8 new_count =
-                update ? state.AddDelta<track ? 1 : -1, is_read>() : state.AddDelta<0, is_read>();
-
-            if (auto new_perms = state.Perms(); new_perms != perms) [[unlikely]] {
-                // If the protection changed add pending (un)protect action
-                release_pending();
-                perms = new_perms;
-            } else if (range_bytes != 0) {
-                // If the protection did not change, extend the potential range
-                potential_range_bytes += PAGE_SIZE;
-            }
 
-            // If the page is not being updated, skip it
-            if (!update) {
-                continue;
-            }
-
-            // If the page must be (un)protected
-            if ((new_count == 0 && !track) || (new_count == 1 && track)) {
-                if (range_bytes == 0) {
-                    // Start a new potential range
-                    range_begin = base_page + page;
-                    potential_range_bytes = PAGE_SIZE;
-                }
-                // Extend current rango up to potential range
-                range_bytes = potential_range_bytes;
-            }
-        }
-
-        // Add pending (un)protect action
-        release_pending();
+        // Regions are lock aligned, so the mask words line up with the bitmap words.
+        const u64 base_word = base_page / PAGES_PER_WORD;
+        UpdateWatchedPages<track, is_read>(
+            base_page + start_range.first, base_page + end_range.second,
+            [&](u64 word) { return mask.GetWord(word - base_word); });
     }
 
     std::array<PageState, NUM_ADDRESS_PAGES> cached_pages{};
+    // One bit per page with at least one watcher, kept in sync with cached_pages.
+    std::array<u64, NUM_ADDRESS_WORDS> write_watched{};
+    std::array<u64, NUM_ADDRESS_WORDS> read_watched{};
 #ifdef __linux__
     using LockType = Common::AdaptiveMutex;
 #else
     using LockType = Common::SpinLock;
 #endif
     std::array<LockType, NUM_ADDRESS_LOCKS> locks{};
+    bool use_uffd{};
 };
 
 PageManager::PageManager(Vulkan::Rasterizer* rasterizer_)
@@ -107,7 +107,24 @@ public:
                          VertexInputs<AmdGpu::Buffer>& guest_buffers, u32 step_rate_0,
                          u32 step_rate_1) const;
 
+    /// Fills the parts of sdata that depend on the current guest state. A pipeline created with
+    /// preloading set only reads sdata, so it can then be built outside of the GPU thread.
+    static void PrepareSerializationSupport(
+        const Instance& instance, const GraphicsPipelineKey& key,
+        std::span<const Shader::Info*, MaxShaderStages> infos,
+        std::span<const Shader::RuntimeInfo, MaxShaderStages> runtime_infos,
+        const std::optional<const Shader::Gcn::FetchShaderData>& fetch_shader,
+        SerializationSupport& sdata);
+
 private:
+    template <typename Attribute, typename Binding>
+    static void CollectVertexInputs(
+        const std::optional<const Shader::Gcn::FetchShaderData>& fetch_shader,
+        const Shader::Info* vs_stage, VertexInputs<Attribute>& attributes,
+        VertexInputs<Binding>& bindings,
+        VertexInputs<vk::VertexInputBindingDivisorDescriptionEXT>& divisors,
+        VertexInputs<AmdGpu::Buffer>& guest_buffers, u32 step_rate_0, u32 step_rate_1);
+
     void BuildDescSetLayout(bool preloading);
 
 private:
@@ -335,6 +335,14 @@ bool Instance::CreateDevice() {
 #endif
 
     supports_memory_budget = add_extension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    external_memory_host = add_extension(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+    if (external_memory_host) {
+        const vk::StructureChain host_properties_chain =
+            physical_device.getProperties2<vk::PhysicalDeviceProperties2,
+                                           vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>();
+        external_memory_host_props =
+            host_properties_chain.get<vk::PhysicalDeviceExternalMemoryHostPropertiesEXT>();
+    }
 
     const auto family_properties = physical_device.getQueueFamilyProperties();
     if (family_properties.empty()) {
@@ -416,6 +416,16 @@ public:
         return features.logicOp;
     }
 
+    /// Returns true when host memory can be imported for the GPU to access in place.
+    bool IsExternalMemoryHostSupported() const {
+        return external_memory_host;
+    }
+
+    /// Returns the required alignment of imported host memory addresses and sizes.
+    u64 GetMinImportedHostPointerAlignment() const {
+        return external_memory_host_props.minImportedHostPointerAlignment;
+    }
+
     /// Returns whether the device can report memory usage.
     bool CanReportMemoryUsage() const {
         return supports_memory_budget;
@@ -456,6 +466,7 @@ private:
     vk::PhysicalDeviceVulkan11Properties vk11_props;
     vk::PhysicalDeviceVulkan12Properties vk12_props;
     vk::PhysicalDevicePushDescriptorPropertiesKHR push_descriptor_props;
+    vk::PhysicalDeviceExternalMemoryHostPropertiesEXT external_memory_host_props;
     vk::PhysicalDeviceFeatures features;
     vk::PhysicalDeviceVulkan12Features vk12_features;
     vk::PhysicalDevicePortabilitySubsetFeaturesKHR portability_features;
@@ -499,6 +510,7 @@ private:
     bool portability_subset{};
     bool maintenance_8{};
     bool attachment_feedback_loop{};
+    bool external_memory_host{};
     bool supports_memory_budget{};
     u64 total_memory_budget{};
     std::vector<size_t> valid_heaps;
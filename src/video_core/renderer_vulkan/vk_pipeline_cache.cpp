@@ -7,10 +7,12 @@
 #include "common/hash.h"
 #include "common/io_file.h"
 #include "common/path_util.h"
+#include "common/thread.h"
 #include "core/debug_state.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
 #include "shader_recompiler/info.h"
 #include "shader_recompiler/recompiler.h"
+#include "shader_recompiler/recompiler_corpus.h"
 #include "shader_recompiler/runtime_info.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/cache_storage.h"
@@ -159,7 +161,8 @@ const Shader::RuntimeInfo& PipelineCache::BuildRuntimeInfo(Stage stage, LogicalS
         const auto params_vc = AmdGpu::GetParams(regs.vs_program);
         gs_info.vs_copy = params_vc.code;
         gs_info.vs_copy_hash = params_vc.hash;
-        DumpShader(gs_info.vs_copy, gs_info.vs_copy_hash, Shader::Stage::Vertex, 0, "copy.bin");
+        DumpShader(std::as_bytes(gs_info.vs_copy), gs_info.vs_copy_hash, Shader::Stage::Vertex, 0,
+                   "copy.bin");
         break;
     }
     case Stage::Fragment: {
@@ -274,62 +277,178 @@ PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
     ASSERT_MSG(cache_result == vk::Result::eSuccess, "Failed to create pipeline cache: {}",
                vk::to_string(cache_result));
     pipeline_cache = std::move(cache);
+
+    const auto mode = Config::getPipelineCompileMode();
+    if (mode == "skip") {
+        compile_mode = CompileMode::Skip;
+    } else if (mode == "stall") {
+        compile_mode = CompileMode::Stall;
+    } else if (mode != "sync") {
+        LOG_WARNING(Render_Vulkan, "Unknown pipeline compile mode {}, using sync", mode);
+    }
+    if (compile_mode != CompileMode::Sync) {
+        const u32 num_workers = std::max(std::thread::hardware_concurrency() / 2, 1U);
+        LOG_INFO(Render_Vulkan, "Compiling pipelines asynchronously on {} workers ({})",
+                 num_workers, mode);
+        compile_workers.reserve(num_workers);
+        for (u32 i = 0; i < num_workers; ++i) {
+            compile_workers.emplace_back(std::bind_front(&PipelineCache::CompileWorker, this));
+        }
+    }
+}
+
+PipelineCache::~PipelineCache() {
+    // Stop all workers before joining any, as idle workers queue up on the same lock.
+    for (auto& worker : compile_workers) {
+        worker.request_stop();
+    }
+    if (compile_mode != CompileMode::Sync) {
+        LOG_INFO(Render_Vulkan, "Async pipeline compilation skipped {} draws, stalled {}",
+                 num_skipped_draws, num_stalled_draws);
+    }
+}
+
+void PipelineCache::CompileWorker(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("shadPS4:PipelineCompile");
+    while (!stop_token.stop_requested()) {
+        std::packaged_task<void()> job{};
+        compile_queue.PopWait(job, stop_token);
+        if (job.valid()) {
+            job();
+        }
+    }
+}
+
+template <typename Pipeline>
+std::unique_ptr<Pipeline> PipelineCache::WaitPipeline(PendingPipeline<Pipeline>& pending,
+                                                      bool can_skip) {
+    using namespace std::chrono_literals;
+    if (pending.pipeline.wait_for(0s) != std::future_status::ready) {
+        if (can_skip && compile_mode == CompileMode::Skip) {
+            ++num_skipped_draws;
+            return nullptr;
+        }
+        ++num_stalled_draws;
+    }
+    return pending.pipeline.get();
+}
+
+const GraphicsPipeline* PipelineCache::PublishGraphicsPipeline(
+    const GraphicsPipelineKey& key, std::unique_ptr<GraphicsPipeline> pipeline, u64 pipeline_hash,
+    GraphicsPipeline::SerializationSupport& sdata,
+    const std::array<vk::ShaderModule, MaxShaderStages>& stage_modules) {
+    RegisterPipelineData(key, pipeline_hash, sdata);
+    ++num_new_pipelines;
+
+    if (Config::collectShadersForDebug()) {
+        for (auto stage = 0; stage < MaxShaderStages; ++stage) {
+            if (key.stage_hashes[stage]) {
+                module_related_pipelines[stage_modules[stage]].emplace_back(key);
+            }
+        }
+    }
+    const auto [it, _] = graphics_pipelines.emplace(key, std::move(pipeline));
+    return it->second.get();
 }
 
-PipelineCache::~PipelineCache() = default;
+const ComputePipeline* PipelineCache::PublishComputePipeline(
+    const ComputePipelineKey& key, std::unique_ptr<ComputePipeline> pipeline,
+    ComputePipeline::SerializationSupport& sdata, vk::ShaderModule module) {
+    RegisterPipelineData(key, sdata);
+    ++num_new_pipelines;
+
+    if (Config::collectShadersForDebug()) {
+        module_related_pipelines[module].emplace_back(key);
+    }
+    const auto [it, _] = compute_pipelines.emplace(key, std::move(pipeline));
+    return it->second.get();
+}
+
+void PipelineCache::FlushPendingPipelines() {
+    for (auto& [key, pending] : pending_graphics_pipelines) {
+        auto pipeline = WaitPipeline(*pending, false);
+        PublishGraphicsPipeline(key, std::move(pipeline), pending->hash, pending->sdata,
+                                pending->modules);
+    }
+    pending_graphics_pipelines.clear();
+}
 
 const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
     if (!RefreshGraphicsKey()) {
         return nullptr;
     }
-    const auto [it, is_new] = graphics_pipelines.try_emplace(graphics_key);
-    if (is_new) {
-        const auto pipeline_hash = std::hash<GraphicsPipelineKey>{}(graphics_key);
+    if (const auto it = graphics_pipelines.find(graphics_key); it != graphics_pipelines.end()) {
+        return it->second.get();
+    }
+
+    const auto pipeline_hash = std::hash<GraphicsPipelineKey>{}(graphics_key);
+    if (compile_mode == CompileMode::Sync) {
         LOG_INFO(Render_Vulkan, "Compiling graphics pipeline {:#x}", pipeline_hash);
 
         GraphicsPipeline::SerializationSupport sdata{};
-        it.value() = std::make_unique<GraphicsPipeline>(
+        auto pipeline = std::make_unique<GraphicsPipeline>(
             instance, scheduler, desc_heap, profile, graphics_key, *pipeline_cache, infos,
             runtime_infos, fetch_shader, modules, sdata, false);
+        fetch_shader.reset();
+        return PublishGraphicsPipeline(graphics_key, std::move(pipeline), pipeline_hash, sdata,
+                                       modules);
+    }
 
-        RegisterPipelineData(graphics_key, pipeline_hash, sdata);
-        ++num_new_pipelines;
-
-        if (Config::collectShadersForDebug()) {
-            for (auto stage = 0; stage < MaxShaderStages; ++stage) {
-                if (infos[stage]) {
-                    auto& m = modules[stage];
-                    module_related_pipelines[m].emplace_back(graphics_key);
-                }
-            }
-        }
+    auto [it, is_new] = pending_graphics_pipelines.try_emplace(graphics_key);
+    if (is_new) {
+        LOG_INFO(Render_Vulkan, "Queueing graphics pipeline {:#x}", pipeline_hash);
+
+        auto& pending = it.value();
+        pending = std::make_unique<PendingPipeline<GraphicsPipeline>>();
+        pending->modules = modules;
+        pending->hash = pipeline_hash;
+
+        // Guest state is read here, on the submitting thread. The stage infos still point into the
+        // cached programs, whose user data is refreshed by later draws, so the worker builds with
+        // preloading set and only reads resource lists and hashes fixed at program creation.
+        GraphicsPipeline::PrepareSerializationSupport(instance, graphics_key, infos, runtime_infos,
+                                                      fetch_shader, pending->sdata);
+        std::packaged_task<std::unique_ptr<GraphicsPipeline>()> task{
+            [this, key = graphics_key, stage_infos = infos, stage_runtime_infos = runtime_infos,
+             fetch = fetch_shader, stage_modules = modules, sdata = &pending->sdata]() mutable {
+                return std::make_unique<GraphicsPipeline>(
+                    instance, scheduler, desc_heap, profile, key, *pipeline_cache, stage_infos,
+                    stage_runtime_infos, fetch, stage_modules, *sdata, true);
+            }};
+        pending->pipeline = task.get_future();
+        compile_queue.EmplaceWait(std::move(task));
         fetch_shader.reset();
     }
-    return it->second.get();
+
+    auto& pending = *it.value();
+    auto pipeline = WaitPipeline(pending, true);
+    if (!pipeline) {
+        return nullptr;
+    }
+    const auto* published = PublishGraphicsPipeline(graphics_key, std::move(pipeline),
+                                                    pending.hash, pending.sdata, pending.modules);
+    pending_graphics_pipelines.erase(graphics_key);
+    return published;
 }
 
 const ComputePipeline* PipelineCache::GetComputePipeline() {
     if (!RefreshComputeKey()) {
         return nullptr;
     }
-    const auto [it, is_new] = compute_pipelines.try_emplace(compute_key);
-    if (is_new) {
-        const auto pipeline_hash = std::hash<ComputePipelineKey>{}(compute_key);
-        LOG_INFO(Render_Vulkan, "Compiling compute pipeline {:#x}", pipeline_hash);
-
-        ComputePipeline::SerializationSupport sdata{};
-        it.value() = std::make_unique<ComputePipeline>(instance, scheduler, desc_heap, profile,
-                                                       *pipeline_cache, compute_key, *infos[0],
-                                                       modules[0], sdata, false);
-        RegisterPipelineData(compute_key, sdata);
-        ++num_new_pipelines;
-
-        if (Config::collectShadersForDebug()) {
-            auto& m = modules[0];
-            module_related_pipelines[m].emplace_back(compute_key);
-        }
+    if (const auto it = compute_pipelines.find(compute_key); it != compute_pipelines.end()) {
+        return it->second.get();
     }
-    return it->second.get();
+
+    // Compute pipelines are always created inline. Dispatches are never skipped, as later work
+    // usually consumes their results, so handing them to a worker would only add a wait.
+    const auto pipeline_hash = std::hash<ComputePipelineKey>{}(compute_key);
+    LOG_INFO(Render_Vulkan, "Compiling compute pipeline {:#x}", pipeline_hash);
+
+    ComputePipeline::SerializationSupport sdata{};
+    auto pipeline = std::make_unique<ComputePipeline>(instance, scheduler, desc_heap, profile,
+                                                      *pipeline_cache, compute_key, *infos[0],
+                                                      modules[0], sdata, false);
+    return PublishComputePipeline(compute_key, std::move(pipeline), sdata, modules[0]);
 }
 
 bool PipelineCache::RefreshGraphicsKey() {
@@ -534,11 +653,18 @@ vk::ShaderModule PipelineCache::CompileModule(Shader::Info& info, Shader::Runtim
                                               Shader::Backend::Bindings& binding) {
     LOG_INFO(Render_Vulkan, "Compiling {} shader {:#x} {}", info.stage, info.pgm_hash,
              perm_idx != 0 ? "(permutation)" : "");
-    DumpShader(code, info.pgm_hash, info.stage, perm_idx, "bin");
+    DumpShader(std::as_bytes(code), info.pgm_hash, info.stage, perm_idx, "bin");
 
+    // Passes may update the runtime info, keep what the translation started from for the dump.
+    const auto input_runtime_info = runtime_info;
     const auto ir_program = Shader::TranslateProgram(code, pools, info, runtime_info, profile);
+    if (Config::dumpShaders()) {
+        const auto input =
+            Shader::SerializeTranslationInput(ir_program, input_runtime_info, profile);
+        DumpShader(std::as_bytes(std::span{input}), info.pgm_hash, info.stage, perm_idx, "input");
+    }
     auto spv = Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, ir_program, binding);
-    DumpShader(spv, info.pgm_hash, info.stage, perm_idx, "spv");
+    DumpShader(std::as_bytes(std::span{spv}), info.pgm_hash, info.stage, perm_idx, "spv");
 
     vk::ShaderModule module;
 
@@ -557,7 +683,8 @@ vk::ShaderModule PipelineCache::CompileModule(Shader::Info& info, Shader::Runtim
     Vulkan::SetObjectName(instance.GetDevice(), module, name);
     if (Config::collectShadersForDebug()) {
         DebugState.CollectShader(name, info.l_stage, module, spv, code,
-                                 patch ? *patch : std::span<const u32>{}, is_patched);
+                                 patch ? *patch : std::span<const u32>{}, ir_program.pass_stats,
+                                 is_patched);
     }
     return module;
 }
@@ -586,6 +713,17 @@ PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stag
     info.pgm_base = params.Base(); // Needs to be actualized for inline cbuffer address fixup
     info.user_data = params.user_data;
     info.RefreshFlatBuf();
+
+    // Consecutive draws often bind the shader with unchanged user data, reuse the permutation
+    // of the previous lookup then without building a new specialization.
+    if (const auto last_idx = program->FindLastPermut(runtime_info, binding); last_idx) {
+        info.AddBindings(binding);
+        const auto& last_module = program->modules[*last_idx];
+        return std::make_tuple(&info, last_module.module, last_module.spec.fetch_shader_data,
+                               HashCombine(params.hash, *last_idx));
+    }
+
+    const auto start = binding;
     auto spec = Shader::StageSpecialization(info, runtime_info, profile, binding);
 
     size_t perm_idx = program->modules.size();
@@ -593,7 +731,7 @@ PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stag
 
     vk::ShaderModule module{};
 
-    const auto it = std::ranges::find(program->modules, spec, &Program::Module::spec);
+    const auto it = program->FindPermut(spec);
     if (it == program->modules.end()) {
         auto new_info = Shader::Info(stage, l_stage, params);
         module = CompileModule(new_info, runtime_info, params.code, perm_idx, binding);
@@ -606,12 +744,16 @@ PipelineCache::Result PipelineCache::GetProgram(Stage stage, LogicalStage l_stag
         perm_idx = std::distance(program->modules.begin(), it);
         perm_hash = HashCombine(params.hash, perm_idx);
     }
+    program->SetLastPermut(runtime_info, start, perm_idx);
     return std::make_tuple(&program->info, module,
                            program->modules[perm_idx].spec.fetch_shader_data, perm_hash);
 }
 
 std::optional<vk::ShaderModule> PipelineCache::ReplaceShader(vk::ShaderModule module,
                                                              std::span<const u32> spv_code) {
+    // Pending pipelines may still reference the module being replaced.
+    FlushPendingPipelines();
+
     std::optional<vk::ShaderModule> new_module{};
     for (const auto& [_, program] : program_cache) {
         for (auto& m : program->modules) {
@@ -646,7 +788,7 @@ std::string PipelineCache::GetShaderName(Shader::Stage stage, u64 hash,
     return fmt::format("{}_{:#018x}", stage, hash);
 }
 
-void PipelineCache::DumpShader(std::span<const u32> code, u64 hash, Shader::Stage stage,
+void PipelineCache::DumpShader(std::span<const std::byte> data, u64 hash, Shader::Stage stage,
                                size_t perm_idx, std::string_view ext) {
     if (!Config::dumpShaders()) {
         return;
@@ -659,7 +801,7 @@ void PipelineCache::DumpShader(std::span<const u32> code, u64 hash, Shader::Stag
     }
     const auto filename = fmt::format("{}.{}", GetShaderName(stage, hash, perm_idx), ext);
     const auto file = IOFile{dump_dir / filename, FileAccessMode::Create};
-    file.WriteSpan(code);
+    file.WriteSpan(data);
 }
 
 std::optional<std::vector<u32>> PipelineCache::GetShaderPatch(u64 hash, Shader::Stage stage,
@@ -3,8 +3,14 @@
 
 #pragma once
 
+#include <cstring>
+#include <functional>
+#include <future>
+#include <optional>
+#include <thread>
 #include <variant>
 #include <tsl/robin_map.h>
+#include "common/bounded_threadsafe_queue.h"
 #include "shader_recompiler/profile.h"
 #include "shader_recompiler/recompiler.h"
 #include "shader_recompiler/specialization.h"
@@ -45,8 +51,19 @@ struct Program {
     static constexpr size_t MaxPermutations = 8;
     using ModuleList = boost::container::small_vector<Module, MaxPermutations>;
 
+    /// Inputs of the most recent permutation lookup.
+    struct LastLookup {
+        std::vector<u32> flattened_ud_buf;
+        boost::container::small_vector<AmdGpu::Buffer, 32> vs_sharps;
+        Shader::RuntimeInfo runtime_info{};
+        Shader::Backend::Bindings start{};
+        size_t perm_idx{};
+        bool valid{};
+    };
+
     Shader::Info info;
     ModuleList modules{};
+    LastLookup last_lookup{};
 
     Program() = default;
     Program(Shader::Stage stage, Shader::LogicalStage l_stage, Shader::ShaderParams params)
@@ -60,6 +77,60 @@ struct Program {
                       size_t perm_idx) {
         modules.resize(std::max(modules.size(), perm_idx + 1)); // <-- beware of realloc
         modules[perm_idx] = {module, std::move(spec)};
+        last_lookup.valid = false;
+    }
+
+    /// Finds a permutation matching the specialization, comparing digests before the full key.
+    ModuleList::iterator FindPermut(const Shader::StageSpecialization& spec) {
+        return std::ranges::find_if(modules, [&spec](const Module& m) {
+            return m.spec.digest == spec.digest && m.spec == spec;
+        });
+    }
+
+    /**
+     * Returns the permutation of the previous lookup if the bound user data, the flattened
+     * sharps and the runtime info are unchanged. Vertex buffer sharps are read through user data
+     * pointers and are compared separately.
+     */
+    std::optional<size_t> FindLastPermut(const Shader::RuntimeInfo& runtime_info,
+                                         const Shader::Backend::Bindings& start) const {
+        if (!last_lookup.valid || last_lookup.start != start ||
+            !(last_lookup.runtime_info == runtime_info) ||
+            last_lookup.flattened_ud_buf != info.flattened_ud_buf) {
+            return std::nullopt;
+        }
+        const auto& fetch_shader_data = modules[last_lookup.perm_idx].spec.fetch_shader_data;
+        if (info.stage == Shader::Stage::Vertex && fetch_shader_data) {
+            const auto& attributes = fetch_shader_data->attributes;
+            for (size_t i = 0; i < attributes.size(); i++) {
+                const auto sharp = attributes[i].GetSharp(info);
+                if (std::memcmp(&sharp, &last_lookup.vs_sharps[i], sizeof(sharp)) != 0) {
+                    return std::nullopt;
+                }
+            }
+        }
+        return last_lookup.perm_idx;
+    }
+
+    void SetLastPermut(const Shader::RuntimeInfo& runtime_info,
+                       const Shader::Backend::Bindings& start, size_t perm_idx) {
+        // Tessellation specializations also depend on the tess constant buffer contents.
+        if (info.l_stage == Shader::LogicalStage::TessellationControl ||
+            info.l_stage == Shader::LogicalStage::TessellationEval) {
+            return;
+        }
+        last_lookup.flattened_ud_buf = info.flattened_ud_buf;
+        last_lookup.vs_sharps.clear();
+        const auto& fetch_shader_data = modules[perm_idx].spec.fetch_shader_data;
+        if (info.stage == Shader::Stage::Vertex && fetch_shader_data) {
+            for (const auto& attrib : fetch_shader_data->attributes) {
+                last_lookup.vs_sharps.push_back(attrib.GetSharp(info));
+            }
+        }
+        last_lookup.runtime_info = runtime_info;
+        last_lookup.start = start;
+        last_lookup.perm_idx = perm_idx;
+        last_lookup.valid = true;
     }
 };
 
@@ -95,13 +166,50 @@ public:
         return profile;
     }
 
+    /// Draws skipped because their pipeline was still compiling.
+    u64 NumSkippedDraws() const {
+        return num_skipped_draws;
+    }
+
+    /// Draws that had to wait for their pipeline to finish compiling.
+    u64 NumStalledDraws() const {
+        return num_stalled_draws;
+    }
+
 private:
+    enum class CompileMode {
+        Sync,  ///< Pipelines are created on the GPU thread when first used
+        Skip,  ///< Pipelines are created on workers, draws are skipped until they are ready
+        Stall, ///< Pipelines are created on workers, draws wait until they are ready
+    };
+
+    template <typename Pipeline>
+    struct PendingPipeline {
+        std::future<std::unique_ptr<Pipeline>> pipeline;
+        typename Pipeline::SerializationSupport sdata{};
+        std::array<vk::ShaderModule, MaxShaderStages> modules{};
+        u64 hash{};
+    };
+
+    template <typename Pipeline>
+    std::unique_ptr<Pipeline> WaitPipeline(PendingPipeline<Pipeline>& pending, bool can_skip);
+    const GraphicsPipeline* PublishGraphicsPipeline(
+        const GraphicsPipelineKey& key, std::unique_ptr<GraphicsPipeline> pipeline,
+        u64 pipeline_hash, GraphicsPipeline::SerializationSupport& sdata,
+        const std::array<vk::ShaderModule, MaxShaderStages>& stage_modules);
+    const ComputePipeline* PublishComputePipeline(const ComputePipelineKey& key,
+                                                  std::unique_ptr<ComputePipeline> pipeline,
+                                                  ComputePipeline::SerializationSupport& sdata,
+                                                  vk::ShaderModule module);
+    void FlushPendingPipelines();
+    void CompileWorker(std::stop_token stop_token);
+
     bool RefreshGraphicsKey();
     bool RefreshGraphicsStages();
     bool RefreshComputeKey();
 
-    void DumpShader(std::span<const u32> code, u64 hash, Shader::Stage stage, size_t perm_idx,
-                    std::string_view ext);
+    void DumpShader(std::span<const std::byte> data, u64 hash, Shader::Stage stage,
+                    size_t perm_idx, std::string_view ext);
     std::optional<std::vector<u32>> GetShaderPatch(u64 hash, Shader::Stage stage, size_t perm_idx,
                                                    std::string_view ext);
     vk::ShaderModule CompileModule(Shader::Info& info, Shader::RuntimeInfo& runtime_info,
@@ -133,10 +241,25 @@ private:
     ComputePipelineKey compute_key{};
     u32 num_new_pipelines{}; // new pipelines added to the cache since the game start
 
+    // Pipeline creation jobs queued by the loaders during WarmUp
+    std::vector<std::function<void()>> preload_jobs;
+
+    // Pipelines being created by the compile workers. They are moved to the pipeline maps by the
+    // GPU thread once ready, so the maps are never modified concurrently.
+    CompileMode compile_mode{CompileMode::Sync};
+    tsl::robin_map<GraphicsPipelineKey, std::unique_ptr<PendingPipeline<GraphicsPipeline>>>
+        pending_graphics_pipelines;
+    u64 num_skipped_draws{};
+    u64 num_stalled_draws{};
+
     // Only if Config::collectShadersForDebug()
     tsl::robin_map<vk::ShaderModule,
                    std::vector<std::variant<GraphicsPipelineKey, ComputePipelineKey>>>
         module_related_pipelines;
+
+    // Declared last so the workers are joined before anything they use is destroyed.
+    Common::MPMCQueue<std::packaged_task<void()>> compile_queue;
+    std::vector<std::jthread> compile_workers;
 };
 
 } // namespace Vulkan
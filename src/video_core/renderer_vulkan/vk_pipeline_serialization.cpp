@@ -1,6 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "common/config.h"
 #include "common/serdes.h"
 #include "shader_recompiler/frontend/fetch_shader.h"
@@ -162,9 +166,15 @@ bool PipelineCache::LoadComputePipeline(Serialization::Archive& ar) {
     const auto [it, is_new] = compute_pipelines.try_emplace(compute_key);
     ASSERT(is_new);
 
-    it.value() =
-        std::make_unique<ComputePipeline>(instance, scheduler, desc_heap, profile, *pipeline_cache,
-                                          compute_key, *infos[0], modules[0], sdata, true);
+    // The slot is looked up again when the job runs, as later inserts may rehash the map. No
+    // inserts happen while the jobs are running.
+    preload_jobs.emplace_back(
+        [this, key = compute_key, info = infos[0], module = modules[0], sdata]() mutable {
+            auto pipeline = std::make_unique<ComputePipeline>(instance, scheduler, desc_heap,
+                                                              profile, *pipeline_cache, key,
+                                                              *info, module, sdata, true);
+            compute_pipelines.find(key).value() = std::move(pipeline);
+        });
 
     infos.fill(nullptr);
     modules.fill(nullptr);
@@ -237,9 +247,14 @@ bool PipelineCache::LoadGraphicsPipeline(Serialization::Archive& ar) {
     const auto [it, is_new] = graphics_pipelines.try_emplace(graphics_key);
     ASSERT(is_new);
 
-    it.value() = std::make_unique<GraphicsPipeline>(
-        instance, scheduler, desc_heap, profile, graphics_key, *pipeline_cache, infos,
-        runtime_infos, fetch_shader, modules, sdata, true);
+    preload_jobs.emplace_back([this, key = graphics_key, stage_infos = infos,
+                               stage_runtime_infos = runtime_infos, fetch = fetch_shader,
+                               stage_modules = modules, sdata]() mutable {
+        auto pipeline = std::make_unique<GraphicsPipeline>(
+            instance, scheduler, desc_heap, profile, key, *pipeline_cache, stage_infos,
+            stage_runtime_infos, fetch, stage_modules, sdata, true);
+        graphics_pipelines.find(key).value() = std::move(pipeline);
+    });
 
     infos.fill(nullptr);
     modules.fill(nullptr);
@@ -322,6 +337,11 @@ void PipelineCache::WarmUp() {
     u32 num_pipelines{};
     u32 num_total_pipelines{};
 
+    using Clock = std::chrono::steady_clock;
+    const auto start_time = Clock::now();
+
+    // Keys, shader metadata and modules are loaded serially so that the program cache is
+    // populated in a deterministic order. Pipeline creation is deferred to the workers below.
     Storage::DataBase::Instance().ForEachBlob(
         Storage::BlobType::PipelineKey, [&](std::vector<u8>&& data) {
             ++num_total_pipelines;
@@ -350,7 +370,35 @@ void PipelineCache::WarmUp() {
             }
         });
 
-    LOG_INFO(Render, "Preloaded {} pipelines", num_pipelines);
+    const auto load_time = Clock::now();
+
+    const u32 num_jobs = static_cast<u32>(preload_jobs.size());
+    const u32 num_workers =
+        std::min(std::max(std::thread::hardware_concurrency(), 1U), std::max(num_jobs, 1U));
+    std::atomic<u32> next_job{0};
+    const auto worker = [&] {
+        for (u32 i = next_job++; i < num_jobs; i = next_job++) {
+            preload_jobs[i]();
+        }
+    };
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(num_workers - 1);
+        for (u32 i = 1; i < num_workers; ++i) {
+            workers.emplace_back(worker);
+        }
+        worker();
+    }
+    preload_jobs.clear();
+    preload_jobs.shrink_to_fit();
+
+    const auto end_time = Clock::now();
+    const auto to_ms = [](Clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+    };
+    LOG_INFO(Render, "Preloaded {} pipelines in {} ms (load {} ms, create {} ms, {} workers)",
+             num_pipelines, to_ms(end_time - start_time), to_ms(load_time - start_time),
+             to_ms(end_time - load_time), num_workers);
     if (num_total_pipelines > num_pipelines) {
         LOG_WARNING(Render, "{} stale pipelines were found. Consider re-generating the cache",
                     num_total_pipelines - num_pipelines);
@@ -360,6 +408,7 @@ void PipelineCache::WarmUp() {
 }
 
 void PipelineCache::Sync() {
+    FlushPendingPipelines();
     Storage::DataBase::Instance().Close();
 }
 
@@ -474,6 +523,7 @@ bool StageSpecialization::Deserialize(Serialization::Archive& ar) {
     spec.Read(fmasks);
     spec.Read(samplers);
 
+    digest = ComputeDigest();
     return true;
 }
 
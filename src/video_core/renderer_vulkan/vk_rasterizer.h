@@ -120,6 +120,7 @@ private:
     const Instance& instance;
     Scheduler& scheduler;
     VideoCore::PageManager page_manager;
+    VideoCore::GarbageCollector garbage_collector;
     VideoCore::BufferCache buffer_cache;
     VideoCore::TextureCache texture_cache;
     AmdGpu::Liverpool* liverpool;
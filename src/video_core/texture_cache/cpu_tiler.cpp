@@ -0,0 +1,431 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#include "common/assert.h"
+#include "video_core/texture_cache/cpu_tiler.h"
+#include "video_core/texture_cache/image_info.h"
+
+namespace VideoCore {
+
+static constexpr u32 MICRO_TILE_WIDTH = 8;
+static constexpr u32 MICRO_TILE_HEIGHT = 8;
+static constexpr u32 NUM_PIPE_INTERLEAVE_BITS = 8;
+
+static constexpr u32 Bit(u32 value, u32 bit) {
+    return (value >> bit) & 1;
+}
+
+CpuTiler::CpuTiler(const ImageInfo& info)
+    : is_tiled{info.props.is_tiled != 0}, array_mode{info.array_mode},
+      micro_tile_mode{AmdGpu::GetMicroTileMode(info.tile_mode)}, bits_per_pixel{info.num_bits},
+      bytes_per_pixel{info.num_bits / 8}, num_samples{info.num_samples},
+      thickness{AmdGpu::GetMicroTileThickness(info.array_mode)}, bank_swizzle{info.bank_swizzle},
+      guest_size{info.guest_size} {
+    ASSERT_MSG(IsSupported(info), "Unsupported bpp {}", bits_per_pixel);
+    micro_tile_bytes =
+        MICRO_TILE_WIDTH * MICRO_TILE_HEIGHT * thickness * bits_per_pixel * num_samples / 8;
+
+    is_macro_tiled = is_tiled && AmdGpu::IsMacroTiled(array_mode);
+    if (is_macro_tiled) {
+        const auto macro_tile_mode =
+            AmdGpu::CalculateMacrotileMode(info.tile_mode, info.num_bits, info.num_samples);
+        pipe_config = AmdGpu::GetPipeConfig(info.tile_mode);
+        num_pipes = pipe_config == AmdGpu::PipeConfig::P2 ? 2 : 8;
+        num_pipe_bits = std::bit_width(num_pipes) - 1;
+        bank_width = AmdGpu::GetBankWidth(macro_tile_mode);
+        bank_height = AmdGpu::GetBankHeight(macro_tile_mode);
+        num_banks = AmdGpu::GetNumBanks(macro_tile_mode);
+        num_bank_bits = std::bit_width(num_banks) - 1;
+        tile_split_bytes = AmdGpu::CalculateTileSplit(info.tile_mode, info.array_mode,
+                                                      micro_tile_mode, info.num_bits);
+        macro_tile_aspect = AmdGpu::GetMacrotileAspect(macro_tile_mode);
+    }
+
+    // Like the compute kernels, the linear image packs the texels of each mip one after another.
+    num_mips = info.resources.levels;
+    u32 linear_offset = 0;
+    for (u32 mip = 0; mip < num_mips; ++mip) {
+        const auto& mip_layout = info.mips_layout[mip];
+        auto& mip_info = mips[mip];
+        mip_info.size = mip_layout.size;
+        mip_info.pitch = mip_layout.pitch;
+        mip_info.height = mip_layout.height;
+        mip_info.tiled_offset = mip_layout.offset;
+        mip_info.linear_offset = linear_offset;
+        if (info.props.is_block) {
+            mip_info.pitch = std::max((mip_info.pitch + 3) / 4, 1U);
+            mip_info.height = std::max((mip_info.height + 3) / 4, 1U);
+        }
+        linear_offset += mip_info.size / bytes_per_pixel * bytes_per_pixel;
+    }
+
+    for (u32 z = 0; z < thickness; ++z) {
+        for (u32 y = 0; y < MICRO_TILE_HEIGHT; ++y) {
+            for (u32 x = 0; x < MICRO_TILE_WIDTH; ++x) {
+                pixel_index_lut[(z * MICRO_TILE_HEIGHT + y) * MICRO_TILE_WIDTH + x] =
+                    static_cast<u16>(ComputePixelIndex(x, y, z));
+            }
+        }
+    }
+}
+
+bool CpuTiler::IsSupported(const ImageInfo& info) {
+    switch (info.num_bits) {
+    case 8:
+    case 16:
+    case 32:
+    case 64:
+    case 96:
+    case 128:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void CpuTiler::Detile(std::span<const u8> tiled, std::span<u8> linear) const {
+    Process<false>(tiled, linear);
+}
+
+void CpuTiler::Tile(std::span<const u8> linear, std::span<u8> tiled) const {
+    Process<true>(linear, tiled);
+}
+
+template <bool is_tiler>
+void CpuTiler::Process(std::span<const u8> src, std::span<u8> dst) const {
+    if (!is_tiled) {
+        // Linear surfaces are stored the same way on both sides.
+        const size_t size = std::min({src.size(), dst.size(), size_t(guest_size)});
+        std::memcpy(dst.data(), src.data(), size);
+        return;
+    }
+    for (u32 mip = 0; mip < num_mips; ++mip) {
+        const auto& mip_info = mips[mip];
+        if (mip_info.pitch == 0 || mip_info.height == 0) {
+            break;
+        }
+        ProcessMip<is_tiler>(mip_info, src, dst);
+    }
+}
+
+template <bool is_tiler, u32 bpp>
+static void CopyRow(const u32* tiled_offsets, u32 width, size_t linear_offset,
+                    std::span<const u8> src, std::span<u8> dst) {
+    const size_t linear_size = is_tiler ? src.size() : dst.size();
+    const size_t tiled_size = is_tiler ? dst.size() : src.size();
+    if (linear_offset + size_t(width) * bpp > linear_size) {
+        width = linear_offset < linear_size ? static_cast<u32>((linear_size - linear_offset) / bpp)
+                                            : 0;
+    }
+    for (u32 x = 0; x < width; ++x) {
+        const size_t tiled_offset = tiled_offsets[x];
+        if (tiled_offset + bpp > tiled_size) {
+            continue;
+        }
+        const size_t texel_offset = linear_offset + size_t(x) * bpp;
+        if constexpr (is_tiler) {
+            std::memcpy(dst.data() + tiled_offset, src.data() + texel_offset, bpp);
+        } else {
+            std::memcpy(dst.data() + texel_offset, src.data() + tiled_offset, bpp);
+        }
+    }
+}
+
+template <bool is_tiler>
+void CpuTiler::ProcessMip(const MipInfo& mip, std::span<const u8> src, std::span<u8> dst) const {
+    const u32 slice_texels = mip.pitch * mip.height;
+    const u32 num_texels = mip.size / bytes_per_pixel;
+    std::vector<u32> tiled_offsets(mip.pitch);
+    for (u32 texel = 0; texel < num_texels; texel += mip.pitch) {
+        const u32 width = std::min(mip.pitch, num_texels - texel);
+        const u32 y = (texel / mip.pitch) % mip.height;
+        const u32 slice = texel / slice_texels;
+        for (u32 x = 0; x < width; ++x) {
+            // The kernels index whole texels, which rounds 96 bpp addresses down.
+            const u32 offset =
+                mip.tiled_offset + ComputeTiledOffset(x, y, slice, mip.pitch, mip.height);
+            tiled_offsets[x] = offset / bytes_per_pixel * bytes_per_pixel;
+        }
+        const size_t linear_offset = mip.linear_offset + size_t(texel) * bytes_per_pixel;
+        switch (bytes_per_pixel) {
+        case 1:
+            CopyRow<is_tiler, 1>(tiled_offsets.data(), width, linear_offset, src, dst);
+            break;
+        case 2:
+            CopyRow<is_tiler, 2>(tiled_offsets.data(), width, linear_offset, src, dst);
+            break;
+        case 4:
+            CopyRow<is_tiler, 4>(tiled_offsets.data(), width, linear_offset, src, dst);
+            break;
+        case 8:
+            CopyRow<is_tiler, 8>(tiled_offsets.data(), width, linear_offset, src, dst);
+            break;
+        case 12:
+            CopyRow<is_tiler, 12>(tiled_offsets.data(), width, linear_offset, src, dst);
+            break;
+        case 16:
+            CopyRow<is_tiler, 16>(tiled_offsets.data(), width, linear_offset, src, dst);
+            break;
+        default:
+            UNREACHABLE_MSG("Unsupported bytes per pixel {}", bytes_per_pixel);
+        }
+    }
+}
+
+u32 CpuTiler::ComputeTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const {
+    if (is_macro_tiled) {
+        return ComputeMacroTiledOffset(x, y, slice, pitch, height);
+    }
+    return ComputeMicroTiledOffset(x, y, slice, pitch, height);
+}
+
+u32 CpuTiler::ComputePixelIndex(u32 x, u32 y, u32 z) const {
+    u32 p0 = 0, p1 = 0, p2 = 0, p3 = 0, p4 = 0, p5 = 0, p6 = 0, p7 = 0, p8 = 0;
+
+    const u32 x0 = Bit(x, 0), x1 = Bit(x, 1), x2 = Bit(x, 2);
+    const u32 y0 = Bit(y, 0), y1 = Bit(y, 1), y2 = Bit(y, 2);
+    const u32 z0 = Bit(z, 0), z1 = Bit(z, 1), z2 = Bit(z, 2);
+
+    // 96 bpp has no swizzle of its own in the display and thick modes, as in the kernels.
+    switch (micro_tile_mode) {
+    case AmdGpu::MicroTileMode::Display:
+        switch (bits_per_pixel) {
+        case 8:
+            p0 = x0, p1 = x1, p2 = x2, p3 = y1, p4 = y0, p5 = y2;
+            break;
+        case 16:
+            p0 = x0, p1 = x1, p2 = x2, p3 = y0, p4 = y1, p5 = y2;
+            break;
+        case 32:
+            p0 = x0, p1 = x1, p2 = y0, p3 = x2, p4 = y1, p5 = y2;
+            break;
+        case 64:
+            p0 = x0, p1 = y0, p2 = x1, p3 = x2, p4 = y1, p5 = y2;
+            break;
+        case 128:
+            p0 = y0, p1 = x0, p2 = x1, p3 = x2, p4 = y1, p5 = y2;
+            break;
+        }
+        break;
+    case AmdGpu::MicroTileMode::Thin:
+    case AmdGpu::MicroTileMode::Depth:
+        p0 = x0, p1 = y0, p2 = x1, p3 = y1, p4 = x2, p5 = y2;
+        break;
+    default:
+        switch (bits_per_pixel) {
+        case 8:
+        case 16:
+            p0 = x0, p1 = y0, p2 = x1, p3 = y1, p4 = z0, p5 = z1;
+            break;
+        case 32:
+            p0 = x0, p1 = y0, p2 = x1, p3 = z0, p4 = y1, p5 = z1;
+            break;
+        case 64:
+        case 128:
+            p0 = x0, p1 = y0, p2 = z0, p3 = x1, p4 = y1, p5 = z1;
+            break;
+        }
+        p6 = x2;
+        p7 = y2;
+        if (thickness == 8) {
+            p8 = z2;
+        }
+        break;
+    }
+
+    return p0 | (p1 << 1) | (p2 << 2) | (p3 << 3) | (p4 << 4) | (p5 << 5) | (p6 << 6) |
+           (p7 << 7) | (p8 << 8);
+}
+
+u32 CpuTiler::PixelOffset(u32 x, u32 y, u32 slice) const {
+    const u32 pixel_index =
+        pixel_index_lut[((slice % thickness) * MICRO_TILE_HEIGHT + y % MICRO_TILE_HEIGHT) *
+                            MICRO_TILE_WIDTH +
+                        x % MICRO_TILE_WIDTH];
+    const u32 pixel_offset = micro_tile_mode == AmdGpu::MicroTileMode::Depth
+                                 ? pixel_index * bits_per_pixel * num_samples
+                                 : pixel_index * bits_per_pixel;
+    return pixel_offset / 8;
+}
+
+u32 CpuTiler::ComputeMicroTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const {
+    const u32 slice_bytes =
+        (pitch * height * thickness * bits_per_pixel * num_samples + 7) / 8;
+
+    const u32 micro_tiles_per_row = pitch / MICRO_TILE_WIDTH;
+    const u32 micro_tile_index_x = x / MICRO_TILE_WIDTH;
+    const u32 micro_tile_index_y = y / MICRO_TILE_HEIGHT;
+    const u32 micro_tile_index_z = slice / thickness;
+
+    const u32 slice_offset = micro_tile_index_z * slice_bytes;
+    const u32 micro_tile_offset =
+        (micro_tile_index_y * micro_tiles_per_row + micro_tile_index_x) * micro_tile_bytes;
+
+    return slice_offset + micro_tile_offset + PixelOffset(x, y, slice);
+}
+
+u32 CpuTiler::ComputePipe(u32 x, u32 y, u32 slice) const {
+    u32 p0 = 0, p1 = 0, p2 = 0;
+
+    const u32 tx = x / MICRO_TILE_WIDTH;
+    const u32 ty = y / MICRO_TILE_HEIGHT;
+    const u32 x3 = Bit(tx, 0), x4 = Bit(tx, 1), x5 = Bit(tx, 2);
+    const u32 y3 = Bit(ty, 0), y4 = Bit(ty, 1), y5 = Bit(ty, 2);
+
+    switch (pipe_config) {
+    case AmdGpu::PipeConfig::P2:
+        p0 = x3 ^ y3;
+        break;
+    case AmdGpu::PipeConfig::P8_32x32_8x16:
+        p0 = x4 ^ y3 ^ x5;
+        p1 = x3 ^ y4;
+        p2 = x5 ^ y5;
+        break;
+    case AmdGpu::PipeConfig::P8_32x32_16x16:
+        p0 = x3 ^ y3 ^ x4;
+        p1 = x4 ^ y4;
+        p2 = x5 ^ y5;
+        break;
+    default:
+        break;
+    }
+
+    const u32 pipe = p0 | (p1 << 1) | (p2 << 2);
+
+    u32 pipe_swizzle = 0;
+    if (array_mode == AmdGpu::ArrayMode::Array3DTiledThin1 ||
+        array_mode == AmdGpu::ArrayMode::Array3DTiledThick ||
+        array_mode == AmdGpu::ArrayMode::Array3DTiledXThick) {
+        pipe_swizzle += std::max(1U, num_pipes / 2 - 1) * (slice / thickness);
+    }
+    pipe_swizzle &= (num_pipes - 1);
+    return pipe ^ pipe_swizzle;
+}
+
+u32 CpuTiler::ComputeBank(u32 x, u32 y, u32 slice, u32 tile_split_slice) const {
+    u32 b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+
+    const u32 tx = x / MICRO_TILE_WIDTH / (bank_width * num_pipes);
+    const u32 ty = y / MICRO_TILE_HEIGHT / bank_height;
+    const u32 x3 = Bit(tx, 0), x4 = Bit(tx, 1), x5 = Bit(tx, 2), x6 = Bit(tx, 3);
+    const u32 y3 = Bit(ty, 0), y4 = Bit(ty, 1), y5 = Bit(ty, 2), y6 = Bit(ty, 3);
+
+    switch (num_banks) {
+    case 16:
+        b0 = x3 ^ y6;
+        b1 = x4 ^ y5 ^ y6;
+        b2 = x5 ^ y4;
+        b3 = x6 ^ y3;
+        break;
+    case 8:
+        b0 = x3 ^ y5;
+        b1 = x4 ^ y4 ^ y5;
+        b2 = x5 ^ y3;
+        break;
+    case 4:
+        b0 = x3 ^ y4;
+        b1 = x4 ^ y3;
+        break;
+    case 2:
+        b0 = x3 ^ y3;
+        break;
+    }
+
+    u32 bank = b0 | (b1 << 1) | (b2 << 2) | (b3 << 3);
+
+    u32 slice_rotation = 0;
+    switch (array_mode) {
+    case AmdGpu::ArrayMode::Array2DTiledThin1:
+    case AmdGpu::ArrayMode::Array2DTiledThick:
+    case AmdGpu::ArrayMode::Array2DTiledXThick:
+        slice_rotation = ((num_banks / 2) - 1) * (slice / thickness);
+        break;
+    case AmdGpu::ArrayMode::Array3DTiledThin1:
+    case AmdGpu::ArrayMode::Array3DTiledThick:
+    case AmdGpu::ArrayMode::Array3DTiledXThick:
+        slice_rotation = std::max(1U, (num_pipes / 2) - 1) * (slice / thickness) / num_pipes;
+        break;
+    default:
+        break;
+    }
+
+    u32 tile_split_rotation = 0;
+    switch (array_mode) {
+    case AmdGpu::ArrayMode::Array2DTiledThin1:
+    case AmdGpu::ArrayMode::Array3DTiledThin1:
+    case AmdGpu::ArrayMode::ArrayPrt2DTiledThin1:
+    case AmdGpu::ArrayMode::ArrayPrt3DTiledThin1:
+        tile_split_rotation = ((num_banks / 2) + 1) * tile_split_slice;
+        break;
+    default:
+        break;
+    }
+
+    bank ^= bank_swizzle + slice_rotation;
+    bank ^= tile_split_rotation;
+    bank &= (num_banks - 1);
+    return bank;
+}
+
+u32 CpuTiler::ComputeMacroTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const {
+    u32 element_offset = PixelOffset(x, y, slice);
+
+    u32 tile_bytes = micro_tile_bytes;
+    u32 slices_per_tile = 1;
+    u32 tile_split_slice = 0;
+    if (tile_bytes > tile_split_bytes && thickness == 1) {
+        slices_per_tile = tile_bytes / tile_split_bytes;
+        tile_split_slice = element_offset / tile_split_bytes;
+        element_offset %= tile_split_bytes;
+        tile_bytes = tile_split_bytes;
+    }
+
+    const u32 macro_tile_pitch =
+        (MICRO_TILE_WIDTH * bank_width * num_pipes) * macro_tile_aspect;
+    const u32 macro_tile_height =
+        (MICRO_TILE_HEIGHT * bank_height * num_banks) / macro_tile_aspect;
+    const u32 macro_tile_bytes = tile_bytes * (macro_tile_pitch / MICRO_TILE_WIDTH) *
+                                 (macro_tile_height / MICRO_TILE_HEIGHT) /
+                                 (num_pipes * num_banks);
+
+    const u32 macro_tiles_per_row = pitch / macro_tile_pitch;
+    const u32 macro_tile_index_x = x / macro_tile_pitch;
+    const u32 macro_tile_index_y = y / macro_tile_height;
+    const u32 macro_tile_offset =
+        ((macro_tile_index_y * macro_tiles_per_row) + macro_tile_index_x) * macro_tile_bytes;
+    const u32 macro_tiles_per_slice = macro_tiles_per_row * (height / macro_tile_height);
+
+    const u32 slice_bytes = macro_tiles_per_slice * macro_tile_bytes;
+    const u32 slice_offset =
+        slice_bytes * (tile_split_slice + slices_per_tile * (slice / thickness));
+
+    const u32 tile_row_index = (y / MICRO_TILE_HEIGHT) % bank_height;
+    const u32 tile_column_index = ((x / MICRO_TILE_WIDTH) / num_pipes) % bank_width;
+    const u32 tile_index = (tile_row_index * bank_width) + tile_column_index;
+    const u32 tile_offset = tile_index * tile_bytes;
+
+    const u32 total_offset = slice_offset + macro_tile_offset + element_offset + tile_offset;
+
+    if (AmdGpu::IsPrt(array_mode)) {
+        x %= macro_tile_pitch;
+        y %= macro_tile_height;
+    }
+
+    const u32 pipe = ComputePipe(x, y, slice);
+    const u32 bank = ComputeBank(x, y, slice, tile_split_slice);
+
+    const u32 pipe_interleave_mask = (1U << NUM_PIPE_INTERLEAVE_BITS) - 1;
+    const u32 pipe_interleave_offset = total_offset & pipe_interleave_mask;
+    const u32 offset = total_offset >> NUM_PIPE_INTERLEAVE_BITS;
+
+    return pipe_interleave_offset | (pipe << NUM_PIPE_INTERLEAVE_BITS) |
+           (bank << (NUM_PIPE_INTERLEAVE_BITS + num_pipe_bits)) |
+           (offset << (NUM_PIPE_INTERLEAVE_BITS + num_pipe_bits + num_bank_bits));
+}
+
+} // namespace VideoCore
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: Copyright 2025 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <span>
+
+#include "common/types.h"
+#include "video_core/amdgpu/tiling.h"
+
+namespace VideoCore {
+
+struct ImageInfo;
+
+/// Host side implementation of the address math in host_shaders/tiling.comp.
+/// Produces the same layout as the compute tiler/detiler, so it can be used wherever a GPU
+/// round trip is undesirable, i.e small uploads into mapped memory or surface dumps.
+class CpuTiler {
+public:
+    explicit CpuTiler(const ImageInfo& info);
+
+    /// Returns true if the surface can be processed by the CPU tiler.
+    static bool IsSupported(const ImageInfo& info);
+
+    /// Converts the tiled guest surface into a linear image with tightly packed mips.
+    void Detile(std::span<const u8> tiled, std::span<u8> linear) const;
+
+    /// Converts a linear image with tightly packed mips into the tiled guest layout.
+    void Tile(std::span<const u8> linear, std::span<u8> tiled) const;
+
+private:
+    struct MipInfo {
+        u32 size;
+        u32 pitch;
+        u32 height;
+        u32 tiled_offset;
+        u32 linear_offset;
+    };
+
+    template <bool is_tiler>
+    void Process(std::span<const u8> src, std::span<u8> dst) const;
+
+    template <bool is_tiler>
+    void ProcessMip(const MipInfo& mip, std::span<const u8> src, std::span<u8> dst) const;
+
+    u32 ComputeTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const;
+    u32 ComputeMicroTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const;
+    u32 ComputeMacroTiledOffset(u32 x, u32 y, u32 slice, u32 pitch, u32 height) const;
+    u32 ComputePipe(u32 x, u32 y, u32 slice) const;
+    u32 ComputeBank(u32 x, u32 y, u32 slice, u32 tile_split_slice) const;
+    u32 ComputePixelIndex(u32 x, u32 y, u32 z) const;
+    u32 PixelOffset(u32 x, u32 y, u32 slice) const;
+
+private:
+    bool is_tiled;
+    bool is_macro_tiled{};
+    AmdGpu::ArrayMode array_mode;
+    AmdGpu::MicroTileMode micro_tile_mode;
+    AmdGpu::PipeConfig pipe_config{};
+    u32 bits_per_pixel;
+    u32 bytes_per_pixel;
+    u32 num_samples;
+    u32 thickness;
+    u32 micro_tile_bytes;
+    u32 bank_swizzle;
+    u32 num_pipes{};
+    u32 num_pipe_bits{};
+    u32 bank_width{};
+    u32 bank_height{};
+    u32 num_banks{};
+    u32 num_bank_bits{};
+    u32 tile_split_bytes{};
+    u32 macro_tile_aspect{};
+    u32 num_mips{};
+    u32 guest_size;
+    std::array<MipInfo, 16> mips{};
+    std::array<u16, 8 * 8 * 8> pixel_index_lut{};
+};
+
+} // namespace VideoCore
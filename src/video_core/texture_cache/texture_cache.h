@@ -11,9 +11,9 @@
 #include <queue>
 #include <tsl/robin_map.h>
 
-#include "common/lru_cache.h"
 #include "common/slot_vector.h"
 #include "shader_recompiler/resource.h"
+#include "video_core/garbage_collector.h"
 #include "video_core/multi_level_page_table.h"
 #include "video_core/texture_cache/blit_helper.h"
 #include "video_core/texture_cache/image.h"
@@ -31,11 +31,6 @@ class BufferCache;
 class PageManager;
 
 class TextureCache {
-    // Default values for garbage collection
-    static constexpr s64 DEFAULT_PRESSURE_GC_MEMORY = 1_GB + 512_MB;
-    static constexpr s64 DEFAULT_CRITICAL_GC_MEMORY = 3_GB;
-    static constexpr s64 TARGET_GC_THRESHOLD = 8_GB;
-
     using ImageIds = boost::container::small_vector<ImageId, 16>;
 
     struct Traits {
@@ -77,7 +72,8 @@ public:
 
 public:
     TextureCache(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler,
-                 AmdGpu::Liverpool* liverpool, BufferCache& buffer_cache, PageManager& tracker);
+                 AmdGpu::Liverpool* liverpool, BufferCache& buffer_cache, PageManager& tracker,
+                 GarbageCollector& garbage_collector);
     ~TextureCache();
 
     TileManager& GetTileManager() noexcept {
@@ -190,8 +186,11 @@ public:
         return false;
     }
 
-    /// Runs the garbage collector.
-    void RunGarbageCollector();
+    /// Returns the cost of evicting the image, allowing write back of GPU modified contents.
+    [[nodiscard]] EvictionCost GetEvictionCost(ImageId image_id, bool allow_download);
+
+    /// Writes back and frees an image chosen by the garbage collector.
+    void EvictImage(ImageId image_id);
 
     template <typename Func>
     void ForEachImageInRegion(VAddr cpu_addr, size_t size, Func&& func) {
@@ -299,6 +298,7 @@ private:
     AmdGpu::Liverpool* liverpool;
     BufferCache& buffer_cache;
     PageManager& tracker;
+    GarbageCollector& garbage_collector;
     BlitHelper blit_helper;
     TileManager tile_manager;
     Common::SlotVector<Image> slot_images;
@@ -306,12 +306,6 @@ private:
     tsl::robin_map<u64, Sampler> samplers;
     tsl::robin_map<vk::Format, ImageId> null_images;
     std::unordered_set<ImageId> download_images;
-    u64 total_used_memory = 0;
-    u64 trigger_gc_memory = 0;
-    u64 pressure_gc_memory = 0;
-    u64 critical_gc_memory = 0;
-    u64 gc_tick = 0;
-    Common::LeastRecentlyUsedCache<ImageId, u64> lru_cache;
     PageTable page_table;
     std::mutex mutex;
     struct MetaDataInfo {
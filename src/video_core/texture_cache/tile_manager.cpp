@@ -1,10 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <numeric>
+
+#include "core/memory.h"
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
+#include "video_core/texture_cache/cpu_tiler.h"
 #include "video_core/texture_cache/image.h"
 #include "video_core/texture_cache/image_info.h"
 #include "video_core/texture_cache/image_view.h"
@@ -241,6 +245,19 @@ TileManager::Result TileManager::DetileImage(vk::Buffer in_buffer, u32 in_offset
     return {out_buffer, 0};
 }
 
+TileManager::Result TileManager::DetileImageOnCpu(const ImageInfo& info) {
+    guest_data.resize(info.guest_size);
+    Core::Memory::Instance()->CopySparseMemory(info.guest_address, guest_data.data(),
+                                               info.guest_size);
+
+    // Buffer to image copies need the offset aligned to the texel size, which is 12 for 96 bpp.
+    const u32 alignment = std::lcm(16U, info.num_bits / 8);
+    const auto [data, offset] = stream_buffer.Map(info.guest_size, alignment);
+    CpuTiler{info}.Detile(guest_data, {data, info.guest_size});
+    stream_buffer.Commit();
+    return {stream_buffer.Handle(), static_cast<u32>(offset)};
+}
+
 void TileManager::TileImage(Image& in_image, std::span<vk::BufferImageCopy> buffer_copies,
                             vk::Buffer out_buffer, u32 out_offset, u32 copy_size) {
     const auto& info = in_image.info;